@@ -16,5 +16,107 @@ BENCHMARK(bench_grain_128aead::decrypt)->Args({ 32, 2048 });
 BENCHMARK(bench_grain_128aead::encrypt)->Args({ 32, 4096 });
 BENCHMARK(bench_grain_128aead::decrypt)->Args({ 32, 4096 });
 
+// register Grain-128 AEAD, with decoupled LFSR stream generation
+BENCHMARK(bench_grain_128aead::decoupled_encrypt<1>)->Args({ 32, 4096 });
+BENCHMARK(bench_grain_128aead::decoupled_encrypt<1>)->Args({ 32, 65536 });
+BENCHMARK(bench_grain_128aead::decoupled_encrypt<8>)->Args({ 32, 65536 });
+BENCHMARK(bench_grain_128aead::decoupled_encrypt<16>)->Args({ 32, 65536 });
+
+// register Grain-128 AEAD, fused with cipher text checksum computation
+BENCHMARK(bench_grain_128aead::encrypt_checksum<checksum::crc32c_t>)
+  ->Args({ 32, 4096 });
+BENCHMARK(bench_grain_128aead::encrypt_checksum<checksum::xxh32_t>)
+  ->Args({ 32, 4096 });
+
+// register Grain-128 AEAD, with sampled redundant re-computation ( fraction in
+// parts per million )
+BENCHMARK(bench_grain_128aead::encrypt_sampled)->Args({ 32, 4096, 0 });
+BENCHMARK(bench_grain_128aead::encrypt_sampled)->Args({ 32, 4096, 1000 });
+BENCHMARK(bench_grain_128aead::encrypt_sampled)->Args({ 32, 4096, 10000 });
+
+// register trial decryption across 4 candidate keys, serial vs. interleaved
+BENCHMARK(bench_grain_128aead::trial_decrypt<false>)->Args({ 32, 64 });
+BENCHMARK(bench_grain_128aead::trial_decrypt<true>)->Args({ 32, 64 });
+BENCHMARK(bench_grain_128aead::trial_decrypt<false>)->Args({ 32, 1024 });
+BENCHMARK(bench_grain_128aead::trial_decrypt<true>)->Args({ 32, 1024 });
+
+// register encryption with & without nonce-reuse detector in front of it
+BENCHMARK(bench_grain_128aead::guarded_encrypt<false>)->Args({ 32, 64 });
+BENCHMARK(bench_grain_128aead::guarded_encrypt<true>)->Args({ 32, 64 });
+BENCHMARK(bench_grain_128aead::guarded_encrypt<false>)->Args({ 32, 1024 });
+BENCHMARK(bench_grain_128aead::guarded_encrypt<true>)->Args({ 32, 1024 });
+
+// register re-sealing under new key, two pass vs. fused single pass
+BENCHMARK(bench_grain_128aead::reseal<false>)->Args({ 32, 4096 });
+BENCHMARK(bench_grain_128aead::reseal<true>)->Args({ 32, 4096 });
+
+// register first-N-call latency after simulated cold start, with & without
+// explicit warm-up
+BENCHMARK(bench_grain_128aead::cold_encrypt<false>)
+  ->Args({ 64, 1 })
+  ->Iterations(16)
+  ->UseManualTime();
+BENCHMARK(bench_grain_128aead::cold_encrypt<true>)
+  ->Args({ 64, 1 })
+  ->Iterations(16)
+  ->UseManualTime();
+BENCHMARK(bench_grain_128aead::cold_encrypt<false>)
+  ->Args({ 4096, 16 })
+  ->Iterations(16)
+  ->UseManualTime();
+BENCHMARK(bench_grain_128aead::cold_encrypt<true>)
+  ->Args({ 4096, 16 })
+  ->Iterations(16)
+  ->UseManualTime();
+
+// register encryption/ decryption through inlined header-only implementation
+// vs. C ABI of dlopen'd shared library ( see tools/ffi_overhead.py )
+BENCHMARK(bench_grain_128aead::ffi_encrypt<false>)
+  ->ArgsProduct({ { 0 }, { 0, 16, 64, 256, 1024, 4096 } });
+BENCHMARK(bench_grain_128aead::ffi_encrypt<true>)
+  ->ArgsProduct({ { 0 }, { 0, 16, 64, 256, 1024, 4096 } });
+BENCHMARK(bench_grain_128aead::ffi_decrypt<false>)
+  ->ArgsProduct({ { 0 }, { 0, 16, 64, 256, 1024, 4096 } });
+BENCHMARK(bench_grain_128aead::ffi_decrypt<true>)
+  ->ArgsProduct({ { 0 }, { 0, 16, 64, 256, 1024, 4096 } });
+
+// register mixed workload of encryption & scalar hot loop, under fixed scalar,
+// 256 -bit & 512 -bit kernels vs. width selected by policy
+BENCHMARK(bench_grain_128aead::mixed_load<1>)
+  ->Args({ 16384, 1000 })
+  ->Args({ 16384, 1000000 });
+BENCHMARK(bench_grain_128aead::mixed_load<8>)
+  ->Args({ 16384, 1000 })
+  ->Args({ 16384, 1000000 });
+BENCHMARK(bench_grain_128aead::mixed_load<16>)
+  ->Args({ 16384, 1000 })
+  ->Args({ 16384, 1000000 });
+BENCHMARK(bench_grain_128aead::mixed_load<0>)
+  ->Args({ 16384, 1000 })
+  ->Args({ 16384, 1000000 });
+
+// register file streaming over loopback TCP, plain read/ encrypt/ send loop
+// vs. mapped file & zero-copy sends from ring of buffers
+BENCHMARK(bench_grain_128aead::file_send<false>)
+  ->Arg(1ul << 20)
+  ->UseRealTime();
+BENCHMARK(bench_grain_128aead::file_send<true>)
+  ->Arg(1ul << 20)
+  ->UseRealTime();
+
+// register Grain-128 AEAD, under key shared by 64 threads & rotated meanwhile
+BENCHMARK(bench_grain_128aead::shared_key_rcu)
+  ->Args({ 16, 64 })
+  ->Threads(64)
+  ->UseRealTime();
+BENCHMARK(bench_grain_128aead::shared_key_mutex)
+  ->Args({ 16, 64 })
+  ->Threads(64)
+  ->UseRealTime();
+BENCHMARK(bench_grain_128aead::shared_key_shared_ptr)
+  ->Args({ 16, 64 })
+  ->Threads(64)
+  ->UseRealTime();
+
 // benchmark runner main function
 BENCHMARK_MAIN();
@@ -1,5 +1,8 @@
 #pragma once
+#include "checksum.hpp"
 #include "grain_128.hpp"
+#include "usdt.hpp"
+#include <algorithm>
 
 #if defined __BMI2__
 #include <immintrin.h>
@@ -257,18 +260,18 @@ initialize(grain_128::state_t* const __restrict st, // Grain-128 AEAD state
     grain_128::update_lfsrx32(st, s96);
     grain_128::update_nfsrx32(st, b96);
   }
+
+  GRAIN_USDT0(initialized);
 }
 
-// Authenticates associated data ( 8/ 32 bits at a time ), following
-// specification defined in section 2.3, 2.5 & 2.6.1 of Grain-128 AEAD
+// Authenticates DER encoded length of associated data ( 8 bits at a time ),
+// following specification defined in section 2.6.1 of Grain-128 AEAD
 //
 // Find document
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/grain-128aead-spec-final.pdf
 static void
-auth_associated_data(
-  grain_128::state_t* const __restrict st, // Grain-128 AEAD state
-  const uint8_t* const __restrict data,    // N -bytes associated data
-  const size_t dlen                        // len(data) = N | >= 0
+auth_der_length(grain_128::state_t* const st, // Grain-128 AEAD state
+                const size_t dlen // associated data length | >= 0
 )
 {
   // DER encode length of associated data
@@ -302,9 +305,21 @@ auth_associated_data(
     const auto splitted = split_bits<uint8_t>(yt0, yt1);
     grain_128::authenticate<uint8_t>(st, der[i], splitted.second);
   }
+}
 
-  // Authenticate associated data bits
-
+// Authenticates associated data bytes ( 8/ 32 bits at a time ), following
+// specification defined in section 2.3 & 2.5 of Grain-128 AEAD; associated data
+// can be fed in arbitrary sized pieces, after its DER encoded length is
+// authenticated ( see `auth_der_length` ).
+//
+// Find document
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/grain-128aead-spec-final.pdf
+static void
+auth_data(grain_128::state_t* const __restrict st, // Grain-128 AEAD state
+          const uint8_t* const __restrict data,    // N -bytes associated data
+          const size_t dlen                        // len(data) = N | >= 0
+)
+{
   const size_t word_cnt = dlen >> 2;
   const size_t rm_bytes = dlen & 3ul;
 
@@ -371,16 +386,164 @@ auth_associated_data(
   }
 }
 
+// Authenticates associated data ( 8/ 32 bits at a time ), following
+// specification defined in section 2.3, 2.5 & 2.6.1 of Grain-128 AEAD
+//
+// Find document
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/grain-128aead-spec-final.pdf
+static void
+auth_associated_data(
+  grain_128::state_t* const __restrict st, // Grain-128 AEAD state
+  const uint8_t* const __restrict data,    // N -bytes associated data
+  const size_t dlen                        // len(data) = N | >= 0
+)
+{
+  auth_der_length(st, dlen);
+  auth_data(st, data, dlen);
+
+  GRAIN_USDT1(ad_authenticated, dlen);
+}
+
+// Computes difference between authenticator contributions of two equal length
+// associated data byte strings ( 8/ 32 bits at a time ), leaving it in
+// accumulator of Grain-128 AEAD state.
+//
+// Key stream doesn't depend on message bits and accumulator is linear in them,
+// so flipping associated data bits changes accumulator by XOR of shift register
+// values at flipped bit positions; that's what this routine computes, by
+// authenticating `old_data ^ new_data` after zeroing accumulator. DER encoded
+// length being same for both, its contribution is cancelled out.
+//
+// See section 2.3 & 2.6.1 of Grain-128 AEAD specification
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/grain-128aead-spec-final.pdf
+static void
+auth_associated_data_delta(
+  grain_128::state_t* const __restrict st,  // Grain-128 AEAD state
+  const uint8_t* const __restrict old_data, // N -bytes old associated data
+  const uint8_t* const __restrict new_data, // N -bytes new associated data
+  const size_t dlen                         // len(data) = N | >= 0
+)
+{
+  // Clock cipher over DER encoded length of associated data, as usual
+
+  uint8_t der[9]{};
+  const size_t der_len = encode_der(dlen, der);
+
+  for (size_t i = 0; i < der_len; i++) {
+    const uint8_t yt0 = grain_128::ksb(st);
+
+    {
+      const uint8_t s120 = grain_128::l(st);
+      const uint8_t b120 = grain_128::f(st);
+
+      grain_128::update_lfsr(st, s120);
+      grain_128::update_nfsr(st, b120);
+    }
+
+    const uint8_t yt1 = grain_128::ksb(st);
+
+    {
+      const uint8_t s120 = grain_128::l(st);
+      const uint8_t b120 = grain_128::f(st);
+
+      grain_128::update_lfsr(st, s120);
+      grain_128::update_nfsr(st, b120);
+    }
+
+    const auto splitted = split_bits<uint8_t>(yt0, yt1);
+    grain_128::authenticate<uint8_t>(st, der[i], splitted.second);
+  }
+
+  // Accumulate contributions of flipped associated data bits only
+
+  std::memset(st->acc, 0, sizeof(st->acc));
+
+  const size_t word_cnt = dlen >> 2;
+  const size_t rm_bytes = dlen & 3ul;
+
+  for (size_t i = 0; i < word_cnt; i++) {
+    const size_t off = i << 2;
+
+    const uint32_t yt0 = grain_128::ksbx32(st);
+
+    {
+      const uint32_t s96 = grain_128::lx32(st);
+      const uint32_t b96 = grain_128::fx32(st);
+
+      grain_128::update_lfsrx32(st, s96);
+      grain_128::update_nfsrx32(st, b96);
+    }
+
+    const uint32_t yt1 = grain_128::ksbx32(st);
+
+    {
+      const uint32_t s96 = grain_128::lx32(st);
+      const uint32_t b96 = grain_128::fx32(st);
+
+      grain_128::update_lfsrx32(st, s96);
+      grain_128::update_nfsrx32(st, b96);
+    }
+
+    uint32_t oldw = 0u;
+    uint32_t neww = 0u;
+
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(&oldw, old_data + off, 4);
+      std::memcpy(&neww, new_data + off, 4);
+    } else {
+      oldw = grain_128::from_le_bytes<uint32_t>(old_data + off);
+      neww = grain_128::from_le_bytes<uint32_t>(new_data + off);
+    }
+
+    const auto splitted = split_bits<uint32_t>(yt0, yt1);
+    grain_128::authenticate<uint32_t>(st, oldw ^ neww, splitted.second);
+  }
+
+  const size_t off = word_cnt << 2;
+
+  for (size_t i = 0; i < rm_bytes; i++) {
+    const uint8_t yt0 = grain_128::ksb(st);
+
+    {
+      const uint8_t s120 = grain_128::l(st);
+      const uint8_t b120 = grain_128::f(st);
+
+      grain_128::update_lfsr(st, s120);
+      grain_128::update_nfsr(st, b120);
+    }
+
+    const uint8_t yt1 = grain_128::ksb(st);
+
+    {
+      const uint8_t s120 = grain_128::l(st);
+      const uint8_t b120 = grain_128::f(st);
+
+      grain_128::update_lfsr(st, s120);
+      grain_128::update_nfsr(st, b120);
+    }
+
+    const uint8_t diff = old_data[off + i] ^ new_data[off + i];
+
+    const auto splitted = split_bits<uint8_t>(yt0, yt1);
+    grain_128::authenticate<uint8_t>(st, diff, splitted.second);
+  }
+}
+
 // Encrypts and authenticates plain text ( 8/ 32 bits at a time ), following
 // specification defined in section 2.3, 2.5 & 2.6.1 of Grain-128 AEAD
 //
 // Find document
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/grain-128aead-spec-final.pdf
+//
+// Optionally, cipher text words are also absorbed into a non-cryptographic
+// checksum ( see `checksum` namespace ), while they're still in registers.
+template<typename S = checksum::none_t>
 static void
 enc_and_auth_txt(grain_128::state_t* const __restrict st,
                  const uint8_t* const __restrict txt,
                  uint8_t* const __restrict enc,
-                 const size_t ctlen)
+                 const size_t ctlen,
+                 S&& sum = S{})
 {
   // Encrypt and authenticate plain text bits
 
@@ -428,6 +591,7 @@ enc_and_auth_txt(grain_128::state_t* const __restrict st,
       grain_128::to_le_bytes<uint32_t>(encw, enc + off);
     }
 
+    sum.update(encw);
     grain_128::authenticate<uint32_t>(st, txtw, splitted.second);
   }
 
@@ -457,8 +621,145 @@ enc_and_auth_txt(grain_128::state_t* const __restrict st,
     const auto splitted = split_bits<uint8_t>(yt0, yt1);
 
     enc[off + i] = txt[off + i] ^ splitted.first; // encrypt
+
+    sum.update(enc[off + i]);
     grain_128::authenticate<uint8_t>(st, txt[off + i], splitted.second);
   }
+
+  GRAIN_USDT1(txt_encrypted, ctlen);
+}
+
+// Checks whether all bytes of given memory region are zero, OR-ing 64 -bit
+// words together, so that compiler can vectorize this check
+inline static bool
+is_zero(const uint8_t* const mem, const size_t mlen)
+{
+  const size_t word_cnt = mlen >> 3;
+  const size_t rm_bytes = mlen & 7ul;
+
+  uint64_t acc = 0ul;
+
+  for (size_t i = 0; i < word_cnt; i++) {
+    uint64_t word;
+    std::memcpy(&word, mem + (i << 3), 8);
+
+    acc |= word;
+  }
+
+  const size_t off = word_cnt << 3;
+
+  for (size_t i = 0; i < rm_bytes; i++) {
+    acc |= mem[off + i];
+  }
+
+  return acc == 0ul;
+}
+
+// Encrypts and authenticates M -bytes of all-zero plain text ( 8/ 32 bits at a
+// time ), without reading plain text at all. Zero message bits don't change
+// accumulator, so only key stream is generated and shift register is updated,
+// while cipher text is simply the even key stream bits.
+//
+// Result is same as calling `enc_and_auth_txt` with zeroed plain text, see
+// section 2.3, 2.5 & 2.6.1 of Grain-128 AEAD specification
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/grain-128aead-spec-final.pdf
+static void
+enc_and_auth_zeros(grain_128::state_t* const __restrict st,
+                   uint8_t* const __restrict enc,
+                   const size_t ctlen)
+{
+  const size_t word_cnt = ctlen >> 2;
+  const size_t rm_bytes = ctlen & 3ul;
+
+  for (size_t i = 0; i < word_cnt; i++) {
+    const size_t off = i << 2;
+
+    const uint32_t yt0 = grain_128::ksbx32(st);
+
+    {
+      const uint32_t s96 = grain_128::lx32(st);
+      const uint32_t b96 = grain_128::fx32(st);
+
+      grain_128::update_lfsrx32(st, s96);
+      grain_128::update_nfsrx32(st, b96);
+    }
+
+    const uint32_t yt1 = grain_128::ksbx32(st);
+
+    {
+      const uint32_t s96 = grain_128::lx32(st);
+      const uint32_t b96 = grain_128::fx32(st);
+
+      grain_128::update_lfsrx32(st, s96);
+      grain_128::update_nfsrx32(st, b96);
+    }
+
+    const auto splitted = split_bits<uint32_t>(yt0, yt1);
+    const uint32_t encw = splitted.first; // encrypt
+
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(enc + off, &encw, 4);
+    } else {
+      grain_128::to_le_bytes<uint32_t>(encw, enc + off);
+    }
+
+    grain_128::authenticate_zero<uint32_t>(st, splitted.second);
+  }
+
+  const size_t off = word_cnt << 2;
+
+  for (size_t i = 0; i < rm_bytes; i++) {
+    const uint8_t yt0 = grain_128::ksb(st);
+
+    {
+      const uint8_t s120 = grain_128::l(st);
+      const uint8_t b120 = grain_128::f(st);
+
+      grain_128::update_lfsr(st, s120);
+      grain_128::update_nfsr(st, b120);
+    }
+
+    const uint8_t yt1 = grain_128::ksb(st);
+
+    {
+      const uint8_t s120 = grain_128::l(st);
+      const uint8_t b120 = grain_128::f(st);
+
+      grain_128::update_lfsr(st, s120);
+      grain_128::update_nfsr(st, b120);
+    }
+
+    const auto splitted = split_bits<uint8_t>(yt0, yt1);
+
+    enc[off + i] = splitted.first; // encrypt
+    grain_128::authenticate_zero<uint8_t>(st, splitted.second);
+  }
+}
+
+// Sparse-aware variant of `enc_and_auth_txt`, which walks plain text in 4KB
+// pages; all-zero pages are processed using `enc_and_auth_zeros`, skipping
+// plain text loads and accumulator updates, while other pages take regular
+// path. Produces bit-identical cipher text and authenticator state.
+//
+// Note, execution time depends on which pages are all-zero, so only use it
+// when sparseness of plain text is not a secret.
+static void
+enc_and_auth_sparse_txt(grain_128::state_t* const __restrict st,
+                        const uint8_t* const __restrict txt,
+                        uint8_t* const __restrict enc,
+                        const size_t ctlen)
+{
+  constexpr size_t page = 4096ul;
+
+  for (size_t off = 0; off < ctlen; off += page) {
+    const size_t len = std::min(page, ctlen - off);
+
+    if (is_zero(txt + off, len)) {
+      enc_and_auth_zeros(st, enc + off, len);
+    } else {
+      enc_and_auth_txt(st, txt + off, enc + off, len);
+    }
+  }
 }
 
 // Decrypts cipher text and authenticates decrypted text ( 8/ 32 bits at a time
@@ -467,11 +768,16 @@ enc_and_auth_txt(grain_128::state_t* const __restrict st,
 //
 // Find document
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/grain-128aead-spec-final.pdf
+//
+// Optionally, incoming cipher text words are also absorbed into a
+// non-cryptographic checksum ( see `checksum` namespace ).
+template<typename S = checksum::none_t>
 static void
 dec_and_auth_txt(grain_128::state_t* const __restrict st,
                  const uint8_t* const __restrict enc,
                  uint8_t* const __restrict txt,
-                 const size_t ctlen)
+                 const size_t ctlen,
+                 S&& sum = S{})
 {
   // Decrypt cipher text and authenticate encrypted text bits
 
@@ -511,6 +817,7 @@ dec_and_auth_txt(grain_128::state_t* const __restrict st,
       encw = grain_128::from_le_bytes<uint32_t>(enc + off);
     }
 
+    sum.update(encw);
     const uint32_t txtw = encw ^ splitted.first; // decrypt
 
     if constexpr (std::endian::native == std::endian::little) {
@@ -547,9 +854,107 @@ dec_and_auth_txt(grain_128::state_t* const __restrict st,
 
     const auto splitted = split_bits<uint8_t>(yt0, yt1);
 
+    sum.update(enc[off + i]);
     txt[off + i] = enc[off + i] ^ splitted.first; // decrypt
     grain_128::authenticate<uint8_t>(st, txt[off + i], splitted.second);
   }
+
+  GRAIN_USDT1(txt_decrypted, ctlen);
+}
+
+// Re-encrypts cipher text, produced under cipher state `sto`, to cipher text
+// under cipher state `stn` ( 32/ 8 bits at a time ), in one pass, while
+// authenticating recovered plain text on both states; both cipher states are
+// clocked in an interleaved manner, so that their independent dependency chains
+// overlap, and plain text never leaves registers.
+//
+// See section 2.3, 2.5 & 2.6.2 of Grain-128 AEAD specification
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/grain-128aead-spec-final.pdf
+static void
+reenc_and_auth_txt(grain_128::state_t* const __restrict sto,
+                   grain_128::state_t* const __restrict stn,
+                   const uint8_t* const __restrict enc,
+                   uint8_t* const __restrict out,
+                   const size_t ctlen)
+{
+  const size_t word_cnt = ctlen >> 2;
+  const size_t rm_bytes = ctlen & 3ul;
+
+  for (size_t i = 0; i < word_cnt; i++) {
+    const size_t off = i << 2;
+
+    uint32_t yo[2], yn[2];
+
+    for (size_t j = 0; j < 2; j++) {
+      yo[j] = grain_128::ksbx32(sto);
+      yn[j] = grain_128::ksbx32(stn);
+
+      const uint32_t so96 = grain_128::lx32(sto);
+      const uint32_t sn96 = grain_128::lx32(stn);
+      const uint32_t bo96 = grain_128::fx32(sto);
+      const uint32_t bn96 = grain_128::fx32(stn);
+
+      grain_128::update_lfsrx32(sto, so96);
+      grain_128::update_lfsrx32(stn, sn96);
+      grain_128::update_nfsrx32(sto, bo96);
+      grain_128::update_nfsrx32(stn, bn96);
+    }
+
+    const auto splo = split_bits<uint32_t>(yo[0], yo[1]);
+    const auto spln = split_bits<uint32_t>(yn[0], yn[1]);
+
+    uint32_t encw = 0u;
+
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(&encw, enc + off, 4);
+    } else {
+      encw = grain_128::from_le_bytes<uint32_t>(enc + off);
+    }
+
+    const uint32_t txtw = encw ^ splo.first;  // decrypt
+    const uint32_t outw = txtw ^ spln.first; // encrypt
+
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(out + off, &outw, 4);
+    } else {
+      grain_128::to_le_bytes<uint32_t>(outw, out + off);
+    }
+
+    grain_128::authenticate<uint32_t>(sto, txtw, splo.second);
+    grain_128::authenticate<uint32_t>(stn, txtw, spln.second);
+  }
+
+  const size_t off = word_cnt << 2;
+
+  for (size_t i = 0; i < rm_bytes; i++) {
+    uint8_t yo[2], yn[2];
+
+    for (size_t j = 0; j < 2; j++) {
+      yo[j] = grain_128::ksb(sto);
+      yn[j] = grain_128::ksb(stn);
+
+      const uint8_t so120 = grain_128::l(sto);
+      const uint8_t sn120 = grain_128::l(stn);
+      const uint8_t bo120 = grain_128::f(sto);
+      const uint8_t bn120 = grain_128::f(stn);
+
+      grain_128::update_lfsr(sto, so120);
+      grain_128::update_lfsr(stn, sn120);
+      grain_128::update_nfsr(sto, bo120);
+      grain_128::update_nfsr(stn, bn120);
+    }
+
+    const auto splo = split_bits<uint8_t>(yo[0], yo[1]);
+    const auto spln = split_bits<uint8_t>(yn[0], yn[1]);
+
+    const uint8_t txtb = enc[off + i] ^ splo.first; // decrypt
+    out[off + i] = txtb ^ spln.first;               // encrypt
+
+    grain_128::authenticate<uint8_t>(sto, txtb, splo.second);
+    grain_128::authenticate<uint8_t>(stn, txtb, spln.second);
+  }
+
+  GRAIN_USDT1(txt_reencrypted, ctlen);
 }
 
 // Authenticates padding of single bit ( set to 1 ), following specification
@@ -586,6 +991,8 @@ auth_padding_bit(grain_128::state_t* const st)
 
   const auto splitted = split_bits<uint8_t>(yt0, yt1);
   grain_128::authenticate<uint8_t>(st, padding, splitted.second);
+
+  GRAIN_USDT0(finalized);
 }
 
 }
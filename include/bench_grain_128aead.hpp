@@ -1,7 +1,20 @@
 #pragma once
+#include "decoupled.hpp"
 #include "grain_128aead.hpp"
+#include "key_rcu.hpp"
+#include "nonce_guard.hpp"
+#include "redundant.hpp"
+#include "trial_open.hpp"
 #include "utils.hpp"
+#include "width_policy.hpp"
+#include "zc_send.hpp"
 #include <benchmark/benchmark.h>
+#include <chrono>
+#include <dlfcn.h>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <sys/mman.h>
 
 // Benchmark Grain-128 AEAD
 namespace bench_grain_128aead {
@@ -125,4 +138,1019 @@ decrypt(benchmark::State& state)
   std::free(dec);
 }
 
+// Benchmarks Grain-128 AEAD encryption, where LFSR word sequence is generated
+// in bulk, with `lanes` -many parallel segments ( see `decoupled::encrypt` ),
+// with variable length associated data & plain text
+template<const size_t lanes>
+static void
+decoupled_encrypt(benchmark::State& state)
+{
+  constexpr size_t klen = 16;
+  constexpr size_t nlen = 12;
+  constexpr size_t tlen = 8;
+
+  const size_t dlen = state.range(0);
+  const size_t ctlen = state.range(1);
+
+  uint8_t* key = static_cast<uint8_t*>(std::malloc(klen));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(nlen));
+  uint8_t* tag = static_cast<uint8_t*>(std::malloc(tlen));
+  uint8_t* data = static_cast<uint8_t*>(std::malloc(dlen));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ctlen));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ctlen));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ctlen));
+
+  random_data(key, klen);
+  random_data(nonce, nlen);
+  random_data(data, dlen);
+  random_data(txt, ctlen);
+
+  std::memset(tag, 0, tlen);
+  std::memset(enc, 0, ctlen);
+  std::memset(dec, 0, ctlen);
+
+  for (auto _ : state) {
+    decoupled::encrypt<lanes>(key, nonce, data, dlen, txt, enc, ctlen, tag);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::DoNotOptimize(tag);
+    benchmark::ClobberMemory();
+  }
+
+  bool f = false;
+  f = grain_128aead::decrypt(key, nonce, tag, data, dlen, enc, dec, ctlen);
+  assert(f);
+
+  for (size_t i = 0; i < ctlen; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t per_itr_data = dlen + ctlen;
+  const size_t total_data = per_itr_data * state.iterations();
+
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(key);
+  std::free(nonce);
+  std::free(tag);
+  std::free(data);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmarks Grain-128 AEAD encryption, fused with non-cryptographic checksum
+// computation over cipher text ( see `checksum` namespace )
+template<typename S>
+static void
+encrypt_checksum(benchmark::State& state)
+{
+  constexpr size_t klen = 16;
+  constexpr size_t nlen = 12;
+  constexpr size_t tlen = 8;
+
+  const size_t dlen = state.range(0);
+  const size_t ctlen = state.range(1);
+
+  uint8_t* key = static_cast<uint8_t*>(std::malloc(klen));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(nlen));
+  uint8_t* tag = static_cast<uint8_t*>(std::malloc(tlen));
+  uint8_t* data = static_cast<uint8_t*>(std::malloc(dlen));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ctlen));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ctlen));
+
+  random_data(key, klen);
+  random_data(nonce, nlen);
+  random_data(data, dlen);
+  random_data(txt, ctlen);
+
+  std::memset(tag, 0, tlen);
+  std::memset(enc, 0, ctlen);
+
+  for (auto _ : state) {
+    S sum;
+    grain_128aead::encrypt_checksum(
+      key, nonce, data, dlen, txt, enc, ctlen, tag, sum);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::DoNotOptimize(tag);
+    benchmark::DoNotOptimize(sum.digest());
+    benchmark::ClobberMemory();
+  }
+
+  S sum0, sum1;
+  sum0.update(enc, ctlen);
+  bool f = false;
+  f = grain_128aead::decrypt_checksum(
+    key, nonce, tag, data, dlen, enc, txt, ctlen, sum1);
+  assert(f);
+  assert(sum0.digest() == sum1.digest());
+
+  const size_t per_itr_data = dlen + ctlen;
+  const size_t total_data = per_itr_data * state.iterations();
+
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(key);
+  std::free(nonce);
+  std::free(tag);
+  std::free(data);
+  std::free(txt);
+  std::free(enc);
+}
+
+// Benchmarks Grain-128 AEAD encryption, with a fraction ( given in parts per
+// million, as third argument ) of calls being re-computed by checker threads,
+// for catching silently corrupting cores
+static void
+encrypt_sampled(benchmark::State& state)
+{
+  constexpr size_t klen = 16;
+  constexpr size_t nlen = 12;
+  constexpr size_t tlen = 8;
+
+  const size_t dlen = state.range(0);
+  const size_t ctlen = state.range(1);
+  const double fraction = static_cast<double>(state.range(2)) * 1e-6;
+
+  std::vector<uint8_t> key(klen), nonce(nlen), tag(tlen);
+  std::vector<uint8_t> data(dlen), txt(ctlen), enc(ctlen);
+
+  random_data(key.data(), klen);
+  random_data(nonce.data(), nlen);
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  redundant::config_t cfg;
+  cfg.fraction = fraction;
+
+  redundant::checker_t checker(cfg, nullptr);
+
+  for (auto _ : state) {
+    checker.encrypt(key.data(),
+                    nonce.data(),
+                    data.data(),
+                    dlen,
+                    txt.data(),
+                    enc.data(),
+                    ctlen,
+                    tag.data());
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::DoNotOptimize(tag);
+    benchmark::ClobberMemory();
+  }
+
+  checker.drain();
+
+  const auto st = checker.stats();
+  assert(st.mismatches == 0);
+
+  state.counters["sampled"] = static_cast<double>(st.sampled);
+  state.counters["dropped"] = static_cast<double>(st.dropped);
+
+  const size_t per_itr_data = dlen + ctlen;
+  const size_t total_data = per_itr_data * state.iterations();
+
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+}
+
+// Benchmarks Grain-128 AEAD encryption, with fresh ( counter ) nonce per call,
+// either plain ( when `guarded` is false ) or checked against nonce-reuse
+// detector first ( see `nonce_guard::encrypt` ), reporting worst per-call
+// latency too, so that cost of generation rotation in detector shows up
+template<const bool guarded>
+static void
+guarded_encrypt(benchmark::State& state)
+{
+  constexpr size_t klen = 16;
+  constexpr size_t nlen = 12;
+  constexpr size_t tlen = 8;
+
+  const size_t dlen = state.range(0);
+  const size_t ctlen = state.range(1);
+
+  std::vector<uint8_t> key(klen), nonce(nlen), tag(tlen);
+  std::vector<uint8_t> data(dlen), txt(ctlen), enc(ctlen);
+
+  random_data(key.data(), klen);
+  random_data(nonce.data(), nlen);
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  // single shard, so that every insertion lands in same one & rotations happen
+  // as often as possible
+  auto guard =
+    std::make_unique<nonce_guard::filter_t<1, 4096>>(nullptr, nullptr);
+
+  using steady_t = std::chrono::steady_clock;
+
+  uint64_t ctr = 0;
+  int64_t worst = 0;
+
+  for (auto _ : state) {
+    std::memcpy(nonce.data(), &ctr, sizeof(ctr));
+    ctr++;
+
+    const auto t0 = steady_t::now();
+    if constexpr (guarded) {
+      nonce_guard::encrypt(*guard,
+                           1ul,
+                           key.data(),
+                           nonce.data(),
+                           data.data(),
+                           dlen,
+                           txt.data(),
+                           enc.data(),
+                           ctlen,
+                           tag.data());
+    } else {
+      grain_128aead::encrypt(key.data(),
+                             nonce.data(),
+                             data.data(),
+                             dlen,
+                             txt.data(),
+                             enc.data(),
+                             ctlen,
+                             tag.data());
+    }
+    const auto t1 = steady_t::now();
+
+    using ns = std::chrono::nanoseconds;
+    worst = std::max<int64_t>(
+      worst, std::chrono::duration_cast<ns>(t1 - t0).count());
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::DoNotOptimize(tag);
+    benchmark::ClobberMemory();
+  }
+
+  state.counters["max_ns"] = static_cast<double>(worst);
+
+  const size_t per_itr_data = dlen + ctlen;
+  const size_t total_data = per_itr_data * state.iterations();
+
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+}
+
+// Number of candidate keys, used by trial decryption benchmarks
+constexpr size_t TRIAL_KEYS = 4;
+
+// Benchmarks trial decryption of message, sealed under last of `TRIAL_KEYS`
+// candidate keys, either by serially calling `grain_128aead::decrypt` with
+// each candidate ( when `interleaved` is false ) or by verifying all of them
+// in one interleaved pass ( see `trial_open::open` )
+template<const bool interleaved>
+static void
+trial_decrypt(benchmark::State& state)
+{
+  const size_t dlen = state.range(0);
+  const size_t ctlen = state.range(1);
+
+  std::vector<uint8_t> keys(TRIAL_KEYS * 16), nonce(12), tag(8);
+  std::vector<uint8_t> data(dlen), txt(ctlen), enc(ctlen), dec(ctlen);
+
+  random_data(keys.data(), keys.size());
+  random_data(nonce.data(), nonce.size());
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  const uint8_t* kptrs[TRIAL_KEYS];
+  for (size_t k = 0; k < TRIAL_KEYS; k++) {
+    kptrs[k] = keys.data() + k * 16;
+  }
+
+  grain_128aead::encrypt(kptrs[TRIAL_KEYS - 1],
+                         nonce.data(),
+                         data.data(),
+                         dlen,
+                         txt.data(),
+                         enc.data(),
+                         ctlen,
+                         tag.data());
+
+  ptrdiff_t idx = -1;
+
+  for (auto _ : state) {
+    if constexpr (interleaved) {
+      idx = trial_open::open(kptrs,
+                             TRIAL_KEYS,
+                             nonce.data(),
+                             tag.data(),
+                             data.data(),
+                             dlen,
+                             enc.data(),
+                             dec.data(),
+                             ctlen);
+    } else {
+      idx = -1;
+      for (size_t k = 0; k < TRIAL_KEYS && idx < 0; k++) {
+        if (grain_128aead::decrypt(kptrs[k],
+                                   nonce.data(),
+                                   tag.data(),
+                                   data.data(),
+                                   dlen,
+                                   enc.data(),
+                                   dec.data(),
+                                   ctlen)) {
+          idx = static_cast<ptrdiff_t>(k);
+        }
+      }
+    }
+
+    benchmark::DoNotOptimize(idx);
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  assert(idx == static_cast<ptrdiff_t>(TRIAL_KEYS - 1));
+  assert(dec == txt);
+
+  const size_t per_itr_data = dlen + ctlen;
+  const size_t total_data = per_itr_data * state.iterations();
+
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+}
+
+// Benchmarks moving sealed message from old to new key, either by decrypting
+// into a plain text buffer & encrypting it again ( when `fused` is false ) or
+// by single pass `grain_128aead::reseal`
+template<const bool fused>
+static void
+reseal(benchmark::State& state)
+{
+  const size_t dlen = state.range(0);
+  const size_t ctlen = state.range(1);
+
+  std::vector<uint8_t> okey(16), nkey(16), nonce(12), otag(8), ntag(8);
+  std::vector<uint8_t> data(dlen), txt(ctlen), enc(ctlen), out(ctlen);
+  std::vector<uint8_t> dec(ctlen);
+
+  random_data(okey.data(), okey.size());
+  random_data(nkey.data(), nkey.size());
+  random_data(nonce.data(), nonce.size());
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  grain_128aead::encrypt(okey.data(),
+                         nonce.data(),
+                         data.data(),
+                         dlen,
+                         txt.data(),
+                         enc.data(),
+                         ctlen,
+                         otag.data());
+
+  bool f = false;
+
+  for (auto _ : state) {
+    if constexpr (fused) {
+      f = grain_128aead::reseal(okey.data(),
+                                nonce.data(),
+                                otag.data(),
+                                data.data(),
+                                dlen,
+                                nkey.data(),
+                                nonce.data(),
+                                data.data(),
+                                dlen,
+                                enc.data(),
+                                out.data(),
+                                ctlen,
+                                ntag.data());
+    } else {
+      f = grain_128aead::decrypt(okey.data(),
+                                 nonce.data(),
+                                 otag.data(),
+                                 data.data(),
+                                 dlen,
+                                 enc.data(),
+                                 dec.data(),
+                                 ctlen);
+      grain_128aead::encrypt(nkey.data(),
+                             nonce.data(),
+                             data.data(),
+                             dlen,
+                             dec.data(),
+                             out.data(),
+                             ctlen,
+                             ntag.data());
+    }
+
+    benchmark::DoNotOptimize(f);
+    benchmark::DoNotOptimize(out);
+    benchmark::DoNotOptimize(ntag);
+    benchmark::ClobberMemory();
+  }
+
+  assert(f);
+  f = grain_128aead::decrypt(nkey.data(),
+                             nonce.data(),
+                             ntag.data(),
+                             data.data(),
+                             dlen,
+                             out.data(),
+                             dec.data(),
+                             ctlen);
+  assert(f);
+  assert(dec == txt);
+
+  const size_t per_itr_data = dlen + ctlen;
+  const size_t total_data = per_itr_data * state.iterations();
+
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+}
+
+// Size of buffer streamed through, for evicting cipher state, inputs & code
+// from data & unified caches, before each cold start benchmark iteration
+constexpr size_t EVICT_LEN = 32ul << 20;
+
+// Benchmarks latency of first `calls` -many encryptions ( second argument ) of
+// `ctlen` -bytes plain text ( first argument ), after a simulated cold start:
+// caches are flushed by streaming through a large buffer and output is written
+// to freshly mapped ( hence not yet faulted in ) pages. When `warm` is true,
+// `grain_128aead::warm_up` runs between cold start & timed calls, pre-faulting
+// output pages, as a latency sensitive worker would do while idle.
+//
+// Only the timed calls are measured, so cost of warm-up itself isn't included.
+template<const bool warm>
+static void
+cold_encrypt(benchmark::State& state)
+{
+  const size_t ctlen = state.range(0);
+  const size_t calls = state.range(1);
+  const size_t olen = std::max<size_t>(ctlen * calls, 1);
+
+  std::vector<uint8_t> key(16), nonce(12), tag(8), data(32), txt(ctlen);
+  std::vector<uint8_t> evict(EVICT_LEN);
+
+  random_data(key.data(), key.size());
+  random_data(nonce.data(), nonce.size());
+  random_data(data.data(), data.size());
+  random_data(txt.data(), ctlen);
+
+  uint8_t fill = 0;
+
+  for (auto _ : state) {
+    std::memset(evict.data(), ++fill, evict.size());
+    benchmark::DoNotOptimize(evict.data());
+    benchmark::ClobberMemory();
+
+    void* const mem = mmap(nullptr,
+                           olen,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS,
+                           -1,
+                           0);
+    if (mem == MAP_FAILED) {
+      state.SkipWithError("failed to map output buffer");
+      break;
+    }
+    uint8_t* const out = static_cast<uint8_t*>(mem);
+
+    if constexpr (warm) {
+      grain_128aead::warm_up(2, out, olen);
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < calls; i++) {
+      grain_128aead::encrypt(key.data(),
+                             nonce.data(),
+                             data.data(),
+                             data.size(),
+                             txt.data(),
+                             out + i * ctlen,
+                             ctlen,
+                             tag.data());
+    }
+    benchmark::DoNotOptimize(tag);
+    benchmark::ClobberMemory();
+    const auto t1 = std::chrono::steady_clock::now();
+
+    state.SetIterationTime(std::chrono::duration<double>(t1 - t0).count());
+    munmap(mem, olen);
+  }
+
+  state.counters["per_call"] = benchmark::Counter(
+    static_cast<double>(state.iterations() * calls),
+    benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.SetBytesProcessed(
+    static_cast<int64_t>((data.size() + ctlen) * calls * state.iterations()));
+}
+
+// Signatures of C ABI exported by `libgrain_128aead.so` ( see
+// wrapper/grain_128aead.cpp )
+using c_encrypt_t = void (*)(const uint8_t*,
+                             const uint8_t*,
+                             const uint8_t*,
+                             size_t,
+                             const uint8_t*,
+                             uint8_t*,
+                             size_t,
+                             uint8_t*);
+using c_decrypt_t = bool (*)(const uint8_t*,
+                             const uint8_t*,
+                             const uint8_t*,
+                             const uint8_t*,
+                             size_t,
+                             const uint8_t*,
+                             uint8_t*,
+                             size_t);
+
+// C ABI entry points, resolved from shared library object, which is dlopen'd
+// only once, from path in `GRAIN_128AEAD_SO` environment variable ( defaults to
+// wrapper/libgrain_128aead.so, built using `make lib` ); both are null if it
+// couldn't be loaded
+struct c_abi_t
+{
+  c_encrypt_t encrypt = nullptr;
+  c_decrypt_t decrypt = nullptr;
+};
+
+static const c_abi_t&
+c_abi()
+{
+  static const c_abi_t abi = [] {
+    c_abi_t a;
+
+    const char* path = std::getenv("GRAIN_128AEAD_SO");
+    if (path == nullptr) {
+      path = "wrapper/libgrain_128aead.so";
+    }
+
+    void* const so = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (so != nullptr) {
+      a.encrypt = reinterpret_cast<c_encrypt_t>(
+        dlsym(so, "grain_128aead_encrypt"));
+      a.decrypt = reinterpret_cast<c_decrypt_t>(
+        dlsym(so, "grain_128aead_decrypt"));
+    }
+    return a;
+  }();
+
+  return abi;
+}
+
+// Benchmarks Grain-128 AEAD encryption, either by calling header-only
+// implementation directly ( when `shared` is false ), so that it's inlined into
+// call site, or through C ABI of dlopen'd shared library object, paying for an
+// indirect call across a non-inlinable boundary. Along with Python wrapper
+// timings, these are compared by tools/ffi_overhead.py, for finding fixed
+// per-call cost of each path.
+template<const bool shared>
+static void
+ffi_encrypt(benchmark::State& state)
+{
+  const size_t dlen = state.range(0);
+  const size_t ctlen = state.range(1);
+
+  const c_encrypt_t fn = c_abi().encrypt;
+  if (shared && fn == nullptr) {
+    state.SkipWithError("failed to load libgrain_128aead.so");
+    return;
+  }
+
+  std::vector<uint8_t> key(16), nonce(12), tag(8);
+  std::vector<uint8_t> data(dlen), txt(ctlen), enc(ctlen);
+
+  random_data(key.data(), key.size());
+  random_data(nonce.data(), nonce.size());
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  for (auto _ : state) {
+    if constexpr (shared) {
+      fn(key.data(),
+         nonce.data(),
+         data.data(),
+         dlen,
+         txt.data(),
+         enc.data(),
+         ctlen,
+         tag.data());
+    } else {
+      grain_128aead::encrypt(key.data(),
+                             nonce.data(),
+                             data.data(),
+                             dlen,
+                             txt.data(),
+                             enc.data(),
+                             ctlen,
+                             tag.data());
+    }
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::DoNotOptimize(tag);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(
+    static_cast<int64_t>((dlen + ctlen) * state.iterations()));
+}
+
+// Same as `ffi_encrypt`, for decryption ( which always verifies )
+template<const bool shared>
+static void
+ffi_decrypt(benchmark::State& state)
+{
+  const size_t dlen = state.range(0);
+  const size_t ctlen = state.range(1);
+
+  const c_decrypt_t fn = c_abi().decrypt;
+  if (shared && fn == nullptr) {
+    state.SkipWithError("failed to load libgrain_128aead.so");
+    return;
+  }
+
+  std::vector<uint8_t> key(16), nonce(12), tag(8);
+  std::vector<uint8_t> data(dlen), txt(ctlen), enc(ctlen), dec(ctlen);
+
+  random_data(key.data(), key.size());
+  random_data(nonce.data(), nonce.size());
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  grain_128aead::encrypt(key.data(),
+                         nonce.data(),
+                         data.data(),
+                         dlen,
+                         txt.data(),
+                         enc.data(),
+                         ctlen,
+                         tag.data());
+
+  bool f = false;
+
+  for (auto _ : state) {
+    if constexpr (shared) {
+      f = fn(key.data(),
+             nonce.data(),
+             tag.data(),
+             data.data(),
+             dlen,
+             enc.data(),
+             dec.data(),
+             ctlen);
+    } else {
+      f = grain_128aead::decrypt(key.data(),
+                                 nonce.data(),
+                                 tag.data(),
+                                 data.data(),
+                                 dlen,
+                                 enc.data(),
+                                 dec.data(),
+                                 ctlen);
+    }
+
+    benchmark::DoNotOptimize(f);
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  assert(f);
+  assert(dec == txt);
+
+  state.SetBytesProcessed(
+    static_cast<int64_t>((dlen + ctlen) * state.iterations()));
+}
+
+// Runs `spin` -many steps of a scalar integer hot loop, standing in for non
+// crypto work, co-located on same core
+inline static uint64_t
+scalar_spin(uint64_t x, const size_t spin)
+{
+  for (size_t i = 0; i < spin; i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    x *= 0x9e3779b97f4a7c15ul;
+  }
+  return x;
+}
+
+// Benchmarks a mixed workload, where each iteration encrypts `ctlen` -bytes (
+// first argument ) and then runs `spin` -many steps of scalar hot loop ( second
+// argument ), using decoupled kernels with fixed `lanes` or, when lanes = 0,
+// lanes picked by `width_policy::selector_t`. Reported time is of whole
+// iteration, while `spin_ns` is time of scalar loop alone, which grows when
+// wide vector bursts lower core frequency.
+template<const size_t lanes>
+static void
+mixed_load(benchmark::State& state)
+{
+  const size_t dlen = 32;
+  const size_t ctlen = state.range(0);
+  const size_t spin = state.range(1);
+
+  std::vector<uint8_t> key(16), nonce(12), tag(8);
+  std::vector<uint8_t> data(dlen), txt(ctlen), enc(ctlen);
+
+  random_data(key.data(), key.size());
+  random_data(nonce.data(), nonce.size());
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  width_policy::selector_t sel;
+
+  uint64_t x = 1;
+  double spin_ns = 0.;
+
+  for (auto _ : state) {
+    if constexpr (lanes == 0) {
+      sel.encrypt(key.data(),
+                  nonce.data(),
+                  data.data(),
+                  dlen,
+                  txt.data(),
+                  enc.data(),
+                  ctlen,
+                  tag.data());
+    } else {
+      decoupled::encrypt<lanes>(key.data(),
+                                nonce.data(),
+                                data.data(),
+                                dlen,
+                                txt.data(),
+                                enc.data(),
+                                ctlen,
+                                tag.data());
+    }
+    benchmark::DoNotOptimize(enc);
+    benchmark::DoNotOptimize(tag);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    x = scalar_spin(x + tag[0], spin);
+    benchmark::DoNotOptimize(x);
+    const auto t1 = std::chrono::steady_clock::now();
+
+    spin_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+  }
+
+  state.counters["spin_ns"] =
+    spin_ns / static_cast<double>(std::max<size_t>(state.iterations(), 1));
+
+  if constexpr (lanes == 0) {
+    const auto st = sel.stats();
+    const auto ob = sel.observed();
+
+    state.counters["scalar"] = static_cast<double>(st.scalar_calls);
+    state.counters["v256"] = static_cast<double>(st.v256_calls);
+    state.counters["v512"] = static_cast<double>(st.v512_calls);
+    state.counters["switches"] = static_cast<double>(st.switches);
+    state.counters["duty"] = ob.duty;
+  }
+
+  state.SetBytesProcessed(
+    static_cast<int64_t>((dlen + ctlen) * state.iterations()));
+}
+
+// Connects a pair of TCP sockets over loopback, returning false on failure
+inline static bool
+loopback_pair(int& tx, int& rx)
+{
+  const int lsock = socket(AF_INET, SOCK_STREAM, 0);
+  if (lsock < 0) {
+    return false;
+  }
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t alen = sizeof(addr);
+
+  bool ok = bind(lsock, reinterpret_cast<sockaddr*>(&addr), alen) == 0 &&
+            listen(lsock, 1) == 0 &&
+            getsockname(lsock, reinterpret_cast<sockaddr*>(&addr), &alen) == 0;
+
+  tx = ok ? socket(AF_INET, SOCK_STREAM, 0) : -1;
+  ok = ok && tx >= 0 &&
+       connect(tx, reinterpret_cast<sockaddr*>(&addr), alen) == 0;
+  rx = ok ? accept(lsock, nullptr, nullptr) : -1;
+
+  close(lsock);
+  return ok && rx >= 0;
+}
+
+// Benchmarks streaming a file of `flen` -bytes ( first argument ) as sealed
+// records over loopback TCP, either through mapped file, ring of send buffers
+// & MSG_ZEROCOPY ( when `zerocopy` is true, see `zc_send::sender_t` ) or
+// through plain read/ encrypt/ send loop. Receiver thread only drains socket;
+// each iteration ends once it has received whole stream.
+//
+// Note, kernel always copies zero-copy sends over loopback, so sender falls
+// back to regular sends from its ring ( see `zc` & `copied` counters ); real
+// gains need a NIC.
+template<const bool zerocopy>
+static void
+file_send(benchmark::State& state)
+{
+  const size_t flen = state.range(0);
+
+  std::vector<uint8_t> key(16), nonce(12), txt(flen);
+
+  random_data(key.data(), key.size());
+  random_data(nonce.data(), nonce.size());
+  random_data(txt.data(), flen);
+
+  FILE* const tmp = std::tmpfile();
+  const int fd = tmp != nullptr ? fileno(tmp) : -1;
+  if (fd < 0 || write(fd, txt.data(), flen) != static_cast<ssize_t>(flen)) {
+    state.SkipWithError("failed to create input file");
+    return;
+  }
+
+  int tx = -1, rx = -1;
+  if (!loopback_pair(tx, rx)) {
+    state.SkipWithError("failed to connect over loopback");
+    return;
+  }
+
+  const zc_send::config_t cfg;
+  const size_t cnt = std::max<size_t>((flen + cfg.chunk - 1) / cfg.chunk, 1);
+  const uint64_t per_itr = flen + cnt * (zc_send::HDR_LEN + zc_send::TAG_LEN);
+
+  std::atomic<uint64_t> received{ 0 };
+  std::thread drain([&] {
+    std::vector<uint8_t> buf(1ul << 18);
+    while (true) {
+      const ssize_t n = recv(rx, buf.data(), buf.size(), 0);
+      if (n <= 0) {
+        break;
+      }
+      received.fetch_add(static_cast<uint64_t>(n), std::memory_order_release);
+    }
+  });
+
+  zc_send::sender_t sender(tx, cfg);
+  uint64_t expected = 0;
+  bool ok = true;
+
+  for (auto _ : state) {
+    if constexpr (zerocopy) {
+      ok = sender.send_file(key.data(), nonce.data(), fd, flen);
+    } else {
+      ok = zc_send::send_file_copy(
+        key.data(), nonce.data(), fd, flen, tx, cfg.chunk);
+    }
+
+    expected += per_itr;
+    while (ok && received.load(std::memory_order_acquire) < expected) {
+      std::this_thread::yield();
+    }
+    if (!ok) {
+      state.SkipWithError("failed to send file");
+      break;
+    }
+  }
+
+  sender.drain();
+  shutdown(tx, SHUT_WR);
+  drain.join();
+  close(tx);
+  close(rx);
+  std::fclose(tmp);
+
+  const auto st = sender.stats();
+  state.counters["zc"] = static_cast<double>(st.zc_sends);
+  state.counters["copied"] = static_cast<double>(st.copied);
+  state.SetBytesProcessed(static_cast<int64_t>(flen * state.iterations()));
+}
+
+// Key rotation period ( in iterations of first benchmark thread ), used by
+// shared key holder benchmarks
+constexpr size_t ROTATE_EVERY = 4096;
+
+// Benchmarks Grain-128 AEAD encryption, by many threads, under a key shared
+// through RCU-style `key_rcu::holder_t`, which is rotated periodically by first
+// thread
+static void
+shared_key_rcu(benchmark::State& state)
+{
+  static uint8_t key0[16]{};
+  static key_rcu::holder_t holder(key0, 1024);
+
+  const size_t dlen = state.range(0);
+  const size_t ctlen = state.range(1);
+
+  std::vector<uint8_t> data(dlen);
+  std::vector<uint8_t> txt(ctlen);
+  std::vector<uint8_t> enc(key_rcu::GEN_LEN + ctlen);
+  uint8_t nonce[12]{};
+  uint8_t tag[8]{};
+
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  const auto rd = holder.reader();
+  size_t itr = 0;
+
+  for (auto _ : state) {
+    key_rcu::encrypt(
+      rd, nonce, data.data(), dlen, txt.data(), enc.data(), ctlen, tag);
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::DoNotOptimize(tag);
+    benchmark::ClobberMemory();
+
+    if (state.thread_index() == 0 && (++itr % ROTATE_EVERY) == 0) {
+      uint8_t key[16];
+      random_data(key, sizeof(key));
+      holder.rotate(key);
+    }
+  }
+
+  state.SetBytesProcessed(
+    static_cast<int64_t>((dlen + ctlen) * state.iterations()));
+}
+
+// Same as `shared_key_rcu`, while key is guarded by a mutex, being copied out
+// for each message
+static void
+shared_key_mutex(benchmark::State& state)
+{
+  static std::mutex mtx;
+  static uint8_t shared[16]{};
+
+  const size_t dlen = state.range(0);
+  const size_t ctlen = state.range(1);
+
+  std::vector<uint8_t> data(dlen);
+  std::vector<uint8_t> txt(ctlen);
+  std::vector<uint8_t> enc(ctlen);
+  uint8_t nonce[12]{};
+  uint8_t tag[8]{};
+
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  size_t itr = 0;
+
+  for (auto _ : state) {
+    uint8_t key[16];
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      std::memcpy(key, shared, sizeof(key));
+    }
+
+    grain_128aead::encrypt(
+      key, nonce, data.data(), dlen, txt.data(), enc.data(), ctlen, tag);
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::DoNotOptimize(tag);
+    benchmark::ClobberMemory();
+
+    if (state.thread_index() == 0 && (++itr % ROTATE_EVERY) == 0) {
+      std::lock_guard<std::mutex> lock(mtx);
+      random_data(shared, sizeof(shared));
+    }
+  }
+
+  state.SetBytesProcessed(
+    static_cast<int64_t>((dlen + ctlen) * state.iterations()));
+}
+
+// Same as `shared_key_rcu`, while key is published as `std::shared_ptr`, which
+// readers load atomically ( bumping shared reference count )
+static void
+shared_key_shared_ptr(benchmark::State& state)
+{
+  static std::shared_ptr<const key_rcu::snapshot_t> shared =
+    std::make_shared<const key_rcu::snapshot_t>();
+
+  const size_t dlen = state.range(0);
+  const size_t ctlen = state.range(1);
+
+  std::vector<uint8_t> data(dlen);
+  std::vector<uint8_t> txt(ctlen);
+  std::vector<uint8_t> enc(ctlen);
+  uint8_t nonce[12]{};
+  uint8_t tag[8]{};
+
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  size_t itr = 0;
+
+  for (auto _ : state) {
+    const auto snap = std::atomic_load(&shared);
+
+    grain_128aead::encrypt(
+      snap->key, nonce, data.data(), dlen, txt.data(), enc.data(), ctlen, tag);
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::DoNotOptimize(tag);
+    benchmark::ClobberMemory();
+
+    if (state.thread_index() == 0 && (++itr % ROTATE_EVERY) == 0) {
+      auto next = std::make_shared<key_rcu::snapshot_t>();
+      random_data(next->key, sizeof(next->key));
+      std::atomic_store(&shared,
+                        std::shared_ptr<const key_rcu::snapshot_t>(next));
+    }
+  }
+
+  state.SetBytesProcessed(
+    static_cast<int64_t>((dlen + ctlen) * state.iterations()));
+}
+
 }
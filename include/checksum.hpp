@@ -0,0 +1,237 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined __SSE4_2__
+#include <nmmintrin.h>
+#elif defined __ARM_FEATURE_CRC32
+#include <arm_acle.h>
+#endif
+
+// Non-cryptographic, streaming checksums ( CRC32C & xxHash32 ), which can be
+// updated with cipher text words, while they're still in registers, inside
+// encryption/ decryption loop ( see `aead::enc_and_auth_txt` ), so that storage
+// layers don't need a second pass over cipher text for computing dedup/ scrub
+// checksums.
+//
+// Each checksum type offers
+//
+// - update(uint32_t) : absorbs 4 bytes, given as little endian word
+// - update(uint8_t)  : absorbs single byte
+// - update(const uint8_t*, size_t) : absorbs byte string
+// - digest()         : 32 -bit checksum of all bytes absorbed so far
+//
+// Digests are same as what standalone CRC32C/ xxHash32 computes over same byte
+// sequence, no matter how it's split into words/ bytes.
+namespace checksum {
+
+// Checksum which does nothing, used as default by encryption/ decryption
+// routines, so that compiler drops checksum updates altogether
+struct none_t
+{
+  inline void update(const uint32_t) {}
+  inline void update(const uint8_t) {}
+  inline void update(const uint8_t* const, const size_t) {}
+  inline uint32_t digest() const { return 0u; }
+};
+
+// CRC32C ( Castagnoli ) reflected polynomial
+constexpr uint32_t CRC32C_POLY = 0x82f63b78u;
+
+// Slicing-by-4 lookup tables of CRC32C, used when CRC32 instructions are not
+// available
+inline constexpr std::array<std::array<uint32_t, 256>, 4>
+crc32c_tables()
+{
+  std::array<std::array<uint32_t, 256>, 4> tbl{};
+
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t c = i;
+    for (size_t j = 0; j < 8; j++) {
+      c = (c >> 1) ^ (CRC32C_POLY & (0u - (c & 1u)));
+    }
+    tbl[0][i] = c;
+  }
+
+  for (size_t t = 1; t < 4; t++) {
+    for (uint32_t i = 0; i < 256; i++) {
+      const uint32_t c = tbl[t - 1][i];
+      tbl[t][i] = (c >> 8) ^ tbl[0][c & 0xffu];
+    }
+  }
+
+  return tbl;
+}
+
+inline constexpr auto CRC32C_TABLES = crc32c_tables();
+
+// Streaming CRC32C, using SSE4.2/ ARMv8 CRC32 instructions, when compiled for
+// targets supporting them, otherwise slicing-by-4 table lookup
+struct crc32c_t
+{
+  explicit crc32c_t(const uint32_t init = 0u)
+    : crc(~init)
+  {
+  }
+
+  inline void update(const uint32_t w)
+  {
+#if defined __SSE4_2__
+    crc = _mm_crc32_u32(crc, w);
+#elif defined __ARM_FEATURE_CRC32
+    crc = __crc32cw(crc, w);
+#else
+    const uint32_t c = crc ^ w;
+    crc = CRC32C_TABLES[3][c & 0xffu] ^ CRC32C_TABLES[2][(c >> 8) & 0xffu] ^
+          CRC32C_TABLES[1][(c >> 16) & 0xffu] ^ CRC32C_TABLES[0][c >> 24];
+#endif
+  }
+
+  inline void update(const uint8_t b)
+  {
+#if defined __SSE4_2__
+    crc = _mm_crc32_u8(crc, b);
+#elif defined __ARM_FEATURE_CRC32
+    crc = __crc32cb(crc, b);
+#else
+    crc = (crc >> 8) ^ CRC32C_TABLES[0][(crc ^ b) & 0xffu];
+#endif
+  }
+
+  inline void update(const uint8_t* const bytes, const size_t blen)
+  {
+    const size_t word_cnt = blen >> 2;
+
+    for (size_t i = 0; i < word_cnt; i++) {
+      const size_t off = i << 2;
+      update(load_le(bytes + off));
+    }
+
+    for (size_t i = word_cnt << 2; i < blen; i++) {
+      update(bytes[i]);
+    }
+  }
+
+  inline uint32_t digest() const { return ~crc; }
+
+private:
+  static inline uint32_t load_le(const uint8_t* const bytes)
+  {
+    return static_cast<uint32_t>(bytes[0]) |
+           (static_cast<uint32_t>(bytes[1]) << 8) |
+           (static_cast<uint32_t>(bytes[2]) << 16) |
+           (static_cast<uint32_t>(bytes[3]) << 24);
+  }
+
+  uint32_t crc;
+};
+
+// Streaming xxHash32, see
+// https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+struct xxh32_t
+{
+  explicit xxh32_t(const uint32_t seed = 0u)
+    : seed(seed)
+  {
+    acc[0] = seed + P1 + P2;
+    acc[1] = seed + P2;
+    acc[2] = seed;
+    acc[3] = seed - P1;
+  }
+
+  inline void update(const uint32_t w)
+  {
+    if ((fill & 3ul) != 0) {
+      for (size_t i = 0; i < 4; i++) {
+        update(static_cast<uint8_t>(w >> (i << 3)));
+      }
+      return;
+    }
+
+    lanes[fill >> 2] = w;
+    fill += 4;
+    total += 4;
+
+    if (fill == 16) {
+      stripe();
+    }
+  }
+
+  inline void update(const uint8_t b)
+  {
+    const size_t sh = (fill & 3ul) << 3;
+    const uint32_t lane = (fill & 3ul) == 0 ? 0u : lanes[fill >> 2];
+
+    lanes[fill >> 2] = lane | (static_cast<uint32_t>(b) << sh);
+    fill += 1;
+    total += 1;
+
+    if (fill == 16) {
+      stripe();
+    }
+  }
+
+  inline void update(const uint8_t* const bytes, const size_t blen)
+  {
+    for (size_t i = 0; i < blen; i++) {
+      update(bytes[i]);
+    }
+  }
+
+  inline uint32_t digest() const
+  {
+    uint32_t h = 0u;
+
+    if (total >= 16) {
+      h = std::rotl(acc[0], 1) + std::rotl(acc[1], 7) + std::rotl(acc[2], 12) +
+          std::rotl(acc[3], 18);
+    } else {
+      h = seed + P5;
+    }
+
+    h += static_cast<uint32_t>(total);
+
+    for (size_t i = 0; i < (fill >> 2); i++) {
+      h = std::rotl(h + lanes[i] * P3, 17) * P4;
+    }
+
+    for (size_t i = fill & ~3ul; i < fill; i++) {
+      const uint32_t b = (lanes[i >> 2] >> ((i & 3ul) << 3)) & 0xffu;
+      h = std::rotl(h + b * P5, 11) * P1;
+    }
+
+    h ^= h >> 15;
+    h *= P2;
+    h ^= h >> 13;
+    h *= P3;
+    h ^= h >> 16;
+
+    return h;
+  }
+
+private:
+  static constexpr uint32_t P1 = 0x9e3779b1u;
+  static constexpr uint32_t P2 = 0x85ebca77u;
+  static constexpr uint32_t P3 = 0xc2b2ae3du;
+  static constexpr uint32_t P4 = 0x27d4eb2fu;
+  static constexpr uint32_t P5 = 0x165667b1u;
+
+  // Consumes buffered 16 -bytes stripe
+  inline void stripe()
+  {
+    for (size_t i = 0; i < 4; i++) {
+      acc[i] = std::rotl(acc[i] + lanes[i] * P2, 13) * P1;
+    }
+    fill = 0;
+  }
+
+  uint32_t seed;
+  uint32_t acc[4];
+  uint32_t lanes[4]{};
+  size_t fill = 0;
+  uint64_t total = 0;
+};
+
+}
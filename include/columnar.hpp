@@ -0,0 +1,401 @@
+#pragma once
+#include "grain_128aead.hpp"
+#include "worker_pool.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Columnar container of encrypted row batches, where each column buffer of each
+// row batch is sealed independently, so that readers decrypt and verify only
+// projected columns ( in parallel across columns and batches ), making
+// decryption cost follow query's column footprint, instead of row width.
+namespace columnar {
+
+// Container layout ( all integers little endian )
+//
+// - header    : "GCOL" | version (1B) | reserved (1B) | column count C (2B) |
+//               batch count B (4B) | 96 -bit file nonce
+// - schema    : C * { type (1B) | name length L (1B) | name (L B) }
+// - directory : B * { row count (4B) | C * { offset (8B) | length (8B) |
+//               tag (8B) } }
+// - data      : sealed column buffers, offsets being relative to start of data
+//
+// Column c of batch b is sealed with nonce derived from file nonce and
+// `(b << 16) | c` ( see `grain_128aead::derive_nonce` ), while associated data
+// is encoded schema entry of column c, followed by c (2B) and row count of
+// batch (4B), so that columns can't be swapped, reinterpreted under some other
+// schema or moved across batches of different size.
+constexpr uint8_t MAGIC[4]{ 'G', 'C', 'O', 'L' };
+constexpr uint8_t VERSION = 1;
+constexpr size_t HDR_LEN = 4 + 1 + 1 + 2 + 4 + 12;
+constexpr size_t ENTRY_LEN = 8 + 8 + 8;
+
+// Batch count is a 4 -bytes header field
+constexpr uint32_t MAX_BATCHES = 0xffffffffu;
+
+// Alignment of column buffers, handed out by `alloc_column`
+constexpr size_t ALIGN = 64;
+
+// Schema entry of a column; type is opaque to container, it's only bound into
+// associated data
+struct column_t
+{
+  std::string name;
+  uint8_t type = 0;
+};
+
+// Allocates buffer for decrypting a column into, aligned to `ALIGN` -bytes;
+// release it using `std::free`
+inline static uint8_t*
+alloc_column(const size_t len)
+{
+  const size_t alen = (std::max<size_t>(len, 1) + ALIGN - 1) & ~(ALIGN - 1);
+  return static_cast<uint8_t*>(std::aligned_alloc(ALIGN, alen));
+}
+
+template<typename T>
+inline static void
+put_le(std::vector<uint8_t>& buf, const T v)
+{
+  for (size_t i = 0; i < sizeof(T); i++) {
+    buf.push_back(static_cast<uint8_t>(static_cast<uint64_t>(v) >> (i << 3)));
+  }
+}
+
+template<typename T>
+inline static T
+get_le(const uint8_t* const bytes)
+{
+  uint64_t v = 0;
+  for (size_t i = 0; i < sizeof(T); i++) {
+    v |= static_cast<uint64_t>(bytes[i]) << (i << 3);
+  }
+  return static_cast<T>(v);
+}
+
+// Associated data of given column, for a batch of given row count
+inline static std::vector<uint8_t>
+column_ad(const column_t& col, const uint16_t cidx, const uint32_t rows)
+{
+  std::vector<uint8_t> ad;
+  ad.reserve(2 + col.name.size() + 2 + 4);
+
+  ad.push_back(col.type);
+  ad.push_back(static_cast<uint8_t>(col.name.size()));
+  ad.insert(ad.end(), col.name.begin(), col.name.end());
+  put_le<uint16_t>(ad, cidx);
+  put_le<uint32_t>(ad, rows);
+
+  return ad;
+}
+
+// Nonce of column c of batch b
+inline static void
+column_nonce(const uint8_t* const __restrict fnonce,
+             const uint32_t batch,
+             const uint16_t cidx,
+             uint8_t* const __restrict nonce)
+{
+  const uint64_t ctr = (static_cast<uint64_t>(batch) << 16) | cidx;
+  grain_128aead::derive_nonce(fnonce, ctr, nonce);
+}
+
+// Builds container, one row batch at a time
+struct writer_t
+{
+  // Schema can have at most 2^16 - 1 columns, each with name of at most 255
+  // -bytes; see `valid` for checking that
+  writer_t(const uint8_t* const __restrict key,   // 128 -bit secret key
+           const uint8_t* const __restrict nonce, // 96 -bit file nonce
+           std::vector<column_t> schema           // column schema
+           )
+    : schema(std::move(schema))
+  {
+    std::memcpy(skey, key, 16);
+    std::memcpy(fnonce, nonce, 12);
+  }
+
+  ~writer_t() { std::memset(skey, 0, sizeof(skey)); }
+
+  // Whether schema can be represented in container
+  bool valid() const
+  {
+    if (schema.size() > 0xffff) {
+      return false;
+    }
+    for (const auto& c : schema) {
+      if (c.name.size() > 0xff) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Seals one row batch, given as one buffer per column ( in schema order ).
+  // Returns false if container can't take any more batches.
+  bool add_batch(const uint32_t rows,                // row count of batch
+                 const uint8_t* const* const cols,   // column buffers
+                 const size_t* const lens            // their byte lengths
+  )
+  {
+    if (!valid() || batches == MAX_BATCHES) {
+      return false;
+    }
+
+    const uint32_t bidx = batches++;
+    put_le<uint32_t>(dir, rows);
+
+    for (size_t c = 0; c < schema.size(); c++) {
+      const uint16_t cidx = static_cast<uint16_t>(c);
+      const auto ad = column_ad(schema[c], cidx, rows);
+
+      uint8_t nonce[12];
+      column_nonce(fnonce, bidx, cidx, nonce);
+
+      const size_t off = data.size();
+      data.resize(off + lens[c]);
+
+      uint8_t tag[8];
+      grain_128aead::encrypt(skey,
+                             nonce,
+                             ad.data(),
+                             ad.size(),
+                             cols[c],
+                             data.data() + off,
+                             lens[c],
+                             tag);
+
+      put_le<uint64_t>(dir, off);
+      put_le<uint64_t>(dir, lens[c]);
+      dir.insert(dir.end(), tag, tag + 8);
+    }
+
+    return true;
+  }
+
+  // Serializes container
+  std::vector<uint8_t> finish() const
+  {
+    std::vector<uint8_t> head;
+
+    head.insert(head.end(), MAGIC, MAGIC + 4);
+    head.push_back(VERSION);
+    head.push_back(0);
+    put_le<uint16_t>(head, static_cast<uint16_t>(schema.size()));
+    put_le<uint32_t>(head, batches);
+    head.insert(head.end(), fnonce, fnonce + 12);
+
+    for (const auto& c : schema) {
+      head.push_back(c.type);
+      head.push_back(static_cast<uint8_t>(c.name.size()));
+      head.insert(head.end(), c.name.begin(), c.name.end());
+    }
+
+    // sized once up front, as directory & data can be large
+    std::vector<uint8_t> buf(head.size() + dir.size() + data.size());
+    uint8_t* const out = buf.data();
+
+    std::memcpy(out, head.data(), head.size());
+    if (!dir.empty()) {
+      std::memcpy(out + head.size(), dir.data(), dir.size());
+    }
+    if (!data.empty()) {
+      std::memcpy(out + head.size() + dir.size(), data.data(), data.size());
+    }
+
+    return buf;
+  }
+
+private:
+  uint8_t skey[16]{};
+  uint8_t fnonce[12]{};
+  std::vector<column_t> schema;
+  uint32_t batches = 0;
+  std::vector<uint8_t> dir;
+  std::vector<uint8_t> data;
+};
+
+// Reads container, which is kept in memory ( say mmap-ed file ) by caller, for
+// whole lifetime of reader; nothing is copied out of it, except decrypted
+// columns, which go straight into caller provided buffers.
+struct reader_t
+{
+  // Parses header, schema & directory, checking that all column buffers lie
+  // inside container. Returns false for malformed containers. Note, nothing is
+  // authenticated at this point.
+  bool open(const uint8_t* const buf, const size_t len)
+  {
+    if (len < HDR_LEN || std::memcmp(buf, MAGIC, 4) != 0 ||
+        buf[4] != VERSION) {
+      return false;
+    }
+
+    ncols = get_le<uint16_t>(buf + 6);
+    nbatches = get_le<uint32_t>(buf + 8);
+    std::memcpy(fnonce, buf + 12, 12);
+
+    size_t off = HDR_LEN;
+    schema.clear();
+
+    for (size_t c = 0; c < ncols; c++) {
+      if (off + 2 > len || off + 2 + buf[off + 1] > len) {
+        return false;
+      }
+
+      column_t col;
+      col.type = buf[off];
+      col.name.assign(reinterpret_cast<const char*>(buf + off + 2),
+                      buf[off + 1]);
+      schema.push_back(std::move(col));
+
+      off += 2 + buf[off + 1];
+    }
+
+    const size_t bentry = 4 + ncols * ENTRY_LEN;
+    if ((len - off) / bentry < nbatches) {
+      return false;
+    }
+
+    dir = buf + off;
+    data = dir + nbatches * bentry;
+    dlen = len - (off + nbatches * bentry);
+
+    for (uint32_t b = 0; b < nbatches; b++) {
+      for (uint16_t c = 0; c < ncols; c++) {
+        const uint64_t coff = column_off(b, c);
+        const uint64_t clen = column_len(b, c);
+
+        if (coff > dlen || clen > dlen - coff) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  size_t columns() const { return ncols; }
+  size_t batches() const { return nbatches; }
+  const std::vector<column_t>& columns_schema() const { return schema; }
+
+  // Index of column with given name, or -1 if there's no such column
+  long column_index(const std::string& name) const
+  {
+    for (size_t c = 0; c < schema.size(); c++) {
+      if (schema[c].name == name) {
+        return static_cast<long>(c);
+      }
+    }
+    return -1;
+  }
+
+  // Row count of given batch
+  uint32_t rows(const uint32_t batch) const
+  {
+    return get_le<uint32_t>(entry(batch));
+  }
+
+  // Byte length of given column of given batch
+  size_t column_len(const uint32_t batch, const uint16_t cidx) const
+  {
+    return get_le<uint64_t>(entry(batch) + 4 + cidx * ENTRY_LEN + 8);
+  }
+
+  // Decrypts and verifies one column of one batch into `out`, which must have
+  // room for `column_len(batch, cidx)` -bytes; on failure, `out` is zeroed
+  bool read_column(const uint8_t* const __restrict key,
+                   const uint32_t batch,
+                   const uint16_t cidx,
+                   uint8_t* const __restrict out) const
+  {
+    const uint8_t* const ent = entry(batch) + 4 + cidx * ENTRY_LEN;
+    const auto ad = column_ad(schema[cidx], cidx, rows(batch));
+
+    uint8_t nonce[12];
+    column_nonce(fnonce, batch, cidx, nonce);
+
+    return grain_128aead::decrypt(key,
+                                  nonce,
+                                  ent + 16,
+                                  ad.data(),
+                                  ad.size(),
+                                  data + column_off(batch, cidx),
+                                  out,
+                                  column_len(batch, cidx));
+  }
+
+  // Decrypts and verifies projected columns `cidx[0..nc)` of selected batches
+  // `batch[0..nb)`, where column cidx[j] of batch batch[i] goes to
+  // `out[i * nc + j]`. With a worker pool, all ( batch, column ) pairs are
+  // processed in parallel, otherwise one after another on calling thread.
+  //
+  // Returns true only if all of them are authentic; failed ones are zeroed.
+  bool read(const uint8_t* const __restrict key,
+            const uint32_t* const batch,
+            const size_t nb,
+            const uint16_t* const cidx,
+            const size_t nc,
+            uint8_t* const* const out,
+            worker_pool::pool_t* const pool = nullptr) const
+  {
+    for (size_t i = 0; i < nb; i++) {
+      if (batch[i] >= nbatches) {
+        return false;
+      }
+    }
+    for (size_t j = 0; j < nc; j++) {
+      if (cidx[j] >= ncols) {
+        return false;
+      }
+    }
+
+    if (pool == nullptr) {
+      bool ok = true;
+      for (size_t i = 0; i < nb; i++) {
+        for (size_t j = 0; j < nc; j++) {
+          ok &= read_column(key, batch[i], cidx[j], out[i * nc + j]);
+        }
+      }
+      return ok;
+    }
+
+    std::atomic<bool> ok{ true };
+    std::vector<worker_pool::job_t> jobs;
+    jobs.reserve(nb * nc);
+
+    for (size_t i = 0; i < nb; i++) {
+      for (size_t j = 0; j < nc; j++) {
+        jobs.emplace_back([&, i, j] {
+          if (!read_column(key, batch[i], cidx[j], out[i * nc + j])) {
+            ok.store(false, std::memory_order_relaxed);
+          }
+        });
+      }
+    }
+
+    pool->run_batch(std::move(jobs));
+    return ok.load(std::memory_order_relaxed);
+  }
+
+private:
+  const uint8_t* entry(const uint32_t batch) const
+  {
+    return dir + batch * (4 + ncols * ENTRY_LEN);
+  }
+
+  uint64_t column_off(const uint32_t batch, const uint16_t cidx) const
+  {
+    return get_le<uint64_t>(entry(batch) + 4 + cidx * ENTRY_LEN);
+  }
+
+  uint16_t ncols = 0;
+  uint32_t nbatches = 0;
+  uint8_t fnonce[12]{};
+  std::vector<column_t> schema;
+
+  const uint8_t* dir = nullptr;
+  const uint8_t* data = nullptr;
+  size_t dlen = 0;
+};
+
+}
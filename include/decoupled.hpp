@@ -0,0 +1,281 @@
+#pragma once
+#include "aead.hpp"
+#include "kernels.hpp"
+#include "lfsr_stream.hpp"
+
+// Grain-128 AEAD, where post-initialization LFSR word sequence is generated in
+// bulk ( see `lfsr_stream` ), decoupled from NFSR, output and authentication
+// computation, so that serial dependency chain, when processing plain/ cipher
+// text, only consists of NFSR recurrence and output function.
+namespace decoupled {
+
+// Pre-output generator function, producing 32 key stream bits, working on NFSR
+// words and a window of four LFSR words, taken from bulk generated LFSR word
+// sequence ( generated kernel, see `kernels::ksbx32` )
+inline static uint32_t
+ksbx32(const uint32_t* const __restrict nfsr, // 4 NFSR words
+       const uint32_t* const __restrict lfsr  // 4 LFSR words
+)
+{
+  return kernels::ksbx32(nfsr, lfsr);
+}
+
+// Nonlinear feedback F(Bt) of NFSR, computing 32 bits, to be XOR-ed with LFSR
+// word s0, for getting next NFSR word ( generated kernel, see
+// `kernels::fbx32` )
+inline static uint32_t
+fbx32(const uint32_t* const nfsr)
+{
+  return kernels::fbx32(nfsr);
+}
+
+// Same as `grain_128::authenticate<uint32_t>`, while keeping accumulator and
+// shift register in registers
+inline static void
+authenticate(uint64_t& acc,       // 64 -bit accumulator
+             uint64_t& sreg,      // 64 -bit shift register
+             const uint32_t msg,  // 32 input message bits
+             const uint32_t ksb   // 32 odd pre-output generator bits
+)
+{
+  for (size_t i = 0; i < 32; i++) {
+    const bool m = static_cast<bool>((msg >> i) & 0b1);
+    const uint64_t k = (ksb >> i) & 0b1;
+
+    acc = acc ^ (m * sreg);
+    sreg = (sreg >> 1) | (k << 63);
+  }
+}
+
+// Loads 4 words of a 128 -bit register, kept as little endian byte array
+inline static void
+load_words(const uint8_t* const reg, uint32_t* const words)
+{
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(words, reg, 16);
+  } else {
+    for (size_t i = 0; i < 4; i++) {
+      words[i] = grain_128::from_le_bytes<uint32_t>(reg + (i << 2));
+    }
+  }
+}
+
+// Stores 4 words of a 128 -bit register, as little endian byte array
+inline static void
+store_words(const uint32_t* const words, uint8_t* const reg)
+{
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(reg, words, 16);
+  } else {
+    for (size_t i = 0; i < 4; i++) {
+      grain_128::to_le_bytes<uint32_t>(words[i], reg + (i << 2));
+    }
+  }
+}
+
+// Encrypts ( when `encrypt` is true ) or decrypts 32 -bit words of text, while
+// authenticating plain text, consuming LFSR words generated in bulk by
+// `lfsr_stream::generator_t<lanes, seg>`; remaining ( < 4 ) bytes are
+// processed by regular 8 -bit path of `aead`. Produces same result as
+// `aead::{enc,dec}_and_auth_txt`.
+template<const bool encrypt, const size_t lanes, const size_t seg>
+static void
+process_txt(grain_128::state_t* const __restrict st,
+            const uint8_t* const __restrict in,
+            uint8_t* const __restrict out,
+            const size_t ctlen)
+{
+  using generator_t = lfsr_stream::generator_t<lanes, seg>;
+  constexpr size_t block = generator_t::block;
+
+  const size_t word_cnt = ctlen >> 2;
+  const size_t rm_bytes = ctlen & 3ul;
+
+  if (word_cnt == 0) {
+    if constexpr (encrypt) {
+      aead::enc_and_auth_txt(st, in, out, rm_bytes);
+    } else {
+      aead::dec_and_auth_txt(st, in, out, rm_bytes);
+    }
+
+    return;
+  }
+
+  uint32_t nfsr[4];
+  uint32_t lfsr[4];
+
+  load_words(st->nfsr, nfsr);
+  load_words(st->lfsr, lfsr);
+
+  uint64_t acc, sreg;
+
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(&acc, st->acc, 8);
+    std::memcpy(&sreg, st->sreg, 8);
+  } else {
+    acc = grain_128::from_le_bytes<uint64_t>(st->acc);
+    sreg = grain_128::from_le_bytes<uint64_t>(st->sreg);
+  }
+
+  generator_t gen(lfsr);
+
+  // LFSR words [pos, avail) are ready to be consumed; 3 extra slots keep
+  // unconsumed tail of previous block, which is required by sliding window
+  alignas(64) uint32_t buf[block + 3];
+  size_t pos = 0;
+  size_t avail = 0;
+
+  // Produces 32 key stream bits, while clocking NFSR by 32 rounds; LFSR is
+  // advanced implicitly, by sliding window over bulk generated words
+  auto clock = [&]() -> uint32_t {
+    if (pos + 4 > avail) {
+      const size_t keep = avail - pos;
+
+      std::memmove(buf, buf + pos, keep * sizeof(uint32_t));
+      gen.fill(buf + keep);
+
+      pos = 0;
+      avail = keep + block;
+    }
+
+    const uint32_t* const win = buf + pos;
+
+    const uint32_t yt = ksbx32(nfsr, win);
+    const uint32_t b96 = win[0] ^ fbx32(nfsr);
+
+    nfsr[0] = nfsr[1];
+    nfsr[1] = nfsr[2];
+    nfsr[2] = nfsr[3];
+    nfsr[3] = b96;
+
+    pos++;
+    return yt;
+  };
+
+  for (size_t i = 0; i < word_cnt; i++) {
+    const size_t off = i << 2;
+
+    const uint32_t yt0 = clock();
+    const uint32_t yt1 = clock();
+
+    const auto splitted = aead::split_bits<uint32_t>(yt0, yt1);
+
+    uint32_t inw = 0u;
+
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(&inw, in + off, 4);
+    } else {
+      inw = grain_128::from_le_bytes<uint32_t>(in + off);
+    }
+
+    const uint32_t outw = inw ^ splitted.first;
+
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(out + off, &outw, 4);
+    } else {
+      grain_128::to_le_bytes<uint32_t>(outw, out + off);
+    }
+
+    authenticate(acc, sreg, encrypt ? inw : outw, splitted.second);
+  }
+
+  // Write back current LFSR window, which is always available, because window
+  // is refilled before being consumed
+  if (pos + 4 > avail) {
+    const size_t keep = avail - pos;
+
+    std::memmove(buf, buf + pos, keep * sizeof(uint32_t));
+    gen.fill(buf + keep);
+
+    pos = 0;
+    avail = keep + block;
+  }
+
+  store_words(nfsr, st->nfsr);
+  store_words(buf + pos, st->lfsr);
+
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(st->acc, &acc, 8);
+    std::memcpy(st->sreg, &sreg, 8);
+  } else {
+    grain_128::to_le_bytes<uint64_t>(acc, st->acc);
+    grain_128::to_le_bytes<uint64_t>(sreg, st->sreg);
+  }
+
+  const size_t off = word_cnt << 2;
+
+  if constexpr (encrypt) {
+    aead::enc_and_auth_txt(st, in + off, out + off, rm_bytes);
+  } else {
+    aead::dec_and_auth_txt(st, in + off, out + off, rm_bytes);
+  }
+}
+
+// Same as `grain_128aead::encrypt`, while using bulk generated LFSR word
+// sequence, with `lanes` -many parallel segments, when processing plain text.
+//
+// LFSR words are generated in blocks of 256 words ( i.e. 512B of text ) when
+// lanes = 1, otherwise in blocks of 4096 words ( i.e. 8KB of text ). Prefer
+// lanes = 1 for short messages, because parallel segments require a GF(2)
+// matrix jump per lane, per generated block.
+template<const size_t lanes = 1>
+static void
+encrypt(const uint8_t* const __restrict key,   // 128 -bit secret key
+        const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+        const uint8_t* const __restrict data,  // N -bytes associated data
+        const size_t dlen,                     // len(data) = N | >= 0
+        const uint8_t* const __restrict txt,   // M -bytes plain text
+        uint8_t* const __restrict enc,         // M -bytes encrypted text
+        const size_t ctlen,                    // len(txt) = len(enc) = M | >= 0
+        uint8_t* const __restrict tag          // 64 -bit authentication tag
+)
+{
+  constexpr size_t seg = lanes == 1 ? 256 : 4096 / lanes;
+
+  grain_128::state_t st;
+
+  aead::initialize(&st, key, nonce);
+  aead::auth_associated_data(&st, data, dlen);
+  process_txt<true, lanes, seg>(&st, txt, enc, ctlen);
+  aead::auth_padding_bit(&st);
+
+  std::memcpy(tag, st.acc, 8);
+}
+
+// Same as `grain_128aead::decrypt`, while using bulk generated LFSR word
+// sequence, with `lanes` -many parallel segments, when processing cipher text.
+//
+// Note, if authentication check fails, no unverified plain text is released
+// i.e. plain text memory allocation is explicitly set to zero bytes.
+template<const size_t lanes = 1>
+static bool
+decrypt(const uint8_t* const __restrict key,   // 128 -bit secret key
+        const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+        const uint8_t* const __restrict tag,   // 64 -bit authentication tag
+        const uint8_t* const __restrict data,  // N -bytes associated data
+        const size_t dlen,                     // len(data) = N | >= 0
+        const uint8_t* const __restrict enc,   // M -bytes encrypted text
+        uint8_t* const __restrict txt,         // M -bytes decrypted text
+        const size_t ctlen                     // len(enc) = len(txt) = M | >= 0
+)
+{
+  constexpr size_t seg = lanes == 1 ? 256 : 4096 / lanes;
+
+  grain_128::state_t st;
+
+  aead::initialize(&st, key, nonce);
+  aead::auth_associated_data(&st, data, dlen);
+  process_txt<false, lanes, seg>(&st, enc, txt, ctlen);
+  aead::auth_padding_bit(&st);
+
+  bool flg = false;
+
+  for (size_t i = 0; i < 8; i++) {
+    flg |= st.acc[i] ^ tag[i];
+  }
+
+  std::memset(txt, 0, ctlen * flg);
+  return !flg;
+}
+
+}
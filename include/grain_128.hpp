@@ -630,4 +630,34 @@ authenticate(state_t* const st, // Grain-128 AEAD cipher state
   }
 }
 
+// Updates only Grain-128 AEAD shift register, when all 8/ 32 input message bits
+// are zero, because zero message bits leave accumulator unchanged; so result is
+// same as calling `authenticate` with `msg = 0`, while avoiding bit-by-bit loop
+//
+// See section 2.3 of Grain-128 AEAD specification
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/grain-128aead-spec-final.pdf
+template<typename T>
+inline static void
+authenticate_zero(state_t* const st, // Grain-128 AEAD cipher state
+                  const T ksb // 8/ 32 odd pre-output generator bits
+                  ) requires(check_auth_bit_width<T>())
+{
+  uint64_t sreg;
+
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(&sreg, st->sreg, 8);
+  } else {
+    sreg = from_le_bytes<uint64_t>(st->sreg);
+  }
+
+  constexpr size_t blen = static_cast<size_t>(std::numeric_limits<T>::digits);
+  sreg = (sreg >> blen) | (static_cast<uint64_t>(ksb) << (64 - blen));
+
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(st->sreg, &sreg, 8);
+  } else {
+    to_le_bytes<uint64_t>(sreg, st->sreg);
+  }
+}
+
 }
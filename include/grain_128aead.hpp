@@ -30,6 +30,8 @@ encrypt(const uint8_t* const __restrict key,   // 128 -bit secret key
         uint8_t* const __restrict tag          // 64 -bit authentication tag
 )
 {
+  GRAIN_USDT2(encrypt_entry, dlen, ctlen);
+
   grain_128::state_t st;
 
   aead::initialize(&st, key, nonce);
@@ -38,6 +40,67 @@ encrypt(const uint8_t* const __restrict key,   // 128 -bit secret key
   aead::auth_padding_bit(&st);
 
   std::memcpy(tag, st.acc, 8);
+
+  GRAIN_USDT2(encrypt_return, dlen, ctlen);
+}
+
+// Variant of `encrypt`, which also absorbs produced cipher text into given
+// non-cryptographic checksum ( say `checksum::crc32c_t` or `checksum::xxh32_t`
+// ), in same pass, so that checksum of cipher text can be obtained without
+// reading cipher text again.
+//
+// Checksum is not reset, so it can be continued across multiple calls ( or over
+// authentication tag, if desired ).
+template<typename S>
+static void
+encrypt_checksum(
+  const uint8_t* const __restrict key,   // 128 -bit secret key
+  const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+  const uint8_t* const __restrict data,  // N -bytes associated data
+  const size_t dlen,                     // len(data) = N | >= 0
+  const uint8_t* const __restrict txt,   // M -bytes plain text
+  uint8_t* const __restrict enc,         // M -bytes encrypted text
+  const size_t ctlen,                    // len(txt) = len(enc) = M | >= 0
+  uint8_t* const __restrict tag,         // 64 -bit authentication tag
+  S& sum                                 // checksum of cipher text
+)
+{
+  grain_128::state_t st;
+
+  aead::initialize(&st, key, nonce);
+  aead::auth_associated_data(&st, data, dlen);
+  aead::enc_and_auth_txt(&st, txt, enc, ctlen, sum);
+  aead::auth_padding_bit(&st);
+
+  std::memcpy(tag, st.acc, 8);
+}
+
+// Sparse-aware variant of `encrypt`, meant for mostly-zero plain text ( say
+// sparse VM images or preallocated files ), which skips plain text loads and
+// accumulator updates for all-zero 4KB pages, while producing bit-identical
+// cipher text and authentication tag.
+//
+// Note, execution time leaks which pages of plain text are all-zero.
+inline static void
+encrypt_sparse(
+  const uint8_t* const __restrict key,   // 128 -bit secret key
+  const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+  const uint8_t* const __restrict data,  // N -bytes associated data
+  const size_t dlen,                     // len(data) = N | >= 0
+  const uint8_t* const __restrict txt,   // M -bytes plain text
+  uint8_t* const __restrict enc,         // M -bytes encrypted text
+  const size_t ctlen,                    // len(txt) = len(enc) = M | >= 0
+  uint8_t* const __restrict tag          // 64 -bit authentication tag
+)
+{
+  grain_128::state_t st;
+
+  aead::initialize(&st, key, nonce);
+  aead::auth_associated_data(&st, data, dlen);
+  aead::enc_and_auth_sparse_txt(&st, txt, enc, ctlen);
+  aead::auth_padding_bit(&st);
+
+  std::memcpy(tag, st.acc, 8);
 }
 
 // Given 16 -bytes secret key, 12 -bytes public message nonce, 8 -bytes
@@ -65,6 +128,8 @@ decrypt(const uint8_t* const __restrict key,   // 128 -bit secret key
         const size_t ctlen                     // len(enc) = len(txt) = M | >= 0
 )
 {
+  GRAIN_USDT2(decrypt_entry, dlen, ctlen);
+
   grain_128::state_t st;
 
   aead::initialize(&st, key, nonce);
@@ -79,7 +144,220 @@ decrypt(const uint8_t* const __restrict key,   // 128 -bit secret key
   }
 
   std::memset(txt, 0, ctlen * flg);
+
+  if (flg) {
+    GRAIN_USDT2(tag_failure, dlen, ctlen);
+  }
+  GRAIN_USDT3(decrypt_return, dlen, ctlen, !flg);
+
+  return !flg;
+}
+
+// Variant of `decrypt`, which also absorbs incoming cipher text into given
+// non-cryptographic checksum, in same pass, so that scrubbing can check stored
+// checksum while decrypting.
+//
+// Note, checksum is updated no matter whether authentication check passes.
+template<typename S>
+static bool
+decrypt_checksum(
+  const uint8_t* const __restrict key,   // 128 -bit secret key
+  const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+  const uint8_t* const __restrict tag,   // 64 -bit authentication tag
+  const uint8_t* const __restrict data,  // N -bytes associated data
+  const size_t dlen,                     // len(data) = N | >= 0
+  const uint8_t* const __restrict enc,   // M -bytes encrypted text
+  uint8_t* const __restrict txt,         // M -bytes decrypted text
+  const size_t ctlen,                    // len(enc) = len(txt) = M | >= 0
+  S& sum                                 // checksum of cipher text
+)
+{
+  grain_128::state_t st;
+
+  aead::initialize(&st, key, nonce);
+  aead::auth_associated_data(&st, data, dlen);
+  aead::dec_and_auth_txt(&st, enc, txt, ctlen, sum);
+  aead::auth_padding_bit(&st);
+
+  bool flg = false;
+
+  for (size_t i = 0; i < 8; i++) {
+    flg |= st.acc[i] ^ tag[i];
+  }
+
+  std::memset(txt, 0, ctlen * flg);
+
+  if (flg) {
+    GRAIN_USDT2(tag_failure, dlen, ctlen);
+  }
+  return !flg;
+}
+
+// Given 16 -bytes secret key, 12 -bytes public message nonce, old & new N
+// -bytes associated data and 8 -bytes authentication tag computed ( by
+// `encrypt` ) over old associated data & some M -bytes plain text, this routine
+// computes authentication tag for same cipher text under new associated data,
+// without touching cipher text at all.
+//
+// Key stream only depends on key, nonce & clock count, so for same length
+// associated data, cipher text stays same and tag changes by XOR of
+// authenticator contributions of flipped associated data bits; cipher is only
+// clocked till end of associated data, so cost is independent of M.
+//
+// Note, only associated data of same length can be changed this way, there's
+// intentionally no way to change plain text, because that'd mean encrypting
+// different plain text under same nonce. Also old tag is not verified, so make
+// sure it's authentic before re-tagging.
+//
+// Old & new tag may point to same buffer, for re-tagging in-place.
+inline static void
+retag(const uint8_t* const __restrict key,      // 128 -bit secret key
+      const uint8_t* const __restrict nonce,    // 96 -bit public message nonce
+      const uint8_t* const __restrict old_data, // N -bytes old associated data
+      const uint8_t* const __restrict new_data, // N -bytes new associated data
+      const size_t dlen,                        // len(data) = N | >= 0
+      const uint8_t* const old_tag,             // 64 -bit old tag
+      uint8_t* const new_tag                    // 64 -bit new tag
+)
+{
+  grain_128::state_t st;
+
+  aead::initialize(&st, key, nonce);
+  aead::auth_associated_data_delta(&st, old_data, new_data, dlen);
+
+  for (size_t i = 0; i < 8; i++) {
+    new_tag[i] = old_tag[i] ^ st.acc[i];
+  }
+}
+
+// Given M -bytes cipher text & 8 -bytes authentication tag, produced ( by
+// `encrypt` ) under old secret key, nonce & associated data, this routine
+// re-encrypts cipher text under new secret key, nonce & associated data,
+// computing new authentication tag, in a single pass over cipher text ( see
+// `aead::reenc_and_auth_txt` ), without ever materializing plain text in
+// memory.
+//
+// Old authentication tag is checked at end; if it doesn't verify, output
+// cipher text & new tag are zeroed and false is returned, so that nothing is
+// released under new key, unless it was authentic under old one.
+//
+// Avoid reusing new nonce under new secret key, same as for `encrypt`.
+inline static bool
+reseal(const uint8_t* const __restrict old_key,   // 128 -bit old secret key
+       const uint8_t* const __restrict old_nonce, // 96 -bit old nonce
+       const uint8_t* const __restrict old_tag,   // 64 -bit old tag
+       const uint8_t* const __restrict old_data,  // N -bytes old assoc. data
+       const size_t old_dlen,                     // len(old_data) = N | >= 0
+       const uint8_t* const __restrict new_key,   // 128 -bit new secret key
+       const uint8_t* const __restrict new_nonce, // 96 -bit new nonce
+       const uint8_t* const __restrict new_data,  // K -bytes new assoc. data
+       const size_t new_dlen,                     // len(new_data) = K | >= 0
+       const uint8_t* const __restrict enc,       // M -bytes old cipher text
+       uint8_t* const __restrict out,             // M -bytes new cipher text
+       const size_t ctlen,                        // len(enc) = M | >= 0
+       uint8_t* const __restrict new_tag          // 64 -bit new tag
+)
+{
+  grain_128::state_t sto, stn;
+
+  aead::initialize(&sto, old_key, old_nonce);
+  aead::initialize(&stn, new_key, new_nonce);
+  aead::auth_associated_data(&sto, old_data, old_dlen);
+  aead::auth_associated_data(&stn, new_data, new_dlen);
+  aead::reenc_and_auth_txt(&sto, &stn, enc, out, ctlen);
+  aead::auth_padding_bit(&sto);
+  aead::auth_padding_bit(&stn);
+
+  bool flg = false;
+
+  for (size_t i = 0; i < 8; i++) {
+    flg |= sto.acc[i] ^ old_tag[i];
+  }
+
+  std::memset(out, 0, ctlen * flg);
+
+  for (size_t i = 0; i < 8; i++) {
+    new_tag[i] = stn.acc[i] * !flg;
+  }
+
+  if (flg) {
+    GRAIN_USDT2(tag_failure, old_dlen, ctlen);
+  }
   return !flg;
 }
 
+// Derives a per-item 96 -bit nonce from base nonce and 64 -bit counter ( say
+// page, chunk or record index ), as first 4 -bytes of base nonce, followed by 8
+// -bytes little endian counter. Base and counter occupy disjoint fields, so
+// distinct ( base, counter ) pairs always yield distinct nonces, as long as
+// bases differ in their first 4 -bytes; last 8 -bytes of base are ignored.
+//
+// Note, base nonce itself must never be reused under same secret key, for
+// deriving nonces of another sequence of items.
+inline static void
+derive_nonce(const uint8_t* const __restrict base, // 96 -bit base nonce
+             const uint64_t ctr,                   // item index
+             uint8_t* const __restrict nonce       // 96 -bit derived nonce
+)
+{
+  std::memcpy(nonce, base, 4);
+
+  for (size_t i = 0; i < 8; i++) {
+    nonce[4 + i] = static_cast<uint8_t>(ctr >> (i << 3));
+  }
+}
+
+// Primes a freshly started ( or long idle ) process for upcoming calls, so that
+// first real `encrypt`/ `decrypt` calls don't pay for cold instruction cache,
+// untrained branch predictors & unmapped pages.
+//
+// It encrypts & decrypts a few short messages under a fixed key, whose lengths
+// exercise both 32 -bit word and byte tail kernels, along with failing
+// authentication path, `rounds` times. If a buffer is given ( say, output
+// buffer of first real call ), each of its 4KB pages is written once, faulting
+// them in, while preserving contents.
+//
+// Note, it can't help with lazily bound PLT entries of caller, when calling
+// through shared library ( link with `-Wl,-z,now` or set `LD_BIND_NOW` ).
+inline static void
+warm_up(const size_t rounds = 2,                // number of passes | > 0
+        uint8_t* const __restrict buf = nullptr, // B -bytes buffer to pre-fault
+        const size_t blen = 0                    // len(buf) = B | >= 0
+)
+{
+  constexpr size_t lens[]{ 0, 3, 16, 67 };
+
+  uint8_t key[16], nonce[12], tag[8];
+  uint8_t data[67], txt[67], enc[67], dec[67];
+
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = static_cast<uint8_t>(i);
+    txt[i] = static_cast<uint8_t>(~i);
+  }
+  std::memcpy(key, data, sizeof(key));
+  std::memcpy(nonce, txt, sizeof(nonce));
+
+  volatile uint8_t sink = 0;
+
+  for (size_t r = 0; r < rounds; r++) {
+    for (const size_t len : lens) {
+      encrypt(key, nonce, data, len, txt, enc, len, tag);
+      sink = sink ^ tag[0] ^ decrypt(key, nonce, tag, data, len, enc, dec, len);
+
+      tag[0] ^= 1;
+      sink = sink ^ decrypt(key, nonce, tag, data, len, enc, dec, len);
+    }
+  }
+
+  constexpr size_t page = 4096ul;
+  volatile uint8_t* const vbuf = buf;
+
+  for (size_t off = 0; off < blen; off += page) {
+    vbuf[off] = vbuf[off];
+  }
+  if (blen > 0) {
+    vbuf[blen - 1] = vbuf[blen - 1];
+  }
+}
+
 }
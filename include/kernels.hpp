@@ -0,0 +1,925 @@
+#pragma once
+#include <cstdint>
+
+// Bit-parallel Grain-128 AEAD kernels, generated by `tools/gen_kernels.py`
+// from tap specifications; don't edit by hand, regenerate using `make kernels`
+//
+// Kernels computing W consecutive clocks take 128 -bit registers as arrays of
+// W -bit words ( little endian word order i.e. bit i of register is bit
+// (i mod W) of word (i / W) ) and are templated on word type, so that they can
+// also work on SIMD vectors of W -bit words.
+//
+// Note, W = 64 can't be supported on 128 -bit registers, as some taps ( say
+// s96 of L ) would need bits beyond end of register.
+namespace kernels {
+
+// L(St) --- update function of LFSR, for 8 consecutive clocks
+//
+// naive: 8 shift, 9 xor, 0 and
+// ungrouped: 6 shift, 9 xor, 0 and ( cost 15 )
+// grouped: 6 shift, 9 xor, 0 and ( cost 15 )
+// emitted: ungrouped
+template<typename T = uint8_t>
+inline static T
+lx8(const T* const lfsr)
+{
+  const T lw0 = lfsr[0];
+  const T lw1 = lfsr[1];
+  const T lw4 = lfsr[4];
+  const T lw5 = lfsr[5];
+  const T lw8 = lfsr[8];
+  const T lw9 = lfsr[9];
+  const T lw10 = lfsr[10];
+  const T lw11 = lfsr[11];
+  const T lw12 = lfsr[12];
+  const T t0 = static_cast<T>(lw11 << 7);
+  const T t1 = static_cast<T>(lw5 ^ lw9);
+  const T t2 = static_cast<T>(t1 << 2);
+  const T t3 = static_cast<T>(lw1 << 1);
+  const T t4 = static_cast<T>(lw0 ^ lw12);
+  const T t5 = static_cast<T>(lw10 >> 1);
+  const T t6 = static_cast<T>(lw4 ^ lw8);
+  const T t7 = static_cast<T>(t6 >> 6);
+  const T t8 = static_cast<T>(lw0 >> 7);
+  const T t9 = static_cast<T>(t0 ^ t2);
+  const T t10 = static_cast<T>(t3 ^ t9);
+  const T t11 = static_cast<T>(t4 ^ t10);
+  const T t12 = static_cast<T>(t5 ^ t11);
+  const T t13 = static_cast<T>(t7 ^ t12);
+  const T t14 = static_cast<T>(t8 ^ t13);
+  return t14;
+}
+
+// F(Bt) --- NFSR feedback, excluding s0 term of f, for 8 consecutive clocks
+//
+// naive: 44 shift, 36 xor, 14 and
+// ungrouped: 44 shift, 36 xor, 14 and ( cost 94 )
+// grouped: 36 shift, 32 xor, 18 and ( cost 86 )
+// emitted: grouped
+template<typename T = uint8_t>
+inline static T
+fbx8(const T* const nfsr)
+{
+  const T nw0 = nfsr[0];
+  const T nw8 = nfsr[8];
+  const T nw1 = nfsr[1];
+  const T nw9 = nfsr[9];
+  const T t0 = static_cast<T>(nw0 & nw8);
+  const T t1 = static_cast<T>(t0 >> 3);
+  const T t2 = static_cast<T>(nw1 & nw9);
+  const T t3 = static_cast<T>(t2 << 5);
+  const T t4 = static_cast<T>(t1 ^ t3);
+  const T nw2 = nfsr[2];
+  const T t5 = static_cast<T>(nw1 >> 3);
+  const T t6 = static_cast<T>(nw2 << 5);
+  const T t7 = static_cast<T>(t5 ^ t6);
+  const T t8 = static_cast<T>(nw1 >> 5);
+  const T t9 = static_cast<T>(nw2 << 3);
+  const T t10 = static_cast<T>(t8 ^ t9);
+  const T t11 = static_cast<T>(t7 & t10);
+  const T nw3 = nfsr[3];
+  const T t12 = static_cast<T>(nw2 >> 1);
+  const T t13 = static_cast<T>(nw3 << 7);
+  const T t14 = static_cast<T>(t12 ^ t13);
+  const T t15 = static_cast<T>(nw2 >> 2);
+  const T t16 = static_cast<T>(nw3 << 6);
+  const T t17 = static_cast<T>(t15 ^ t16);
+  const T t18 = static_cast<T>(t14 & t17);
+  const T nw7 = nfsr[7];
+  const T nw4 = nfsr[4];
+  const T t19 = static_cast<T>(nw3 & nw7);
+  const T t20 = static_cast<T>(t19 >> 3);
+  const T t21 = static_cast<T>(nw8 & nw4);
+  const T t22 = static_cast<T>(t21 << 5);
+  const T t23 = static_cast<T>(t20 ^ t22);
+  const T nw5 = nfsr[5];
+  const T nw6 = nfsr[6];
+  const T t24 = static_cast<T>(nw5 & nw6);
+  const T t25 = static_cast<T>(nw8 >> 1);
+  const T t26 = static_cast<T>(nw9 << 7);
+  const T t27 = static_cast<T>(t25 ^ t26);
+  const T t28 = static_cast<T>(nw7 >> 5);
+  const T t29 = static_cast<T>(nw8 << 3);
+  const T t30 = static_cast<T>(t28 ^ t29);
+  const T t31 = static_cast<T>(t27 & t30);
+  const T nw10 = nfsr[10];
+  const T nw11 = nfsr[11];
+  const T t32 = static_cast<T>(nw8 & nw10);
+  const T t33 = static_cast<T>(t32 >> 4);
+  const T t34 = static_cast<T>(nw9 & nw11);
+  const T t35 = static_cast<T>(t34 << 4);
+  const T t36 = static_cast<T>(t33 ^ t35);
+  const T t37 = static_cast<T>(nw3 >> 1);
+  const T t38 = static_cast<T>(nw4 << 7);
+  const T t39 = static_cast<T>(t37 ^ t38);
+  const T t40 = static_cast<T>(nw2 >> 6);
+  const T t41 = static_cast<T>(nw3 << 2);
+  const T t42 = static_cast<T>(t40 ^ t41);
+  const T t43 = static_cast<T>(nw3 & t39);
+  const T t44 = static_cast<T>(t42 & t43);
+  const T t45 = static_cast<T>(nw10 >> 2);
+  const T t46 = static_cast<T>(nw11 << 6);
+  const T t47 = static_cast<T>(t45 ^ t46);
+  const T t48 = static_cast<T>(nw8 & nw9);
+  const T t49 = static_cast<T>(t48 >> 6);
+  const T t50 = static_cast<T>(nw9 & nw10);
+  const T t51 = static_cast<T>(t50 << 2);
+  const T t52 = static_cast<T>(t49 ^ t51);
+  const T t53 = static_cast<T>(t47 & t52);
+  const T nw12 = nfsr[12];
+  const T t54 = static_cast<T>(nw11 >> 4);
+  const T t55 = static_cast<T>(nw12 << 4);
+  const T t56 = static_cast<T>(t54 ^ t55);
+  const T t57 = static_cast<T>(nw11 >> 5);
+  const T t58 = static_cast<T>(nw12 << 3);
+  const T t59 = static_cast<T>(t57 ^ t58);
+  const T t60 = static_cast<T>(nw11 >> 7);
+  const T t61 = static_cast<T>(nw12 << 1);
+  const T t62 = static_cast<T>(t60 ^ t61);
+  const T t63 = static_cast<T>(nw11 & t56);
+  const T t64 = static_cast<T>(t59 & t63);
+  const T t65 = static_cast<T>(t62 & t64);
+  const T t66 = static_cast<T>(nw4 << 6);
+  const T t67 = static_cast<T>(nw12 << 5);
+  const T t68 = static_cast<T>(nw0 ^ nw7);
+  const T t69 = static_cast<T>(nw12 ^ t68);
+  const T t70 = static_cast<T>(nw3 >> 2);
+  const T t71 = static_cast<T>(nw11 >> 3);
+  const T t72 = static_cast<T>(t4 ^ t11);
+  const T t73 = static_cast<T>(t18 ^ t72);
+  const T t74 = static_cast<T>(t23 ^ t73);
+  const T t75 = static_cast<T>(t24 ^ t74);
+  const T t76 = static_cast<T>(t31 ^ t75);
+  const T t77 = static_cast<T>(t36 ^ t76);
+  const T t78 = static_cast<T>(t44 ^ t77);
+  const T t79 = static_cast<T>(t53 ^ t78);
+  const T t80 = static_cast<T>(t65 ^ t79);
+  const T t81 = static_cast<T>(t66 ^ t80);
+  const T t82 = static_cast<T>(t67 ^ t81);
+  const T t83 = static_cast<T>(t69 ^ t82);
+  const T t84 = static_cast<T>(t70 ^ t83);
+  const T t85 = static_cast<T>(t71 ^ t84);
+  return t85;
+}
+
+// h(x) --- boolean function of pre-output generator, for 8 consecutive clocks
+//
+// naive: 20 shift, 14 xor, 6 and
+// ungrouped: 16 shift, 12 xor, 5 and ( cost 33 )
+// grouped: 16 shift, 12 xor, 5 and ( cost 33 )
+// emitted: ungrouped
+template<typename T = uint8_t>
+inline static T
+hx8(const T* const nfsr,
+     const T* const lfsr)
+{
+  const T lw1 = lfsr[1];
+  const T lw11 = lfsr[11];
+  const T lw12 = lfsr[12];
+  const T t0 = static_cast<T>(lw11 >> 6);
+  const T t1 = static_cast<T>(lw12 << 2);
+  const T t2 = static_cast<T>(t0 ^ t1);
+  const T nw11 = nfsr[11];
+  const T nw12 = nfsr[12];
+  const T t3 = static_cast<T>(nw11 >> 7);
+  const T t4 = static_cast<T>(nw12 << 1);
+  const T t5 = static_cast<T>(t3 ^ t4);
+  const T t6 = static_cast<T>(t2 & t5);
+  const T nw1 = nfsr[1];
+  const T nw2 = nfsr[2];
+  const T t7 = static_cast<T>(nw1 >> 4);
+  const T t8 = static_cast<T>(nw2 << 4);
+  const T t9 = static_cast<T>(t7 ^ t8);
+  const T t10 = static_cast<T>(lw1 ^ t6);
+  const T t11 = static_cast<T>(t9 & t10);
+  const T lw2 = lfsr[2];
+  const T lw3 = lfsr[3];
+  const T t12 = static_cast<T>(lw2 >> 4);
+  const T t13 = static_cast<T>(lw3 << 4);
+  const T t14 = static_cast<T>(t12 ^ t13);
+  const T t15 = static_cast<T>(lw1 >> 5);
+  const T t16 = static_cast<T>(lw2 << 3);
+  const T t17 = static_cast<T>(t15 ^ t16);
+  const T t18 = static_cast<T>(t14 & t17);
+  const T lw5 = lfsr[5];
+  const T lw6 = lfsr[6];
+  const T t19 = static_cast<T>(lw5 >> 2);
+  const T t20 = static_cast<T>(lw6 << 6);
+  const T t21 = static_cast<T>(t19 ^ t20);
+  const T t22 = static_cast<T>(t5 & t21);
+  const T lw7 = lfsr[7];
+  const T lw8 = lfsr[8];
+  const T t23 = static_cast<T>(lw7 >> 4);
+  const T t24 = static_cast<T>(lw8 << 4);
+  const T t25 = static_cast<T>(t23 ^ t24);
+  const T lw9 = lfsr[9];
+  const T lw10 = lfsr[10];
+  const T t26 = static_cast<T>(lw9 >> 7);
+  const T t27 = static_cast<T>(lw10 << 1);
+  const T t28 = static_cast<T>(t26 ^ t27);
+  const T t29 = static_cast<T>(t25 & t28);
+  const T t30 = static_cast<T>(t11 ^ t18);
+  const T t31 = static_cast<T>(t22 ^ t30);
+  const T t32 = static_cast<T>(t29 ^ t31);
+  return t32;
+}
+
+// yt --- pre-output generator function, for 8 consecutive clocks
+//
+// naive: 34 shift, 29 xor, 6 and
+// ungrouped: 26 shift, 27 xor, 5 and ( cost 58 )
+// grouped: 26 shift, 27 xor, 5 and ( cost 58 )
+// emitted: ungrouped
+template<typename T = uint8_t>
+inline static T
+ksbx8(const T* const nfsr,
+       const T* const lfsr)
+{
+  const T lw1 = lfsr[1];
+  const T lw11 = lfsr[11];
+  const T lw12 = lfsr[12];
+  const T t0 = static_cast<T>(lw11 >> 6);
+  const T t1 = static_cast<T>(lw12 << 2);
+  const T t2 = static_cast<T>(t0 ^ t1);
+  const T nw11 = nfsr[11];
+  const T nw12 = nfsr[12];
+  const T t3 = static_cast<T>(nw11 >> 7);
+  const T t4 = static_cast<T>(nw12 << 1);
+  const T t5 = static_cast<T>(t3 ^ t4);
+  const T t6 = static_cast<T>(t2 & t5);
+  const T nw1 = nfsr[1];
+  const T nw2 = nfsr[2];
+  const T t7 = static_cast<T>(nw1 >> 4);
+  const T t8 = static_cast<T>(nw2 << 4);
+  const T t9 = static_cast<T>(t7 ^ t8);
+  const T t10 = static_cast<T>(lw1 ^ t6);
+  const T t11 = static_cast<T>(t9 & t10);
+  const T lw2 = lfsr[2];
+  const T lw3 = lfsr[3];
+  const T t12 = static_cast<T>(lw2 >> 4);
+  const T t13 = static_cast<T>(lw3 << 4);
+  const T t14 = static_cast<T>(t12 ^ t13);
+  const T t15 = static_cast<T>(lw1 >> 5);
+  const T t16 = static_cast<T>(lw2 << 3);
+  const T t17 = static_cast<T>(t15 ^ t16);
+  const T t18 = static_cast<T>(t14 & t17);
+  const T lw5 = lfsr[5];
+  const T lw6 = lfsr[6];
+  const T t19 = static_cast<T>(lw5 >> 2);
+  const T t20 = static_cast<T>(lw6 << 6);
+  const T t21 = static_cast<T>(t19 ^ t20);
+  const T t22 = static_cast<T>(t5 & t21);
+  const T lw7 = lfsr[7];
+  const T lw8 = lfsr[8];
+  const T t23 = static_cast<T>(lw7 >> 4);
+  const T t24 = static_cast<T>(lw8 << 4);
+  const T t25 = static_cast<T>(t23 ^ t24);
+  const T lw9 = lfsr[9];
+  const T lw10 = lfsr[10];
+  const T t26 = static_cast<T>(lw9 >> 7);
+  const T t27 = static_cast<T>(lw10 << 1);
+  const T t28 = static_cast<T>(t26 ^ t27);
+  const T t29 = static_cast<T>(t25 & t28);
+  const T nw0 = nfsr[0];
+  const T nw4 = nfsr[4];
+  const T nw5 = nfsr[5];
+  const T nw6 = nfsr[6];
+  const T nw8 = nfsr[8];
+  const T nw9 = nfsr[9];
+  const T nw10 = nfsr[10];
+  const T t30 = static_cast<T>(nw12 ^ nw10);
+  const T t31 = static_cast<T>(t30 << 7);
+  const T t32 = static_cast<T>(nw1 << 6);
+  const T t33 = static_cast<T>(nw5 << 4);
+  const T t34 = static_cast<T>(lw12 ^ nw6);
+  const T t35 = static_cast<T>(t34 << 3);
+  const T t36 = static_cast<T>(nw2 << 1);
+  const T t37 = static_cast<T>(nw11 ^ nw9);
+  const T t38 = static_cast<T>(t37 >> 1);
+  const T t39 = static_cast<T>(nw0 >> 2);
+  const T t40 = static_cast<T>(nw4 >> 4);
+  const T t41 = static_cast<T>(lw11 ^ nw5);
+  const T t42 = static_cast<T>(t41 >> 5);
+  const T t43 = static_cast<T>(nw1 >> 7);
+  const T t44 = static_cast<T>(t11 ^ t18);
+  const T t45 = static_cast<T>(t22 ^ t44);
+  const T t46 = static_cast<T>(t29 ^ t45);
+  const T t47 = static_cast<T>(nw8 ^ t46);
+  const T t48 = static_cast<T>(t31 ^ t47);
+  const T t49 = static_cast<T>(t32 ^ t48);
+  const T t50 = static_cast<T>(t33 ^ t49);
+  const T t51 = static_cast<T>(t35 ^ t50);
+  const T t52 = static_cast<T>(t36 ^ t51);
+  const T t53 = static_cast<T>(t38 ^ t52);
+  const T t54 = static_cast<T>(t39 ^ t53);
+  const T t55 = static_cast<T>(t40 ^ t54);
+  const T t56 = static_cast<T>(t42 ^ t55);
+  const T t57 = static_cast<T>(t43 ^ t56);
+  return t57;
+}
+
+// L(St) --- update function of LFSR, for 16 consecutive clocks
+//
+// naive: 8 shift, 9 xor, 0 and
+// ungrouped: 6 shift, 9 xor, 0 and ( cost 15 )
+// grouped: 6 shift, 9 xor, 0 and ( cost 15 )
+// emitted: ungrouped
+template<typename T = uint16_t>
+inline static T
+lx16(const T* const lfsr)
+{
+  const T lw0 = lfsr[0];
+  const T lw1 = lfsr[1];
+  const T lw2 = lfsr[2];
+  const T lw3 = lfsr[3];
+  const T lw4 = lfsr[4];
+  const T lw5 = lfsr[5];
+  const T lw6 = lfsr[6];
+  const T t0 = static_cast<T>(lw6 << 15);
+  const T t1 = static_cast<T>(lw3 ^ lw5);
+  const T t2 = static_cast<T>(t1 << 10);
+  const T t3 = static_cast<T>(lw1 << 9);
+  const T t4 = static_cast<T>(lw0 ^ lw6);
+  const T t5 = static_cast<T>(lw5 >> 1);
+  const T t6 = static_cast<T>(lw2 ^ lw4);
+  const T t7 = static_cast<T>(t6 >> 6);
+  const T t8 = static_cast<T>(lw0 >> 7);
+  const T t9 = static_cast<T>(t0 ^ t2);
+  const T t10 = static_cast<T>(t3 ^ t9);
+  const T t11 = static_cast<T>(t4 ^ t10);
+  const T t12 = static_cast<T>(t5 ^ t11);
+  const T t13 = static_cast<T>(t7 ^ t12);
+  const T t14 = static_cast<T>(t8 ^ t13);
+  return t14;
+}
+
+// F(Bt) --- NFSR feedback, excluding s0 term of f, for 16 consecutive clocks
+//
+// naive: 52 shift, 40 xor, 14 and
+// ungrouped: 52 shift, 40 xor, 14 and ( cost 106 )
+// grouped: 46 shift, 37 xor, 17 and ( cost 100 )
+// emitted: grouped
+template<typename T = uint16_t>
+inline static T
+fbx16(const T* const nfsr)
+{
+  const T nw0 = nfsr[0];
+  const T nw4 = nfsr[4];
+  const T nw1 = nfsr[1];
+  const T nw5 = nfsr[5];
+  const T t0 = static_cast<T>(nw0 & nw4);
+  const T t1 = static_cast<T>(t0 >> 3);
+  const T t2 = static_cast<T>(nw1 & nw5);
+  const T t3 = static_cast<T>(t2 << 13);
+  const T t4 = static_cast<T>(t1 ^ t3);
+  const T t5 = static_cast<T>(nw0 >> 11);
+  const T t6 = static_cast<T>(nw1 << 5);
+  const T t7 = static_cast<T>(t5 ^ t6);
+  const T t8 = static_cast<T>(nw0 >> 13);
+  const T t9 = static_cast<T>(nw1 << 3);
+  const T t10 = static_cast<T>(t8 ^ t9);
+  const T t11 = static_cast<T>(t7 & t10);
+  const T nw2 = nfsr[2];
+  const T t12 = static_cast<T>(nw1 >> 1);
+  const T t13 = static_cast<T>(nw2 << 15);
+  const T t14 = static_cast<T>(t12 ^ t13);
+  const T t15 = static_cast<T>(nw1 >> 2);
+  const T t16 = static_cast<T>(nw2 << 14);
+  const T t17 = static_cast<T>(t15 ^ t16);
+  const T t18 = static_cast<T>(t14 & t17);
+  const T nw3 = nfsr[3];
+  const T t19 = static_cast<T>(nw1 & nw3);
+  const T t20 = static_cast<T>(t19 >> 11);
+  const T t21 = static_cast<T>(nw4 & nw2);
+  const T t22 = static_cast<T>(t21 << 5);
+  const T t23 = static_cast<T>(t20 ^ t22);
+  const T t24 = static_cast<T>(nw2 >> 8);
+  const T t25 = static_cast<T>(nw3 << 8);
+  const T t26 = static_cast<T>(t24 ^ t25);
+  const T t27 = static_cast<T>(nw3 & t26);
+  const T t28 = static_cast<T>(nw4 >> 1);
+  const T t29 = static_cast<T>(nw5 << 15);
+  const T t30 = static_cast<T>(t28 ^ t29);
+  const T t31 = static_cast<T>(nw3 >> 13);
+  const T t32 = static_cast<T>(nw4 << 3);
+  const T t33 = static_cast<T>(t31 ^ t32);
+  const T t34 = static_cast<T>(t30 & t33);
+  const T nw6 = nfsr[6];
+  const T t35 = static_cast<T>(nw4 & nw5);
+  const T t36 = static_cast<T>(t35 >> 4);
+  const T t37 = static_cast<T>(nw5 & nw6);
+  const T t38 = static_cast<T>(t37 << 12);
+  const T t39 = static_cast<T>(t36 ^ t38);
+  const T t40 = static_cast<T>(nw1 >> 6);
+  const T t41 = static_cast<T>(nw2 << 10);
+  const T t42 = static_cast<T>(t40 ^ t41);
+  const T t43 = static_cast<T>(nw1 >> 8);
+  const T t44 = static_cast<T>(nw2 << 8);
+  const T t45 = static_cast<T>(t43 ^ t44);
+  const T t46 = static_cast<T>(nw1 >> 9);
+  const T t47 = static_cast<T>(nw2 << 7);
+  const T t48 = static_cast<T>(t46 ^ t47);
+  const T t49 = static_cast<T>(t42 & t45);
+  const T t50 = static_cast<T>(t48 & t49);
+  const T t51 = static_cast<T>(nw5 >> 2);
+  const T t52 = static_cast<T>(nw6 << 14);
+  const T t53 = static_cast<T>(t51 ^ t52);
+  const T t54 = static_cast<T>(nw4 >> 6);
+  const T t55 = static_cast<T>(nw5 << 10);
+  const T t56 = static_cast<T>(t54 ^ t55);
+  const T t57 = static_cast<T>(nw4 >> 14);
+  const T t58 = static_cast<T>(nw5 << 2);
+  const T t59 = static_cast<T>(t57 ^ t58);
+  const T t60 = static_cast<T>(t53 & t56);
+  const T t61 = static_cast<T>(t59 & t60);
+  const T t62 = static_cast<T>(nw5 >> 8);
+  const T t63 = static_cast<T>(nw6 << 8);
+  const T t64 = static_cast<T>(t62 ^ t63);
+  const T t65 = static_cast<T>(nw5 >> 12);
+  const T t66 = static_cast<T>(nw6 << 4);
+  const T t67 = static_cast<T>(t65 ^ t66);
+  const T t68 = static_cast<T>(nw5 >> 13);
+  const T t69 = static_cast<T>(nw6 << 3);
+  const T t70 = static_cast<T>(t68 ^ t69);
+  const T t71 = static_cast<T>(nw5 >> 15);
+  const T t72 = static_cast<T>(nw6 << 1);
+  const T t73 = static_cast<T>(t71 ^ t72);
+  const T t74 = static_cast<T>(t64 & t67);
+  const T t75 = static_cast<T>(t70 & t74);
+  const T t76 = static_cast<T>(t73 & t75);
+  const T t77 = static_cast<T>(nw4 << 8);
+  const T t78 = static_cast<T>(nw2 << 6);
+  const T t79 = static_cast<T>(nw6 << 5);
+  const T t80 = static_cast<T>(nw0 ^ nw6);
+  const T t81 = static_cast<T>(nw3 >> 8);
+  const T t82 = static_cast<T>(nw1 >> 10);
+  const T t83 = static_cast<T>(nw5 >> 11);
+  const T t84 = static_cast<T>(t4 ^ t11);
+  const T t85 = static_cast<T>(t18 ^ t84);
+  const T t86 = static_cast<T>(t23 ^ t85);
+  const T t87 = static_cast<T>(t27 ^ t86);
+  const T t88 = static_cast<T>(t34 ^ t87);
+  const T t89 = static_cast<T>(t39 ^ t88);
+  const T t90 = static_cast<T>(t50 ^ t89);
+  const T t91 = static_cast<T>(t61 ^ t90);
+  const T t92 = static_cast<T>(t76 ^ t91);
+  const T t93 = static_cast<T>(t77 ^ t92);
+  const T t94 = static_cast<T>(t78 ^ t93);
+  const T t95 = static_cast<T>(t79 ^ t94);
+  const T t96 = static_cast<T>(t80 ^ t95);
+  const T t97 = static_cast<T>(t81 ^ t96);
+  const T t98 = static_cast<T>(t82 ^ t97);
+  const T t99 = static_cast<T>(t83 ^ t98);
+  return t99;
+}
+
+// h(x) --- boolean function of pre-output generator, for 16 consecutive clocks
+//
+// naive: 22 shift, 15 xor, 6 and
+// ungrouped: 18 shift, 13 xor, 5 and ( cost 36 )
+// grouped: 18 shift, 13 xor, 5 and ( cost 36 )
+// emitted: ungrouped
+template<typename T = uint16_t>
+inline static T
+hx16(const T* const nfsr,
+      const T* const lfsr)
+{
+  const T lw0 = lfsr[0];
+  const T lw1 = lfsr[1];
+  const T t0 = static_cast<T>(lw0 >> 8);
+  const T t1 = static_cast<T>(lw1 << 8);
+  const T t2 = static_cast<T>(t0 ^ t1);
+  const T lw5 = lfsr[5];
+  const T lw6 = lfsr[6];
+  const T t3 = static_cast<T>(lw5 >> 14);
+  const T t4 = static_cast<T>(lw6 << 2);
+  const T t5 = static_cast<T>(t3 ^ t4);
+  const T nw5 = nfsr[5];
+  const T nw6 = nfsr[6];
+  const T t6 = static_cast<T>(nw5 >> 15);
+  const T t7 = static_cast<T>(nw6 << 1);
+  const T t8 = static_cast<T>(t6 ^ t7);
+  const T t9 = static_cast<T>(t5 & t8);
+  const T nw0 = nfsr[0];
+  const T nw1 = nfsr[1];
+  const T t10 = static_cast<T>(nw0 >> 12);
+  const T t11 = static_cast<T>(nw1 << 4);
+  const T t12 = static_cast<T>(t10 ^ t11);
+  const T t13 = static_cast<T>(t2 ^ t9);
+  const T t14 = static_cast<T>(t12 & t13);
+  const T lw2 = lfsr[2];
+  const T t15 = static_cast<T>(lw1 >> 4);
+  const T t16 = static_cast<T>(lw2 << 12);
+  const T t17 = static_cast<T>(t15 ^ t16);
+  const T t18 = static_cast<T>(lw0 >> 13);
+  const T t19 = static_cast<T>(lw1 << 3);
+  const T t20 = static_cast<T>(t18 ^ t19);
+  const T t21 = static_cast<T>(t17 & t20);
+  const T lw3 = lfsr[3];
+  const T t22 = static_cast<T>(lw2 >> 10);
+  const T t23 = static_cast<T>(lw3 << 6);
+  const T t24 = static_cast<T>(t22 ^ t23);
+  const T t25 = static_cast<T>(t8 & t24);
+  const T lw4 = lfsr[4];
+  const T t26 = static_cast<T>(lw3 >> 12);
+  const T t27 = static_cast<T>(lw4 << 4);
+  const T t28 = static_cast<T>(t26 ^ t27);
+  const T t29 = static_cast<T>(lw4 >> 15);
+  const T t30 = static_cast<T>(lw5 << 1);
+  const T t31 = static_cast<T>(t29 ^ t30);
+  const T t32 = static_cast<T>(t28 & t31);
+  const T t33 = static_cast<T>(t14 ^ t21);
+  const T t34 = static_cast<T>(t25 ^ t33);
+  const T t35 = static_cast<T>(t32 ^ t34);
+  return t35;
+}
+
+// yt --- pre-output generator function, for 16 consecutive clocks
+//
+// naive: 36 shift, 30 xor, 6 and
+// ungrouped: 28 shift, 28 xor, 5 and ( cost 61 )
+// grouped: 28 shift, 28 xor, 5 and ( cost 61 )
+// emitted: ungrouped
+template<typename T = uint16_t>
+inline static T
+ksbx16(const T* const nfsr,
+        const T* const lfsr)
+{
+  const T lw0 = lfsr[0];
+  const T lw1 = lfsr[1];
+  const T t0 = static_cast<T>(lw0 >> 8);
+  const T t1 = static_cast<T>(lw1 << 8);
+  const T t2 = static_cast<T>(t0 ^ t1);
+  const T lw5 = lfsr[5];
+  const T lw6 = lfsr[6];
+  const T t3 = static_cast<T>(lw5 >> 14);
+  const T t4 = static_cast<T>(lw6 << 2);
+  const T t5 = static_cast<T>(t3 ^ t4);
+  const T nw5 = nfsr[5];
+  const T nw6 = nfsr[6];
+  const T t6 = static_cast<T>(nw5 >> 15);
+  const T t7 = static_cast<T>(nw6 << 1);
+  const T t8 = static_cast<T>(t6 ^ t7);
+  const T t9 = static_cast<T>(t5 & t8);
+  const T nw0 = nfsr[0];
+  const T nw1 = nfsr[1];
+  const T t10 = static_cast<T>(nw0 >> 12);
+  const T t11 = static_cast<T>(nw1 << 4);
+  const T t12 = static_cast<T>(t10 ^ t11);
+  const T t13 = static_cast<T>(t2 ^ t9);
+  const T t14 = static_cast<T>(t12 & t13);
+  const T lw2 = lfsr[2];
+  const T t15 = static_cast<T>(lw1 >> 4);
+  const T t16 = static_cast<T>(lw2 << 12);
+  const T t17 = static_cast<T>(t15 ^ t16);
+  const T t18 = static_cast<T>(lw0 >> 13);
+  const T t19 = static_cast<T>(lw1 << 3);
+  const T t20 = static_cast<T>(t18 ^ t19);
+  const T t21 = static_cast<T>(t17 & t20);
+  const T lw3 = lfsr[3];
+  const T t22 = static_cast<T>(lw2 >> 10);
+  const T t23 = static_cast<T>(lw3 << 6);
+  const T t24 = static_cast<T>(t22 ^ t23);
+  const T t25 = static_cast<T>(t8 & t24);
+  const T lw4 = lfsr[4];
+  const T t26 = static_cast<T>(lw3 >> 12);
+  const T t27 = static_cast<T>(lw4 << 4);
+  const T t28 = static_cast<T>(t26 ^ t27);
+  const T t29 = static_cast<T>(lw4 >> 15);
+  const T t30 = static_cast<T>(lw5 << 1);
+  const T t31 = static_cast<T>(t29 ^ t30);
+  const T t32 = static_cast<T>(t28 & t31);
+  const T nw2 = nfsr[2];
+  const T nw3 = nfsr[3];
+  const T nw4 = nfsr[4];
+  const T t33 = static_cast<T>(nw1 << 14);
+  const T t34 = static_cast<T>(nw3 << 12);
+  const T t35 = static_cast<T>(nw5 ^ nw6);
+  const T t36 = static_cast<T>(t35 << 7);
+  const T t37 = static_cast<T>(lw6 ^ nw3);
+  const T t38 = static_cast<T>(t37 << 3);
+  const T t39 = static_cast<T>(nw1 << 1);
+  const T t40 = static_cast<T>(nw0 >> 2);
+  const T t41 = static_cast<T>(nw2 >> 4);
+  const T t42 = static_cast<T>(nw5 ^ nw4);
+  const T t43 = static_cast<T>(t42 >> 9);
+  const T t44 = static_cast<T>(lw5 ^ nw2);
+  const T t45 = static_cast<T>(t44 >> 13);
+  const T t46 = static_cast<T>(nw0 >> 15);
+  const T t47 = static_cast<T>(t14 ^ t21);
+  const T t48 = static_cast<T>(t25 ^ t47);
+  const T t49 = static_cast<T>(t32 ^ t48);
+  const T t50 = static_cast<T>(nw4 ^ t49);
+  const T t51 = static_cast<T>(t33 ^ t50);
+  const T t52 = static_cast<T>(t34 ^ t51);
+  const T t53 = static_cast<T>(t36 ^ t52);
+  const T t54 = static_cast<T>(t38 ^ t53);
+  const T t55 = static_cast<T>(t39 ^ t54);
+  const T t56 = static_cast<T>(t40 ^ t55);
+  const T t57 = static_cast<T>(t41 ^ t56);
+  const T t58 = static_cast<T>(t43 ^ t57);
+  const T t59 = static_cast<T>(t45 ^ t58);
+  const T t60 = static_cast<T>(t46 ^ t59);
+  return t60;
+}
+
+// L(St) --- update function of LFSR, for 32 consecutive clocks
+//
+// naive: 8 shift, 9 xor, 0 and
+// ungrouped: 6 shift, 9 xor, 0 and ( cost 15 )
+// grouped: 6 shift, 9 xor, 0 and ( cost 15 )
+// emitted: ungrouped
+template<typename T = uint32_t>
+inline static T
+lx32(const T* const lfsr)
+{
+  const T lw0 = lfsr[0];
+  const T lw1 = lfsr[1];
+  const T lw2 = lfsr[2];
+  const T lw3 = lfsr[3];
+  const T t0 = static_cast<T>(lw2 ^ lw3);
+  const T t1 = static_cast<T>(t0 << 26);
+  const T t2 = static_cast<T>(lw1 << 25);
+  const T t3 = static_cast<T>(lw3 << 15);
+  const T t4 = static_cast<T>(lw0 ^ lw3);
+  const T t5 = static_cast<T>(lw1 ^ lw2);
+  const T t6 = static_cast<T>(t5 >> 6);
+  const T t7 = static_cast<T>(lw0 >> 7);
+  const T t8 = static_cast<T>(lw2 >> 17);
+  const T t9 = static_cast<T>(t1 ^ t2);
+  const T t10 = static_cast<T>(t3 ^ t9);
+  const T t11 = static_cast<T>(t4 ^ t10);
+  const T t12 = static_cast<T>(t6 ^ t11);
+  const T t13 = static_cast<T>(t7 ^ t12);
+  const T t14 = static_cast<T>(t8 ^ t13);
+  return t14;
+}
+
+// F(Bt) --- NFSR feedback, excluding s0 term of f, for 32 consecutive clocks
+//
+// naive: 54 shift, 41 xor, 14 and
+// ungrouped: 54 shift, 41 xor, 14 and ( cost 109 )
+// grouped: 50 shift, 39 xor, 16 and ( cost 105 )
+// emitted: grouped
+template<typename T = uint32_t>
+inline static T
+fbx32(const T* const nfsr)
+{
+  const T nw0 = nfsr[0];
+  const T nw2 = nfsr[2];
+  const T nw1 = nfsr[1];
+  const T nw3 = nfsr[3];
+  const T t0 = static_cast<T>(nw0 & nw2);
+  const T t1 = static_cast<T>(t0 >> 3);
+  const T t2 = static_cast<T>(nw1 & nw3);
+  const T t3 = static_cast<T>(t2 << 29);
+  const T t4 = static_cast<T>(t1 ^ t3);
+  const T t5 = static_cast<T>(nw0 >> 11);
+  const T t6 = static_cast<T>(nw1 << 21);
+  const T t7 = static_cast<T>(t5 ^ t6);
+  const T t8 = static_cast<T>(nw0 >> 13);
+  const T t9 = static_cast<T>(nw1 << 19);
+  const T t10 = static_cast<T>(t8 ^ t9);
+  const T t11 = static_cast<T>(t7 & t10);
+  const T t12 = static_cast<T>(nw0 >> 17);
+  const T t13 = static_cast<T>(nw1 << 15);
+  const T t14 = static_cast<T>(t12 ^ t13);
+  const T t15 = static_cast<T>(nw0 >> 18);
+  const T t16 = static_cast<T>(nw1 << 14);
+  const T t17 = static_cast<T>(t15 ^ t16);
+  const T t18 = static_cast<T>(t14 & t17);
+  const T t19 = static_cast<T>(nw0 & nw1);
+  const T t20 = static_cast<T>(t19 >> 27);
+  const T t21 = static_cast<T>(nw2 & nw1);
+  const T t22 = static_cast<T>(t21 << 5);
+  const T t23 = static_cast<T>(t20 ^ t22);
+  const T t24 = static_cast<T>(nw1 >> 8);
+  const T t25 = static_cast<T>(nw2 << 24);
+  const T t26 = static_cast<T>(t24 ^ t25);
+  const T t27 = static_cast<T>(nw1 >> 16);
+  const T t28 = static_cast<T>(nw2 << 16);
+  const T t29 = static_cast<T>(t27 ^ t28);
+  const T t30 = static_cast<T>(t26 & t29);
+  const T t31 = static_cast<T>(nw2 >> 1);
+  const T t32 = static_cast<T>(nw3 << 31);
+  const T t33 = static_cast<T>(t31 ^ t32);
+  const T t34 = static_cast<T>(nw1 >> 29);
+  const T t35 = static_cast<T>(nw2 << 3);
+  const T t36 = static_cast<T>(t34 ^ t35);
+  const T t37 = static_cast<T>(t33 & t36);
+  const T t38 = static_cast<T>(nw2 >> 4);
+  const T t39 = static_cast<T>(nw3 << 28);
+  const T t40 = static_cast<T>(t38 ^ t39);
+  const T t41 = static_cast<T>(nw2 >> 20);
+  const T t42 = static_cast<T>(nw3 << 12);
+  const T t43 = static_cast<T>(t41 ^ t42);
+  const T t44 = static_cast<T>(t40 & t43);
+  const T t45 = static_cast<T>(nw0 >> 22);
+  const T t46 = static_cast<T>(nw1 << 10);
+  const T t47 = static_cast<T>(t45 ^ t46);
+  const T t48 = static_cast<T>(nw0 >> 24);
+  const T t49 = static_cast<T>(nw1 << 8);
+  const T t50 = static_cast<T>(t48 ^ t49);
+  const T t51 = static_cast<T>(nw0 >> 25);
+  const T t52 = static_cast<T>(nw1 << 7);
+  const T t53 = static_cast<T>(t51 ^ t52);
+  const T t54 = static_cast<T>(t47 & t50);
+  const T t55 = static_cast<T>(t53 & t54);
+  const T t56 = static_cast<T>(nw2 >> 6);
+  const T t57 = static_cast<T>(nw3 << 26);
+  const T t58 = static_cast<T>(t56 ^ t57);
+  const T t59 = static_cast<T>(nw2 >> 14);
+  const T t60 = static_cast<T>(nw3 << 18);
+  const T t61 = static_cast<T>(t59 ^ t60);
+  const T t62 = static_cast<T>(nw2 >> 18);
+  const T t63 = static_cast<T>(nw3 << 14);
+  const T t64 = static_cast<T>(t62 ^ t63);
+  const T t65 = static_cast<T>(t58 & t61);
+  const T t66 = static_cast<T>(t64 & t65);
+  const T t67 = static_cast<T>(nw2 >> 24);
+  const T t68 = static_cast<T>(nw3 << 8);
+  const T t69 = static_cast<T>(t67 ^ t68);
+  const T t70 = static_cast<T>(nw2 >> 28);
+  const T t71 = static_cast<T>(nw3 << 4);
+  const T t72 = static_cast<T>(t70 ^ t71);
+  const T t73 = static_cast<T>(nw2 >> 29);
+  const T t74 = static_cast<T>(nw3 << 3);
+  const T t75 = static_cast<T>(t73 ^ t74);
+  const T t76 = static_cast<T>(nw2 >> 31);
+  const T t77 = static_cast<T>(nw3 << 1);
+  const T t78 = static_cast<T>(t76 ^ t77);
+  const T t79 = static_cast<T>(t69 & t72);
+  const T t80 = static_cast<T>(t75 & t79);
+  const T t81 = static_cast<T>(t78 & t80);
+  const T t82 = static_cast<T>(nw2 << 8);
+  const T t83 = static_cast<T>(nw1 << 6);
+  const T t84 = static_cast<T>(nw3 << 5);
+  const T t85 = static_cast<T>(nw0 ^ nw3);
+  const T t86 = static_cast<T>(nw1 >> 24);
+  const T t87 = static_cast<T>(nw0 >> 26);
+  const T t88 = static_cast<T>(nw2 >> 27);
+  const T t89 = static_cast<T>(t4 ^ t11);
+  const T t90 = static_cast<T>(t18 ^ t89);
+  const T t91 = static_cast<T>(t23 ^ t90);
+  const T t92 = static_cast<T>(t30 ^ t91);
+  const T t93 = static_cast<T>(t37 ^ t92);
+  const T t94 = static_cast<T>(t44 ^ t93);
+  const T t95 = static_cast<T>(t55 ^ t94);
+  const T t96 = static_cast<T>(t66 ^ t95);
+  const T t97 = static_cast<T>(t81 ^ t96);
+  const T t98 = static_cast<T>(t82 ^ t97);
+  const T t99 = static_cast<T>(t83 ^ t98);
+  const T t100 = static_cast<T>(t84 ^ t99);
+  const T t101 = static_cast<T>(t85 ^ t100);
+  const T t102 = static_cast<T>(t86 ^ t101);
+  const T t103 = static_cast<T>(t87 ^ t102);
+  const T t104 = static_cast<T>(t88 ^ t103);
+  return t104;
+}
+
+// h(x) --- boolean function of pre-output generator, for 32 consecutive clocks
+//
+// naive: 22 shift, 15 xor, 6 and
+// ungrouped: 18 shift, 13 xor, 5 and ( cost 36 )
+// grouped: 18 shift, 13 xor, 5 and ( cost 36 )
+// emitted: ungrouped
+template<typename T = uint32_t>
+inline static T
+hx32(const T* const nfsr,
+      const T* const lfsr)
+{
+  const T lw0 = lfsr[0];
+  const T lw1 = lfsr[1];
+  const T t0 = static_cast<T>(lw0 >> 8);
+  const T t1 = static_cast<T>(lw1 << 24);
+  const T t2 = static_cast<T>(t0 ^ t1);
+  const T lw2 = lfsr[2];
+  const T lw3 = lfsr[3];
+  const T t3 = static_cast<T>(lw2 >> 30);
+  const T t4 = static_cast<T>(lw3 << 2);
+  const T t5 = static_cast<T>(t3 ^ t4);
+  const T nw2 = nfsr[2];
+  const T nw3 = nfsr[3];
+  const T t6 = static_cast<T>(nw2 >> 31);
+  const T t7 = static_cast<T>(nw3 << 1);
+  const T t8 = static_cast<T>(t6 ^ t7);
+  const T t9 = static_cast<T>(t5 & t8);
+  const T nw0 = nfsr[0];
+  const T nw1 = nfsr[1];
+  const T t10 = static_cast<T>(nw0 >> 12);
+  const T t11 = static_cast<T>(nw1 << 20);
+  const T t12 = static_cast<T>(t10 ^ t11);
+  const T t13 = static_cast<T>(t2 ^ t9);
+  const T t14 = static_cast<T>(t12 & t13);
+  const T t15 = static_cast<T>(lw0 >> 13);
+  const T t16 = static_cast<T>(lw1 << 19);
+  const T t17 = static_cast<T>(t15 ^ t16);
+  const T t18 = static_cast<T>(lw0 >> 20);
+  const T t19 = static_cast<T>(lw1 << 12);
+  const T t20 = static_cast<T>(t18 ^ t19);
+  const T t21 = static_cast<T>(t17 & t20);
+  const T t22 = static_cast<T>(lw1 >> 10);
+  const T t23 = static_cast<T>(lw2 << 22);
+  const T t24 = static_cast<T>(t22 ^ t23);
+  const T t25 = static_cast<T>(t8 & t24);
+  const T t26 = static_cast<T>(lw2 >> 15);
+  const T t27 = static_cast<T>(lw3 << 17);
+  const T t28 = static_cast<T>(t26 ^ t27);
+  const T t29 = static_cast<T>(lw1 >> 28);
+  const T t30 = static_cast<T>(lw2 << 4);
+  const T t31 = static_cast<T>(t29 ^ t30);
+  const T t32 = static_cast<T>(t28 & t31);
+  const T t33 = static_cast<T>(t14 ^ t21);
+  const T t34 = static_cast<T>(t25 ^ t33);
+  const T t35 = static_cast<T>(t32 ^ t34);
+  return t35;
+}
+
+// yt --- pre-output generator function, for 32 consecutive clocks
+//
+// naive: 36 shift, 30 xor, 6 and
+// ungrouped: 32 shift, 28 xor, 5 and ( cost 65 )
+// grouped: 32 shift, 28 xor, 5 and ( cost 65 )
+// emitted: ungrouped
+template<typename T = uint32_t>
+inline static T
+ksbx32(const T* const nfsr,
+        const T* const lfsr)
+{
+  const T lw0 = lfsr[0];
+  const T lw1 = lfsr[1];
+  const T t0 = static_cast<T>(lw0 >> 8);
+  const T t1 = static_cast<T>(lw1 << 24);
+  const T t2 = static_cast<T>(t0 ^ t1);
+  const T lw2 = lfsr[2];
+  const T lw3 = lfsr[3];
+  const T t3 = static_cast<T>(lw2 >> 30);
+  const T t4 = static_cast<T>(lw3 << 2);
+  const T t5 = static_cast<T>(t3 ^ t4);
+  const T nw2 = nfsr[2];
+  const T nw3 = nfsr[3];
+  const T t6 = static_cast<T>(nw2 >> 31);
+  const T t7 = static_cast<T>(nw3 << 1);
+  const T t8 = static_cast<T>(t6 ^ t7);
+  const T t9 = static_cast<T>(t5 & t8);
+  const T nw0 = nfsr[0];
+  const T nw1 = nfsr[1];
+  const T t10 = static_cast<T>(nw0 >> 12);
+  const T t11 = static_cast<T>(nw1 << 20);
+  const T t12 = static_cast<T>(t10 ^ t11);
+  const T t13 = static_cast<T>(t2 ^ t9);
+  const T t14 = static_cast<T>(t12 & t13);
+  const T t15 = static_cast<T>(lw0 >> 13);
+  const T t16 = static_cast<T>(lw1 << 19);
+  const T t17 = static_cast<T>(t15 ^ t16);
+  const T t18 = static_cast<T>(lw0 >> 20);
+  const T t19 = static_cast<T>(lw1 << 12);
+  const T t20 = static_cast<T>(t18 ^ t19);
+  const T t21 = static_cast<T>(t17 & t20);
+  const T t22 = static_cast<T>(lw1 >> 10);
+  const T t23 = static_cast<T>(lw2 << 22);
+  const T t24 = static_cast<T>(t22 ^ t23);
+  const T t25 = static_cast<T>(t8 & t24);
+  const T t26 = static_cast<T>(lw2 >> 15);
+  const T t27 = static_cast<T>(lw3 << 17);
+  const T t28 = static_cast<T>(t26 ^ t27);
+  const T t29 = static_cast<T>(lw1 >> 28);
+  const T t30 = static_cast<T>(lw2 << 4);
+  const T t31 = static_cast<T>(t29 ^ t30);
+  const T t32 = static_cast<T>(t28 & t31);
+  const T t33 = static_cast<T>(nw1 << 30);
+  const T t34 = static_cast<T>(nw2 << 28);
+  const T t35 = static_cast<T>(nw3 << 23);
+  const T t36 = static_cast<T>(nw2 << 19);
+  const T t37 = static_cast<T>(nw1 << 17);
+  const T t38 = static_cast<T>(nw3 << 7);
+  const T t39 = static_cast<T>(lw3 << 3);
+  const T t40 = static_cast<T>(nw0 >> 2);
+  const T t41 = static_cast<T>(nw1 >> 4);
+  const T t42 = static_cast<T>(nw2 >> 9);
+  const T t43 = static_cast<T>(nw1 >> 13);
+  const T t44 = static_cast<T>(nw0 >> 15);
+  const T t45 = static_cast<T>(nw2 >> 25);
+  const T t46 = static_cast<T>(lw2 >> 29);
+  const T t47 = static_cast<T>(nw2 ^ t14);
+  const T t48 = static_cast<T>(t21 ^ t47);
+  const T t49 = static_cast<T>(t25 ^ t48);
+  const T t50 = static_cast<T>(t32 ^ t49);
+  const T t51 = static_cast<T>(t33 ^ t50);
+  const T t52 = static_cast<T>(t34 ^ t51);
+  const T t53 = static_cast<T>(t35 ^ t52);
+  const T t54 = static_cast<T>(t36 ^ t53);
+  const T t55 = static_cast<T>(t37 ^ t54);
+  const T t56 = static_cast<T>(t38 ^ t55);
+  const T t57 = static_cast<T>(t39 ^ t56);
+  const T t58 = static_cast<T>(t40 ^ t57);
+  const T t59 = static_cast<T>(t41 ^ t58);
+  const T t60 = static_cast<T>(t42 ^ t59);
+  const T t61 = static_cast<T>(t43 ^ t60);
+  const T t62 = static_cast<T>(t44 ^ t61);
+  const T t63 = static_cast<T>(t45 ^ t62);
+  const T t64 = static_cast<T>(t46 ^ t63);
+  return t64;
+}
+
+}
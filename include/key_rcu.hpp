@@ -0,0 +1,386 @@
+#pragma once
+#include "grain_128aead.hpp"
+#include <atomic>
+#include <limits>
+#include <linux/membarrier.h>
+#include <memory>
+#include <mutex>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// RCU-style holder of a rotating secret key, shared by many encrypting threads,
+// where readers access current key without any atomic read-modify-write ( or,
+// when membarrier(2) is available, without any memory fence ) on fast path;
+// old keys are retired after a grace period, once no reader can still be using
+// them.
+namespace key_rcu {
+
+// Key snapshot, published by holder; it also carries previous generation's key,
+// so that receivers can open messages sealed right before rotation
+struct snapshot_t
+{
+  uint64_t gen = 0;
+  uint8_t key[16]{};
+  uint64_t prev_gen = 0;
+  uint8_t prev_key[16]{};
+  bool has_prev = false;
+};
+
+// Registers process for expedited private membarrier(2) ( once ), returning
+// whether readers can skip hardware fences, relying on writer issuing
+// membarrier, instead
+inline static bool
+asymmetric_fences()
+{
+  static const bool ok = [] {
+    const long cmds = syscall(SYS_membarrier, MEMBARRIER_CMD_QUERY, 0);
+    if (cmds < 0 || !(cmds & MEMBARRIER_CMD_PRIVATE_EXPEDITED)) {
+      return false;
+    }
+    return syscall(SYS_membarrier,
+                   MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED,
+                   0) == 0;
+  }();
+
+  return ok;
+}
+
+// Reader side fence, ordering publication of reader's epoch before its load of
+// current snapshot; compiler-only fence when writer uses membarrier
+inline static void
+reader_fence()
+{
+  if (asymmetric_fences()) {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  } else {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+}
+
+// Writer side fence, pairing with `reader_fence`
+inline static void
+writer_fence()
+{
+  if (asymmetric_fences()) {
+    syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+  } else {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+}
+
+// Epoch value of a reader, not inside read-side critical section
+constexpr uint64_t QUIESCENT = 0;
+
+// Holder of current key, with a fixed number of reader slots; each reader
+// thread leases its own slot ( see `reader` ) and uses it for all its reads.
+//
+// Read side critical section publishes global epoch into reader's own cache
+// line and loads current snapshot; writer ( `rotate` ) swaps snapshot, bumps
+// epoch and retires old snapshot, which is freed once every reader is either
+// quiescent or has entered critical section in a later epoch.
+class holder_t
+{
+public:
+  // Sets up holder with initial key of generation 1
+  explicit holder_t(const uint8_t* const key, const size_t max_readers = 256)
+    : slots(std::make_unique<slot_t[]>(max_readers))
+    , nslots(max_readers)
+  {
+    asymmetric_fences();
+
+    auto* s = new snapshot_t{};
+    s->gen = 1;
+    std::memcpy(s->key, key, 16);
+    current.store(s, std::memory_order_release);
+  }
+
+  holder_t(const holder_t&) = delete;
+  holder_t& operator=(const holder_t&) = delete;
+
+  // Must only be destroyed once all readers are released
+  ~holder_t()
+  {
+    destroy(current.load(std::memory_order_relaxed));
+    for (const auto& r : retired) {
+      destroy(r.snap);
+    }
+  }
+
+  // Read-side critical section; snapshot stays valid for its whole lifetime,
+  // even if key is rotated meanwhile. Keep it short, as it delays reclamation.
+  class guard_t
+  {
+  public:
+    guard_t(const guard_t&) = delete;
+    guard_t& operator=(const guard_t&) = delete;
+
+    ~guard_t() { slot->store(QUIESCENT, std::memory_order_release); }
+
+    const snapshot_t* operator->() const { return snap; }
+    const snapshot_t& operator*() const { return *snap; }
+
+  private:
+    friend class holder_t;
+
+    guard_t(std::atomic<uint64_t>* const slot, const snapshot_t* const snap)
+      : slot(slot)
+      , snap(snap)
+    {
+    }
+
+    std::atomic<uint64_t>* slot;
+    const snapshot_t* snap;
+  };
+
+  // Reader handle, owning one slot of holder; not to be shared across threads
+  class reader_t
+  {
+  public:
+    reader_t(const reader_t&) = delete;
+    reader_t& operator=(const reader_t&) = delete;
+
+    reader_t(reader_t&& o) noexcept
+      : holder(o.holder)
+      , idx(o.idx)
+    {
+      o.holder = nullptr;
+    }
+
+    ~reader_t()
+    {
+      if (holder != nullptr) {
+        holder->slots[idx].used.store(false, std::memory_order_release);
+      }
+    }
+
+    // Whether a slot could be leased
+    bool valid() const { return holder != nullptr; }
+
+    // Enters read-side critical section, with no atomic read-modify-write;
+    // critical sections of same reader must not be nested.
+    //
+    // Epoch is loaded with acquire ordering, so that seeing epoch bumped by
+    // `rotate` also makes snapshot published before that bump visible; else
+    // ( say on ARM, where loads can be reordered ) reader could enter in new
+    // epoch, while still loading retired snapshot, which may then be freed
+    // under it.
+    guard_t lock() const
+    {
+      auto& slot = holder->slots[idx];
+
+      const uint64_t e = holder->epoch.load(std::memory_order_acquire);
+      slot.epoch.store(e, std::memory_order_relaxed);
+      reader_fence();
+
+      const snapshot_t* s = holder->current.load(std::memory_order_acquire);
+      return guard_t(&slot.epoch, s);
+    }
+
+  private:
+    friend class holder_t;
+
+    reader_t(holder_t* const holder, const size_t idx)
+      : holder(holder)
+      , idx(idx)
+    {
+    }
+
+    holder_t* holder;
+    size_t idx;
+  };
+
+  // Leases a reader slot; returned handle is invalid, if all slots are taken
+  reader_t reader()
+  {
+    for (size_t i = 0; i < nslots; i++) {
+      bool exp = false;
+      if (slots[i].used.compare_exchange_strong(exp, true)) {
+        return reader_t(this, i);
+      }
+    }
+    return reader_t(nullptr, 0);
+  }
+
+  // Publishes new key, as next generation, retiring current one; returns new
+  // generation number. Retired keys are freed ( and zeroed ) by this or a later
+  // call to `rotate`/ `reclaim`/ `synchronize`, once their grace period has
+  // elapsed.
+  uint64_t rotate(const uint8_t* const key)
+  {
+    std::lock_guard<std::mutex> lock(writer_mtx);
+
+    snapshot_t* old = current.load(std::memory_order_relaxed);
+
+    auto* s = new snapshot_t{};
+    s->gen = old->gen + 1;
+    std::memcpy(s->key, key, 16);
+    s->prev_gen = old->gen;
+    std::memcpy(s->prev_key, old->key, 16);
+    s->has_prev = true;
+
+    current.store(s, std::memory_order_seq_cst);
+    cur_gen.store(s->gen, std::memory_order_release);
+    const uint64_t e = epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+    retired.push_back({ old, e });
+    reclaim_locked();
+
+    return s->gen;
+  }
+
+  // Frees retired snapshots, whose grace period has elapsed, without blocking;
+  // returns how many of them are still waiting
+  size_t reclaim()
+  {
+    std::lock_guard<std::mutex> lock(writer_mtx);
+    return reclaim_locked();
+  }
+
+  // Blocks until all retired snapshots are freed
+  void synchronize()
+  {
+    while (reclaim() > 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  // Generation of current key
+  uint64_t generation() const
+  {
+    return cur_gen.load(std::memory_order_acquire);
+  }
+
+private:
+  struct alignas(64) slot_t
+  {
+    std::atomic<uint64_t> epoch{ QUIESCENT };
+    std::atomic<bool> used{ false };
+  };
+
+  struct retired_t
+  {
+    snapshot_t* snap;
+    uint64_t epoch;
+  };
+
+  static void destroy(snapshot_t* const s)
+  {
+    std::memset(static_cast<void*>(s), 0, sizeof(*s));
+    delete s;
+  }
+
+  size_t reclaim_locked()
+  {
+    if (retired.empty()) {
+      return 0;
+    }
+
+    writer_fence();
+
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < nslots; i++) {
+      const uint64_t e = slots[i].epoch.load(std::memory_order_acquire);
+      if (e != QUIESCENT) {
+        oldest = std::min(oldest, e);
+      }
+    }
+
+    // snapshot retired in epoch e can't be held by readers which entered in
+    // epoch e or later
+    std::vector<retired_t> keep;
+    for (const auto& r : retired) {
+      if (r.epoch <= oldest) {
+        destroy(r.snap);
+      } else {
+        keep.push_back(r);
+      }
+    }
+    retired = std::move(keep);
+
+    return retired.size();
+  }
+
+  std::unique_ptr<slot_t[]> slots;
+  const size_t nslots;
+
+  alignas(64) std::atomic<snapshot_t*> current{ nullptr };
+  std::atomic<uint64_t> epoch{ 1 };
+  std::atomic<uint64_t> cur_gen{ 1 };
+
+  alignas(64) std::mutex writer_mtx;
+  std::vector<retired_t> retired;
+};
+
+// Cipher text stamped with generation of key used for sealing it
+//
+// [ 8 -bytes little endian key generation ] [ M -bytes cipher text ]
+//
+// Generation isn't authenticated separately; a forged generation only selects
+// a different ( or no ) key, making tag check fail.
+constexpr size_t GEN_LEN = 8;
+
+// Encrypts M -bytes plain text using current key of holder, writing generation
+// stamped cipher text ( GEN_LEN + M -bytes ) to `enc`; returns generation used
+inline static uint64_t
+encrypt(const holder_t::reader_t& rd,
+        const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+        const uint8_t* const __restrict data,  // N -bytes associated data
+        const size_t dlen,                     // len(data) = N | >= 0
+        const uint8_t* const __restrict txt,   // M -bytes plain text
+        uint8_t* const __restrict enc,         // GEN_LEN + M -bytes
+        const size_t ctlen,                    // len(txt) = M | >= 0
+        uint8_t* const __restrict tag          // 64 -bit authentication tag
+)
+{
+  const auto snap = rd.lock();
+  const uint64_t gen = snap->gen;
+
+  for (size_t i = 0; i < GEN_LEN; i++) {
+    enc[i] = static_cast<uint8_t>(gen >> (i << 3));
+  }
+
+  grain_128aead::encrypt(
+    snap->key, nonce, data, dlen, txt, enc + GEN_LEN, ctlen, tag);
+  return gen;
+}
+
+// Decrypts generation stamped cipher text, using current or previous key of
+// holder, as selected by stamped generation; fails ( zeroing `txt` ) if
+// neither matches or authentication check fails
+inline static bool
+decrypt(const holder_t::reader_t& rd,
+        const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+        const uint8_t* const __restrict tag,   // 64 -bit authentication tag
+        const uint8_t* const __restrict data,  // N -bytes associated data
+        const size_t dlen,                     // len(data) = N | >= 0
+        const uint8_t* const __restrict enc,   // GEN_LEN + M -bytes
+        uint8_t* const __restrict txt,         // M -bytes decrypted text
+        const size_t ctlen                     // len(txt) = M | >= 0
+)
+{
+  uint64_t gen = 0;
+  for (size_t i = 0; i < GEN_LEN; i++) {
+    gen |= static_cast<uint64_t>(enc[i]) << (i << 3);
+  }
+
+  const auto snap = rd.lock();
+
+  const uint8_t* key = nullptr;
+  if (gen == snap->gen) {
+    key = snap->key;
+  } else if (snap->has_prev && gen == snap->prev_gen) {
+    key = snap->prev_key;
+  }
+
+  if (key == nullptr) {
+    std::memset(txt, 0, ctlen);
+    return false;
+  }
+
+  return grain_128aead::decrypt(
+    key, nonce, tag, data, dlen, enc + GEN_LEN, txt, ctlen);
+}
+
+}
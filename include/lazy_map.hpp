@@ -0,0 +1,442 @@
+#pragma once
+#include "grain_128aead.hpp"
+#include "worker_pool.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <linux/userfaultfd.h>
+#include <memory>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+// Missing from kernel headers older than Linux 5.11, which added it
+#if !defined UFFD_USER_MODE_ONLY
+#define UFFD_USER_MODE_ONLY 1
+#endif
+
+// Lazily decrypted memory mapping of files, sealed in page-granular,
+// independently authenticated layout, where pages are decrypted and verified
+// only on first access ( using userfaultfd ), so that cost scales with the
+// number of pages touched, instead of file size.
+namespace lazy_map {
+
+// Page-granular layout, with P -bytes pages, for M -bytes plain text
+//
+// [ cipher text of page 0 ] ... [ cipher text of page (n-1) ] [ n * 8 -bytes
+// authentication tags ]
+//
+// where n = ceil(M / P) and last page can be shorter than P -bytes. Page i is
+// sealed using nonce derived from base nonce and i ( see
+// `grain_128aead::derive_nonce` ), while 8 -bytes little endian encoded plain
+// text length is used as associated data, so that truncation or page swapping
+// across differently sized files is detected.
+
+// Number of pages, required for storing M -bytes plain text
+inline static constexpr size_t
+page_count(const size_t len, const size_t page)
+{
+  return (len + page - 1) / page;
+}
+
+// Byte length of sealed file, holding M -bytes plain text
+inline static constexpr size_t
+sealed_len(const size_t len, const size_t page)
+{
+  return len + page_count(len, page) * 8;
+}
+
+// Encodes M as 8 -bytes little endian associated data of each page
+inline static void
+encode_len(const size_t len, uint8_t* const data)
+{
+  for (size_t i = 0; i < 8; i++) {
+    data[i] = static_cast<uint8_t>(static_cast<uint64_t>(len) >> (i << 3));
+  }
+}
+
+// Seals M -bytes plain text into page-granular layout, where `sealed` must
+// have room for `sealed_len(M, P)` -bytes
+static void
+seal(const uint8_t* const __restrict key,   // 128 -bit secret key
+     const uint8_t* const __restrict nonce, // 96 -bit base nonce
+     const uint8_t* const __restrict txt,   // M -bytes plain text
+     const size_t len,                      // len(txt) = M | >= 0
+     const size_t page,                     // page size P | > 0
+     uint8_t* const __restrict sealed       // sealed_len(M, P) -bytes
+)
+{
+  const size_t cnt = page_count(len, page);
+
+  uint8_t data[8];
+  encode_len(len, data);
+
+  for (size_t i = 0; i < cnt; i++) {
+    const size_t off = i * page;
+    const size_t plen = std::min(page, len - off);
+
+    uint8_t pnonce[12];
+    grain_128aead::derive_nonce(nonce, i, pnonce);
+
+    uint8_t* const tag = sealed + len + i * 8;
+    grain_128aead::encrypt(
+      key, pnonce, data, 8, txt + off, sealed + off, plen, tag);
+  }
+}
+
+// Decrypts and verifies i -th page of sealed file into `txt`, which must have
+// room for P -bytes; bytes after end of ( last, short ) page are zeroed.
+// Returns false if authentication check fails, in which case `txt` is zeroed.
+static bool
+open_page(const uint8_t* const __restrict key,    // 128 -bit secret key
+          const uint8_t* const __restrict nonce,  // 96 -bit base nonce
+          const uint8_t* const __restrict sealed, // sealed file
+          const size_t len,                       // plain text length = M
+          const size_t page,                      // page size P | > 0
+          const size_t idx,                       // page index i
+          uint8_t* const __restrict txt           // P -bytes
+)
+{
+  const size_t off = idx * page;
+  const size_t plen = std::min(page, len - off);
+
+  uint8_t data[8];
+  encode_len(len, data);
+
+  std::memset(txt + plen, 0, page - plen);
+
+  uint8_t pnonce[12];
+  grain_128aead::derive_nonce(nonce, idx, pnonce);
+
+  const uint8_t* const tag = sealed + len + idx * 8;
+  return grain_128aead::decrypt(
+    key, pnonce, tag, data, 8, sealed + off, txt, plen);
+}
+
+// Callback type, invoked ( from fault handling/ read-ahead threads ) with index
+// of page, which failed authentication check ( or couldn't be installed ); such
+// pages are made inaccessible, see `map_t`.
+using fail_cb_t = void (*)(const size_t, void* const);
+
+// Memory mapping of sealed file, whose pages are decrypted and verified lazily
+// on first access. A fault handling thread resolves missing page faults of
+// mapped region ( by decrypting page and installing it with UFFDIO_COPY ),
+// while optionally asking worker threads to prepare `readahead` -many
+// following pages in background.
+//
+// Pages failing authentication check are never installed, neither as forged
+// plain text nor as zeros; instead they're made inaccessible ( PROT_NONE ), so
+// that accessing them raises SIGSEGV, after registered callback is invoked.
+//
+// Userfaultfd is opened with UFFD_USER_MODE_ONLY, so that it works for
+// unprivileged processes, which means only faults raised in user mode are
+// resolved. Kernel accessing a not yet decrypted page on behalf of the process
+// ( say write(2) or O_DIRECT I/O from mapped region ) fails with EFAULT, so
+// touch such pages ( or copy them out ) first.
+//
+// Page size P must be equal to system page size.
+struct map_t
+{
+  map_t() = default;
+  map_t(const map_t&) = delete;
+  map_t& operator=(const map_t&) = delete;
+
+  ~map_t() { close(); }
+
+  // Maps sealed file ( of `sealed_len(M, P)` -bytes ) `fd`, holding M -bytes
+  // plain text. Returns false if file is shorter than that ( touching mapping
+  // beyond end of file raises SIGBUS ), can't be mapped or userfaultfd is not
+  // available ( say it's disabled for unprivileged processes ).
+  bool open(const int fd,                          // sealed file
+            const uint8_t* const __restrict key,   // 128 -bit secret key
+            const uint8_t* const __restrict nonce, // 96 -bit base nonce
+            const size_t len,                      // plain text length M
+            const size_t readahead = 0,            // pages to read ahead
+            const size_t threads = 0,              // read-ahead workers
+            fail_cb_t cb = nullptr,                // authentication failure
+            void* const ctx = nullptr              // callback context
+  )
+  {
+    page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    plen = len;
+    pcnt = page_count(len, page);
+    ahead = readahead;
+    callback = cb;
+    user_ctx = ctx;
+
+    std::memcpy(skey, key, 16);
+    std::memcpy(snonce, nonce, 12);
+
+    if (pcnt == 0) {
+      return false;
+    }
+
+    slen = sealed_len(len, page);
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || sb.st_size < 0 ||
+        static_cast<uint64_t>(sb.st_size) < slen) {
+      return false;
+    }
+
+    void* src = mmap(nullptr, slen, PROT_READ, MAP_SHARED, fd, 0);
+    if (src == MAP_FAILED) {
+      return false;
+    }
+    sealed = static_cast<uint8_t*>(src);
+
+    mlen = pcnt * page;
+    void* dst = mmap(nullptr,
+                     mlen,
+                     PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS,
+                     -1,
+                     0);
+    if (dst == MAP_FAILED) {
+      close();
+      return false;
+    }
+    base = static_cast<uint8_t*>(dst);
+
+    const int flags = O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY;
+    uffd = static_cast<int>(syscall(SYS_userfaultfd, flags));
+    if (uffd < 0) {
+      close();
+      return false;
+    }
+
+    uffdio_api api{};
+    api.api = UFFD_API;
+    if (ioctl(uffd, UFFDIO_API, &api) < 0) {
+      close();
+      return false;
+    }
+
+    uffdio_register reg{};
+    reg.range.start = reinterpret_cast<uint64_t>(base);
+    reg.range.len = mlen;
+    reg.mode = UFFDIO_REGISTER_MODE_MISSING;
+    if (ioctl(uffd, UFFDIO_REGISTER, &reg) < 0) {
+      close();
+      return false;
+    }
+
+    // fault handler can't be stopped without it
+    stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd < 0) {
+      close();
+      return false;
+    }
+
+    states = std::make_unique<std::atomic<uint8_t>[]>(pcnt);
+
+    if (ahead > 0) {
+      pool = std::make_unique<worker_pool::pool_t>(threads);
+    }
+
+    handler = std::thread([this] { handle(); });
+    return true;
+  }
+
+  // Unmaps both plain text and sealed regions, after stopping fault handling
+  // and read-ahead threads
+  void close()
+  {
+    if (handler.joinable()) {
+      const uint64_t one = 1;
+      [[maybe_unused]] const ssize_t _ = write(stop_fd, &one, sizeof(one));
+
+      handler.join();
+    }
+
+    pool.reset();
+
+    if (stop_fd >= 0) {
+      ::close(stop_fd);
+      stop_fd = -1;
+    }
+    if (uffd >= 0) {
+      ::close(uffd);
+      uffd = -1;
+    }
+    if (base != nullptr) {
+      munmap(base, mlen);
+      base = nullptr;
+    }
+    if (sealed != nullptr) {
+      munmap(sealed, slen);
+      sealed = nullptr;
+    }
+
+    std::memset(skey, 0, sizeof(skey));
+  }
+
+  // Start of M -bytes plain text view
+  const uint8_t* data() const { return base; }
+
+  // Length of plain text view i.e. M
+  size_t size() const { return plen; }
+
+  // Number of pages decrypted so far ( on fault or by read-ahead )
+  size_t decrypted_pages() const
+  {
+    return decrypted.load(std::memory_order_relaxed);
+  }
+
+  // Number of pages, which failed authentication check ( or couldn't be
+  // installed ) so far
+  size_t failed_pages() const { return failed.load(std::memory_order_relaxed); }
+
+private:
+  // Page states, making sure each page is decrypted only once, either by fault
+  // handler or by a read-ahead worker
+  static constexpr uint8_t ABSENT = 0;
+  static constexpr uint8_t CLAIMED = 1;
+  static constexpr uint8_t PRESENT = 2;
+
+  // Fault handling loop, waiting for either a page fault or stop request
+  void handle()
+  {
+    pollfd fds[2]{ { uffd, POLLIN, 0 }, { stop_fd, POLLIN, 0 } };
+
+    while (true) {
+      if (poll(fds, 2, -1) < 0) {
+        continue;
+      }
+      if (fds[1].revents & POLLIN) {
+        return;
+      }
+
+      uffd_msg msg;
+      if (read(uffd, &msg, sizeof(msg)) != sizeof(msg)) {
+        continue;
+      }
+      if (msg.event != UFFD_EVENT_PAGEFAULT) {
+        continue;
+      }
+
+      const uint64_t addr = msg.arg.pagefault.address;
+      const size_t idx = (addr - reinterpret_cast<uint64_t>(base)) / page;
+
+      if (!populate(idx)) {
+        // page is being ( or already ) installed by some other thread, which
+        // wakes up faulting thread; waking it up again doesn't hurt
+        uffdio_range rng{};
+        rng.start = reinterpret_cast<uint64_t>(base) + idx * page;
+        rng.len = page;
+        ioctl(uffd, UFFDIO_WAKE, &rng);
+      }
+
+      for (size_t i = 1; (i <= ahead) && (idx + i < pcnt); i++) {
+        const size_t nidx = idx + i;
+        if (states[nidx].load(std::memory_order_relaxed) == ABSENT) {
+          pool->submit([this, nidx] { populate(nidx); });
+        }
+      }
+    }
+  }
+
+  // Decrypts and installs i -th page, if no other thread has claimed it yet;
+  // returns false if page was already claimed
+  bool populate(const size_t idx)
+  {
+    uint8_t exp = ABSENT;
+    if (!states[idx].compare_exchange_strong(exp, CLAIMED)) {
+      return false;
+    }
+
+    const uint64_t dst = reinterpret_cast<uint64_t>(base) + idx * page;
+    auto buf = static_cast<uint8_t*>(std::aligned_alloc(page, page));
+
+    bool ok = buf != nullptr;
+    ok = ok && open_page(skey, snonce, sealed, plen, page, idx, buf);
+
+    // counted before faulting thread is woken up
+    decrypted.fetch_add(1, std::memory_order_relaxed);
+    if (ok) {
+      ok = install(dst, buf);
+    }
+
+    if (!ok) {
+      failed.fetch_add(1, std::memory_order_relaxed);
+      if (callback != nullptr) {
+        callback(idx, user_ctx);
+      }
+
+      poison(dst);
+    }
+
+    if (buf != nullptr) {
+      std::memset(buf, 0, page);
+      std::free(buf);
+    }
+
+    states[idx].store(PRESENT, std::memory_order_release);
+    return true;
+  }
+
+  // Copies decrypted page into mapped region, waking up faulting thread(s);
+  // retries when kernel asks to. Returns false if page couldn't be installed.
+  bool install(const uint64_t dst, const uint8_t* const buf)
+  {
+    while (true) {
+      uffdio_copy cp{};
+      cp.dst = dst;
+      cp.src = reinterpret_cast<uint64_t>(buf);
+      cp.len = page;
+
+      if (ioctl(uffd, UFFDIO_COPY, &cp) == 0) {
+        return true;
+      }
+      if (errno != EAGAIN && errno != EINTR) {
+        return false;
+      }
+    }
+  }
+
+  // Makes page inaccessible and wakes up thread(s) faulting on it, which then
+  // get SIGSEGV, instead of hanging or reading unauthenticated bytes
+  void poison(const uint64_t dst)
+  {
+    mprotect(reinterpret_cast<void*>(dst), page, PROT_NONE);
+
+    uffdio_range rng{};
+    rng.start = dst;
+    rng.len = page;
+    ioctl(uffd, UFFDIO_WAKE, &rng);
+  }
+
+  uint8_t skey[16]{};
+  uint8_t snonce[12]{};
+
+  size_t page = 0;
+  size_t plen = 0;
+  size_t pcnt = 0;
+  size_t slen = 0;
+  size_t mlen = 0;
+  size_t ahead = 0;
+
+  uint8_t* sealed = nullptr;
+  uint8_t* base = nullptr;
+
+  int uffd = -1;
+  int stop_fd = -1;
+
+  fail_cb_t callback = nullptr;
+  void* user_ctx = nullptr;
+
+  std::unique_ptr<std::atomic<uint8_t>[]> states;
+  std::atomic<size_t> decrypted{ 0 };
+  std::atomic<size_t> failed{ 0 };
+
+  std::unique_ptr<worker_pool::pool_t> pool;
+  std::thread handler;
+};
+
+}
@@ -0,0 +1,218 @@
+#pragma once
+#include "kernels.hpp"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Bulk generation of post-initialization LFSR word sequence of Grain-128 AEAD
+//
+// Once cipher state is initialized, LFSR doesn't receive any key stream
+// feedback, so it's an autonomous linear recurrence; its future 32 -bit words
+// can be generated in bulk, ahead of ( and independent of ) NFSR and output
+// function computation, which only consume LFSR words.
+namespace lfsr_stream {
+
+// Given four consecutive 32 -bit words (w0, w1, w2, w3) of LFSR bit sequence,
+// computes next word w4, using L(St) = s0 + s7 + s38 + s70 + s81 + s96, for 32
+// consecutive clocks, in parallel ( generated kernel, see `kernels::lx32` )
+//
+// Works on scalars as well as on GCC/ Clang vector types.
+template<typename T>
+inline static T
+next_word(const T w0, const T w1, const T w2, const T w3)
+{
+  const T w[4]{ w0, w1, w2, w3 };
+  return kernels::lx32<T>(w);
+}
+
+// 128 x 128 matrix over GF(2), representing a linear map on 128 -bit LFSR state
+// ( as four little endian 32 -bit words ), stored column-wise, so that column
+// `i` is image of i -th unit vector
+struct matrix_t
+{
+  uint32_t cols[128][4];
+};
+
+// Computes r = m * v, over GF(2)
+inline static void
+apply(const matrix_t& m, const uint32_t* const v, uint32_t* const r)
+{
+  uint32_t acc[4]{};
+
+  for (size_t i = 0; i < 128; i++) {
+    const uint32_t bit = (v[i >> 5] >> (i & 31ul)) & 1u;
+    const uint32_t msk = 0u - bit;
+
+    acc[0] ^= m.cols[i][0] & msk;
+    acc[1] ^= m.cols[i][1] & msk;
+    acc[2] ^= m.cols[i][2] & msk;
+    acc[3] ^= m.cols[i][3] & msk;
+  }
+
+  std::memcpy(r, acc, sizeof(acc));
+}
+
+// Computes a * b, over GF(2), which first applies b and then a
+inline static matrix_t
+mul(const matrix_t& a, const matrix_t& b)
+{
+  matrix_t c{};
+
+  for (size_t i = 0; i < 128; i++) {
+    apply(a, b.cols[i], c.cols[i]);
+  }
+
+  return c;
+}
+
+// Matrix advancing LFSR state by one 32 -bit word i.e. by 32 clocks
+inline static matrix_t
+step_matrix()
+{
+  matrix_t m{};
+
+  for (size_t i = 0; i < 128; i++) {
+    uint32_t v[4]{};
+    v[i >> 5] = 1u << (i & 31ul);
+
+    m.cols[i][0] = v[1];
+    m.cols[i][1] = v[2];
+    m.cols[i][2] = v[3];
+    m.cols[i][3] = next_word(v[0], v[1], v[2], v[3]);
+  }
+
+  return m;
+}
+
+// Matrix advancing LFSR state by `words` -many 32 -bit words, computed using
+// square-and-multiply
+inline static matrix_t
+jump_matrix(const size_t words)
+{
+  matrix_t res{};
+  for (size_t i = 0; i < 128; i++) {
+    res.cols[i][i >> 5] = 1u << (i & 31ul);
+  }
+
+  matrix_t base = step_matrix();
+
+  for (size_t e = words; e > 0; e >>= 1) {
+    if (e & 1ul) {
+      res = mul(base, res);
+    }
+    base = mul(base, base);
+  }
+
+  return res;
+}
+
+// Generator of LFSR word sequence, producing `lanes * seg` -many consecutive
+// words per `fill` call.
+//
+// With lanes > 1, block of words is split into `lanes` -many segments of `seg`
+// words each, which are generated in parallel ( each lane runs the recurrence
+// from its own jumped-ahead state, so compiler can map lanes to SIMD
+// registers ). After a block, each lane jumps ahead by `(lanes - 1) * seg`
+// words, using precomputed GF(2) jump matrix, to reach start of its segment in
+// next block. With lanes = 1, it's a plain serial generator.
+template<const size_t lanes, const size_t seg>
+struct generator_t
+{
+  static_assert(std::has_single_bit(lanes), "Lane count must be 2^i");
+  static_assert(seg >= 4, "Segment must span LFSR state");
+
+  // Number of words produced by each call to `fill`
+  static constexpr size_t block = lanes * seg;
+
+  // Sets up generator so that first produced word is w[0], where w holds
+  // current ( post-initialization ) LFSR state as four 32 -bit words
+  explicit generator_t(const uint32_t* const w)
+  {
+    uint32_t v[4];
+    std::memcpy(v, w, sizeof(v));
+
+    for (size_t l = 0; l < lanes; l++) {
+      for (size_t j = 0; j < 4; j++) {
+        st[j][l] = v[j];
+      }
+
+      if constexpr (lanes > 1) {
+        apply(seg_jump(), v, v);
+      }
+    }
+  }
+
+  // Writes next `block` -many LFSR words to `out`
+  void fill(uint32_t* const __restrict out)
+  {
+    for (size_t j = 0; j < seg; j++) {
+#if defined __GNUC__
+#pragma GCC ivdep
+#endif
+      for (size_t l = 0; l < lanes; l++) {
+        const uint32_t w0 = st[0][l];
+        const uint32_t w1 = st[1][l];
+        const uint32_t w2 = st[2][l];
+        const uint32_t w3 = st[3][l];
+
+        out[l * seg + j] = w0;
+
+        st[0][l] = w1;
+        st[1][l] = w2;
+        st[2][l] = w3;
+        st[3][l] = next_word(w0, w1, w2, w3);
+      }
+    }
+
+    if constexpr (lanes > 1) {
+      jump(block_jump());
+    }
+  }
+
+private:
+  // Jump matrix, advancing a lane by one segment
+  static const matrix_t& seg_jump()
+  {
+    static const matrix_t m = jump_matrix(seg);
+    return m;
+  }
+
+  // Jump matrix, advancing a lane from end of its segment to start of its
+  // segment in next block
+  static const matrix_t& block_jump()
+  {
+    static const matrix_t m = jump_matrix((lanes - 1) * seg);
+    return m;
+  }
+
+  // Applies jump matrix to all lanes, in parallel
+  void jump(const matrix_t& m)
+  {
+    uint32_t acc[4][lanes]{};
+
+    for (size_t i = 0; i < 128; i++) {
+      const size_t wi = i >> 5;
+      const size_t bi = i & 31ul;
+
+#if defined __GNUC__
+#pragma GCC ivdep
+#endif
+      for (size_t l = 0; l < lanes; l++) {
+        const uint32_t msk = 0u - ((st[wi][l] >> bi) & 1u);
+
+        acc[0][l] ^= m.cols[i][0] & msk;
+        acc[1][l] ^= m.cols[i][1] & msk;
+        acc[2][l] ^= m.cols[i][2] & msk;
+        acc[3][l] ^= m.cols[i][3] & msk;
+      }
+    }
+
+    std::memcpy(st, acc, sizeof(st));
+  }
+
+  // LFSR state of each lane, in structure-of-arrays form
+  alignas(64) uint32_t st[4][lanes];
+};
+
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include "grain_128aead.hpp"
+#include <atomic>
+#include <memory>
+
+// Optional nonce-reuse detector, which can be placed in front of Grain-128 AEAD
+// encryption routine, for catching nonce generation bugs in debug/ canary
+// deployments
+namespace nonce_guard {
+
+// Callback type, invoked when ( key id, nonce ) pair being used for encryption
+// is suspected to be already used before. Last argument is user provided opaque
+// context pointer, which is passed to constructor of `filter_t`.
+//
+// Note, Bloom filter can produce false positives, so reported reuse is only a
+// suspicion, while actual reuse ( as long as it happened in current/ previous
+// generation of filter ) is never missed, modulo races during rotation.
+using reuse_cb_t = void (*)(const uint64_t,         // key id
+                            const uint8_t* const,   // 96 -bit nonce
+                            void* const             // user context
+);
+
+// Mixes 64 -bit input word, using finalizer of SplitMix64 PRNG
+//
+// See https://xorshift.di.unimi.it/splitmix64.c
+inline static constexpr uint64_t
+mix64(const uint64_t v)
+{
+  uint64_t z = v;
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ul;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebul;
+  z = z ^ (z >> 31);
+
+  return z;
+}
+
+// Computes 64 -bit hash of ( key id, 96 -bit nonce ) pair, which is used for
+// selecting shard, word and bit positions in Bloom filter
+inline static uint64_t
+hash(const uint64_t key_id, const uint8_t* const nonce)
+{
+  uint64_t n0 = 0ul;
+  uint32_t n1 = 0u;
+
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(&n0, nonce, 8);
+    std::memcpy(&n1, nonce + 8, 4);
+  } else {
+    n0 = grain_128::from_le_bytes<uint64_t>(nonce);
+    n1 = grain_128::from_le_bytes<uint32_t>(nonce + 8);
+  }
+
+  const uint64_t h0 = mix64(key_id ^ 0x9e3779b97f4a7c15ul);
+  const uint64_t h1 = mix64(h0 ^ n0);
+  const uint64_t h2 = mix64(h1 ^ static_cast<uint64_t>(n1));
+
+  return h2;
+}
+
+// Lock-free, sharded, blocked Bloom filter over ( key id, nonce ) pairs, with
+// bounded memory footprint of `shard_cnt * 3 * word_cnt * 8` -bytes.
+//
+// Each inserted pair sets 4 bits inside a single 64 -bit word of its shard, so
+// that both membership test and insertion happen using only one atomic
+// fetch-or. Each shard keeps three generations of bit array: active one, which
+// receives insertions, previous one, which is still consulted for lookups, and
+// a standby one, which is cleared a word at a time, by every `capacity /
+// word_cnt` -th inserter. After `capacity` many insertions into a shard,
+// standby generation ( now all clear ) becomes active, active one becomes
+// previous and previous one becomes standby. That way filter remembers at
+// least last `capacity` insertions per shard, while no inserter ever pays for
+// clearing a whole generation.
+//
+// Clearing & rotation are not synchronized with concurrent inserters, so an
+// insertion racing with rotation of same shard can be lost, which can only
+// result in a missed detection, never in a false report.
+template<const size_t shard_cnt = 64, const size_t word_cnt = 4096>
+struct filter_t
+{
+  static_assert(std::has_single_bit(shard_cnt), "Shard count must be 2^i");
+  static_assert(std::has_single_bit(word_cnt), "Word count must be 2^i");
+
+  // ~16 bits of filter per inserted element, keeping false positive rate of
+  // blocked Bloom filter ( with k = 4 ) under 1%
+  static constexpr size_t capacity = (word_cnt * 64) / 16;
+
+  // Number of insertions, per word of standby generation cleared
+  static constexpr size_t clear_stride = capacity / word_cnt;
+
+  filter_t(reuse_cb_t cb, void* const ctx)
+    : shards(std::make_unique<shard_t[]>(shard_cnt))
+    , callback(cb)
+    , user_ctx(ctx)
+  {}
+
+  // Checks whether ( key id, nonce ) pair is ( probably ) already seen, while
+  // inserting it into filter. Returns truth value if reuse is suspected, in
+  // which case registered callback is also invoked.
+  bool check_and_insert(const uint64_t key_id, const uint8_t* const nonce)
+  {
+    const uint64_t h = hash(key_id, nonce);
+
+    const size_t sidx = static_cast<size_t>(h) & (shard_cnt - 1);
+    const size_t widx = static_cast<size_t>(h >> 16) & (word_cnt - 1);
+
+    uint64_t mask = 0ul;
+    for (size_t i = 0; i < 4; i++) {
+      mask |= 1ul << ((h >> (40 + i * 6)) & 63ul);
+    }
+
+    shard_t& shard = shards[sidx];
+
+    const uint32_t cur = shard.active.load(std::memory_order_relaxed);
+    const uint32_t prv = (cur + 2u) % 3u;
+
+    const uint64_t old =
+      shard.gens[cur][widx].fetch_or(mask, std::memory_order_relaxed);
+    const uint64_t prev =
+      shard.gens[prv][widx].load(std::memory_order_relaxed);
+
+    const bool seen = ((old & mask) == mask) || ((prev & mask) == mask);
+
+    const uint64_t pos =
+      shard.inserted.fetch_add(1ul, std::memory_order_relaxed) % capacity;
+    if ((pos % clear_stride) == clear_stride - 1) {
+      const uint32_t stb = (cur + 1u) % 3u;
+      shard.gens[stb][pos / clear_stride].store(0ul, std::memory_order_relaxed);
+    }
+    if (pos == capacity - 1) {
+      shard.active.store((cur + 1u) % 3u, std::memory_order_release);
+    }
+
+    if (seen && (callback != nullptr)) {
+      callback(key_id, nonce, user_ctx);
+    }
+
+    return seen;
+  }
+
+private:
+  // Each shard lives on its own cache lines, so that inserters working on
+  // different shards don't contend with each other
+  struct alignas(64) shard_t
+  {
+    std::atomic<uint64_t> gens[3][word_cnt]{};
+    std::atomic<uint32_t> active{ 0u };
+    alignas(64) std::atomic<uint64_t> inserted{ 0ul };
+  };
+
+  std::unique_ptr<shard_t[]> shards;
+  reuse_cb_t callback;
+  void* user_ctx;
+};
+
+// Checks ( key id, nonce ) pair against nonce-reuse detector and then encrypts
+// M -bytes plain text using Grain-128 AEAD, see `grain_128aead::encrypt`.
+//
+// Note, suspected nonce reuse is only reported ( through callback registered
+// with filter ), encryption is still performed, so that enabling this guard
+// never changes behaviour of the application.
+template<const size_t shard_cnt, const size_t word_cnt>
+static void
+encrypt(filter_t<shard_cnt, word_cnt>& guard, // nonce-reuse detector
+        const uint64_t key_id, // identifies secret key, without exposing it
+        const uint8_t* const __restrict key,   // 128 -bit secret key
+        const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+        const uint8_t* const __restrict data,  // N -bytes associated data
+        const size_t dlen,                     // len(data) = N | >= 0
+        const uint8_t* const __restrict txt,   // M -bytes plain text
+        uint8_t* const __restrict enc,         // M -bytes encrypted text
+        const size_t ctlen,                    // len(txt) = len(enc) = M | >= 0
+        uint8_t* const __restrict tag          // 64 -bit authentication tag
+)
+{
+  guard.check_and_insert(key_id, nonce);
+  grain_128aead::encrypt(key, nonce, data, dlen, txt, enc, ctlen, tag);
+}
+
+}
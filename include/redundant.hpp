@@ -0,0 +1,468 @@
+#pragma once
+#include "grain_128aead.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#include <vector>
+
+// Sampled redundant computation, for catching silently corrupting ( mercurial )
+// CPU cores, before they corrupt stored data: a configurable fraction of
+// `grain_128aead::encrypt` calls is re-computed, using an independent byte
+// oriented kernel, on another core, and mismatching cipher text/ tag is
+// reported along with id of core, which produced it.
+namespace redundant {
+
+// Clocks cipher 16 times, 8 bits at a time ( without any 32 -bit word kernel ),
+// returning ( even, odd ) bytes of pre-output generator
+inline static std::pair<uint8_t, uint8_t>
+clock16(grain_128::state_t* const st)
+{
+  uint8_t y[2];
+
+  for (size_t i = 0; i < 2; i++) {
+    y[i] = grain_128::ksb(st);
+
+    const uint8_t s120 = grain_128::l(st);
+    const uint8_t b120 = grain_128::f(st);
+
+    grain_128::update_lfsr(st, s120);
+    grain_128::update_nfsr(st, b120);
+  }
+
+  return aead::split_bits<uint8_t>(y[0], y[1]);
+}
+
+// Reference Grain-128 AEAD encryption, producing same output as
+// `grain_128aead::encrypt`, while only using 8 -bit kernels of `grain_128`,
+// for both initialization & message processing, so that it shares none of the
+// 32 -bit ( generated ) kernels with fast path
+static void
+reference_encrypt(
+  const uint8_t* const __restrict key,   // 128 -bit secret key
+  const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+  const uint8_t* const __restrict data,  // N -bytes associated data
+  const size_t dlen,                     // len(data) = N | >= 0
+  const uint8_t* const __restrict txt,   // M -bytes plain text
+  uint8_t* const __restrict enc,         // M -bytes encrypted text
+  const size_t ctlen,                    // len(txt) = len(enc) = M | >= 0
+  uint8_t* const __restrict tag          // 64 -bit authentication tag
+)
+{
+  grain_128::state_t st;
+
+  std::memcpy(st.nfsr, key, 16);
+  std::memcpy(st.lfsr, nonce, 12);
+  std::memset(st.lfsr + 12, 0xff, 3);
+  st.lfsr[15] = 0x7f;
+
+  // 384 initialization clocks, re-introducing key in last 64 of them
+  for (size_t t = 0; t < 48; t++) {
+    const uint8_t yt = grain_128::ksb(&st);
+
+    const uint8_t ka = t >= 40 ? key[t - 32] : 0;
+    const uint8_t kb = t >= 40 ? key[t - 40] : 0;
+
+    const uint8_t s120 = grain_128::l(&st);
+    const uint8_t b120 = grain_128::f(&st);
+
+    grain_128::update_lfsr(&st, s120 ^ yt ^ ka);
+    grain_128::update_nfsr(&st, b120 ^ yt ^ kb);
+  }
+
+  // 128 clocks, filling accumulator & shift register
+  for (size_t t = 0; t < 16; t++) {
+    const uint8_t yt = grain_128::ksb(&st);
+
+    if (t < 8) {
+      st.acc[t] = yt;
+    } else {
+      st.sreg[t - 8] = yt;
+    }
+
+    const uint8_t s120 = grain_128::l(&st);
+    const uint8_t b120 = grain_128::f(&st);
+
+    grain_128::update_lfsr(&st, s120);
+    grain_128::update_nfsr(&st, b120);
+  }
+
+  uint8_t der[9];
+  const size_t der_len = aead::encode_der(dlen, der);
+
+  for (size_t i = 0; i < der_len; i++) {
+    const auto y = clock16(&st);
+    grain_128::authenticate<uint8_t>(&st, der[i], y.second);
+  }
+
+  for (size_t i = 0; i < dlen; i++) {
+    const auto y = clock16(&st);
+    grain_128::authenticate<uint8_t>(&st, data[i], y.second);
+  }
+
+  for (size_t i = 0; i < ctlen; i++) {
+    const auto y = clock16(&st);
+    enc[i] = txt[i] ^ y.first;
+    grain_128::authenticate<uint8_t>(&st, txt[i], y.second);
+  }
+
+  aead::auth_padding_bit(&st);
+
+  std::memcpy(tag, st.acc, 8);
+}
+
+// Reported, when fast path output differs from reference output
+struct mismatch_t
+{
+  int core = -1;         // core, on which fast path ran ( -1 if unknown )
+  int check_core = -1;   // core, on which reference computation ran
+  size_t checker = 0;    // index of checker thread, which ran it
+  bool migrated = false; // caller moved across cores, during fast path
+  size_t dlen = 0;
+  size_t ctlen = 0;
+  size_t offset = 0; // first differing cipher text byte, = ctlen if only tag
+};
+
+struct config_t
+{
+  double fraction = 1e-3; // fraction of calls to be re-computed | [0, 1]
+  std::vector<size_t> cores{}; // cores of checker threads; two highest
+                               // numbered ones, if empty
+  size_t max_queued = 256;     // samples waiting for check, beyond which new
+                               // samples are dropped
+};
+
+struct stats_t
+{
+  uint64_t calls = 0;      // calls to `checker_t::encrypt`
+  uint64_t sampled = 0;    // calls picked for re-computation
+  uint64_t dropped = 0;    // samples dropped, as checkers were lagging behind
+  uint64_t checked = 0;    // samples re-computed
+  uint64_t mismatches = 0; // samples whose outputs didn't match
+};
+
+// Encrypts using `grain_128aead::encrypt`, copying inputs & outputs of sampled
+// calls to a queue, drained by checker threads pinned to dedicated cores, which
+// re-compute them using `reference_encrypt`. Sampled calls are spread
+// round-robin over checkers pinned to cores other than caller's ( or over all
+// of them, if there's none such ).
+//
+// Non-sampled calls only pay for one xorshift step; sampled ones additionally
+// copy inputs & outputs and are dropped ( never waited on ) when `max_queued`
+// samples are already pending, so that overhead stays bounded by sampling
+// fraction. Mismatches are reported to callback, on checker thread.
+class checker_t
+{
+public:
+  using report_t = std::function<void(const mismatch_t&)>;
+
+  checker_t(const config_t& cfg, report_t report)
+    : max_queued(std::max<size_t>(cfg.max_queued, 1))
+    , report(std::move(report))
+  {
+    const double f = std::min(std::max(cfg.fraction, 0.), 1.);
+    always = f >= 1.;
+    threshold = static_cast<uint64_t>(
+      std::min(std::ldexp(f, 64), 18446744073709549568.)); // < 2^64
+
+    std::vector<size_t> cores = cfg.cores;
+    if (cores.empty()) {
+      const size_t n = std::max(std::thread::hardware_concurrency(), 1u);
+      cores.push_back(n - 1);
+      if (n > 1) {
+        cores.push_back(n - 2);
+      }
+    }
+
+    for (const size_t c : cores) {
+      checkers.emplace_back(std::make_unique<lane_t>());
+      checkers.back()->idx = checkers.size() - 1;
+      checkers.back()->core = static_cast<int>(c);
+    }
+    for (auto& c : checkers) {
+      c->thread = std::thread([this, l = c.get()] { run(l); });
+    }
+  }
+
+  checker_t(const checker_t&) = delete;
+  checker_t& operator=(const checker_t&) = delete;
+
+  ~checker_t()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stop = true;
+    }
+    for (auto& c : checkers) {
+      c->cv.notify_all();
+    }
+    for (auto& c : checkers) {
+      c->thread.join();
+    }
+  }
+
+  // Same as `grain_128aead::encrypt`, while re-computing sampled calls
+  void encrypt(const uint8_t* const __restrict key,
+               const uint8_t* const __restrict nonce,
+               const uint8_t* const __restrict data,
+               const size_t dlen,
+               const uint8_t* const __restrict txt,
+               uint8_t* const __restrict enc,
+               const size_t ctlen,
+               uint8_t* const __restrict tag)
+  {
+    calls.fetch_add(1, std::memory_order_relaxed);
+
+    if (!sample()) {
+      grain_128aead::encrypt(key, nonce, data, dlen, txt, enc, ctlen, tag);
+      return;
+    }
+
+    const int core = sched_getcpu();
+    grain_128aead::encrypt(key, nonce, data, dlen, txt, enc, ctlen, tag);
+    const int core_after = sched_getcpu();
+
+    sampled.fetch_add(1, std::memory_order_relaxed);
+    enqueue(key, nonce, data, dlen, txt, enc, ctlen, tag, core, core_after);
+  }
+
+  // Queues output of an already computed encryption ( say, by some other
+  // kernel ) for re-computation, no matter sampling fraction; core reported on
+  // mismatch is calling one. Dropped if `max_queued` samples are pending.
+  void verify(const uint8_t* const __restrict key,
+              const uint8_t* const __restrict nonce,
+              const uint8_t* const __restrict data,
+              const size_t dlen,
+              const uint8_t* const __restrict txt,
+              const uint8_t* const __restrict enc,
+              const size_t ctlen,
+              const uint8_t* const __restrict tag)
+  {
+    const int core = sched_getcpu();
+    enqueue(key, nonce, data, dlen, txt, enc, ctlen, tag, core, core);
+  }
+
+  // Blocks until all queued samples are checked
+  void drain()
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    done_cv.wait(lock, [this] {
+      return queued.load(std::memory_order_acquire) == 0;
+    });
+  }
+
+  stats_t stats() const
+  {
+    stats_t s;
+    s.calls = calls.load(std::memory_order_relaxed);
+    s.sampled = sampled.load(std::memory_order_relaxed);
+    s.dropped = dropped.load(std::memory_order_relaxed);
+    s.checked = checked.load(std::memory_order_relaxed);
+    s.mismatches = mismatches.load(std::memory_order_relaxed);
+    return s;
+  }
+
+private:
+  struct sample_t
+  {
+    uint8_t key[16];
+    uint8_t nonce[12];
+    uint8_t tag[8];
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> txt;
+    std::vector<uint8_t> enc;
+    int core;
+    bool migrated;
+  };
+
+  // Checker thread, pinned to a core, with its own sample queue
+  struct lane_t
+  {
+    size_t idx = 0;
+    int core = -1;
+    std::deque<sample_t> samples;
+    std::condition_variable cv;
+    std::thread thread;
+  };
+
+  // Copies inputs & outputs of a call to queue of a checker, unless too many
+  // samples are pending
+  void enqueue(const uint8_t* const __restrict key,
+               const uint8_t* const __restrict nonce,
+               const uint8_t* const __restrict data,
+               const size_t dlen,
+               const uint8_t* const __restrict txt,
+               const uint8_t* const __restrict enc,
+               const size_t ctlen,
+               const uint8_t* const __restrict tag,
+               const int core,
+               const int core_after)
+  {
+    if (queued.fetch_add(1, std::memory_order_acq_rel) >= max_queued) {
+      queued.fetch_sub(1, std::memory_order_acq_rel);
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    sample_t s;
+    std::memcpy(s.key, key, 16);
+    std::memcpy(s.nonce, nonce, 12);
+    std::memcpy(s.tag, tag, 8);
+    s.data.assign(data, data + dlen);
+    s.txt.assign(txt, txt + ctlen);
+    s.enc.assign(enc, enc + ctlen);
+    s.core = core;
+    s.migrated = core != core_after;
+
+    lane_t& l = pick(core);
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      l.samples.push_back(std::move(s));
+    }
+    l.cv.notify_one();
+  }
+
+  // Per-thread xorshift64 step, deciding whether to sample this call
+  bool sample() const
+  {
+    if (always) {
+      return true;
+    }
+
+    static thread_local uint64_t x =
+      reinterpret_cast<uintptr_t>(&x) ^ 0x9e3779b97f4a7c15ul;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+
+    return x < threshold;
+  }
+
+  // Next checker, in round-robin order, among those pinned to a core other
+  // than given one ( or among all of them, if there's none such )
+  lane_t& pick(const int core)
+  {
+    const size_t n = checkers.size();
+    const size_t turn = next_lane.fetch_add(1, std::memory_order_relaxed);
+
+    size_t eligible = 0;
+    for (const auto& c : checkers) {
+      eligible += c->core != core;
+    }
+    if (eligible == 0) {
+      return *checkers[turn % n];
+    }
+
+    size_t k = turn % eligible;
+    for (auto& c : checkers) {
+      if (c->core != core && k-- == 0) {
+        return *c;
+      }
+    }
+    return *checkers.front();
+  }
+
+  void run(lane_t* const l)
+  {
+    const size_t ncores = std::max(std::thread::hardware_concurrency(), 1u);
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<size_t>(l->core) % ncores, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    while (true) {
+      sample_t s;
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        l->cv.wait(lock, [&] { return stop || !l->samples.empty(); });
+
+        if (l->samples.empty()) {
+          return;
+        }
+
+        s = std::move(l->samples.front());
+        l->samples.pop_front();
+      }
+
+      check(s, l->idx);
+      std::memset(s.key, 0, sizeof(s.key));
+
+      checked.fetch_add(1, std::memory_order_relaxed);
+
+      std::lock_guard<std::mutex> lock(mtx);
+      if (queued.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        done_cv.notify_all();
+      }
+    }
+  }
+
+  void check(const sample_t& s, const size_t idx)
+  {
+    const size_t ctlen = s.txt.size();
+
+    std::vector<uint8_t> enc(ctlen);
+    uint8_t tag[8];
+
+    reference_encrypt(s.key,
+                      s.nonce,
+                      s.data.data(),
+                      s.data.size(),
+                      s.txt.data(),
+                      enc.data(),
+                      ctlen,
+                      tag);
+
+    size_t off = 0;
+    while (off < ctlen && enc[off] == s.enc[off]) {
+      off++;
+    }
+
+    if (off == ctlen && std::memcmp(tag, s.tag, 8) == 0) {
+      return;
+    }
+
+    mismatches.fetch_add(1, std::memory_order_relaxed);
+
+    mismatch_t m;
+    m.core = s.core;
+    m.check_core = sched_getcpu();
+    m.checker = idx;
+    m.migrated = s.migrated;
+    m.dlen = s.data.size();
+    m.ctlen = ctlen;
+    m.offset = off;
+
+    if (report) {
+      report(m);
+    }
+  }
+
+  const size_t max_queued;
+  report_t report;
+  bool always = false;
+  uint64_t threshold = 0;
+
+  std::atomic<uint64_t> calls{ 0 };
+  std::atomic<uint64_t> sampled{ 0 };
+  std::atomic<uint64_t> dropped{ 0 };
+  std::atomic<uint64_t> checked{ 0 };
+  std::atomic<uint64_t> mismatches{ 0 };
+  std::atomic<size_t> queued{ 0 };
+  std::atomic<size_t> next_lane{ 0 };
+
+  std::mutex mtx;
+  std::condition_variable done_cv;
+  bool stop = false;
+  std::vector<std::unique_ptr<lane_t>> checkers;
+};
+
+}
@@ -0,0 +1,455 @@
+#pragma once
+#include "grain_128aead.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// In-memory object cache, keeping cold values sealed with Grain-128 AEAD, while
+// a bounded, LRU managed hot set of values is kept decrypted, so that
+// decryption cost is only paid for values entering working set.
+namespace sealed_cache {
+
+// Sealed values up to this many bytes are decrypted right in place, while
+// holding cache lock, as for them, Grain-128 AEAD initialization dominates and
+// re-validating entry after dropping lock would cost about as much
+constexpr size_t SMALL_LEN = 256;
+
+// Value, as kept at rest, sealed under nonce derived from base nonce and a
+// per-seal id ( see `grain_128aead::derive_nonce` ), with cache key as
+// associated data, so that sealed values can't be swapped across keys
+struct sealed_t
+{
+  uint64_t id = 0;
+  std::vector<uint8_t> enc;
+  uint8_t tag[8]{};
+};
+
+// Counters of cache activity
+struct stats_t
+{
+  uint64_t hot_hits = 0;      // lookups served from hot set
+  uint64_t cold_hits = 0;     // lookups which had to decrypt a sealed value
+  uint64_t misses = 0;        // lookups of absent keys
+  uint64_t seals = 0;         // values sealed ( on becoming cold )
+  uint64_t auth_failures = 0; // sealed values failing authentication check
+};
+
+// Cache of byte string values, keyed by strings.
+//
+// Values enter hot set on `put`/ `get`; once hot set holds more than `hot_cap`
+// values, least recently used ones become cold and get queued for sealing,
+// which is done in batches of `batch` values by a background thread ( or by
+// `flush` ). Queued values, which are looked up before being sealed, are simply
+// moved back to hot set.
+//
+// Each seal uses a fresh id, so a value is never sealed twice under same nonce;
+// base nonce must be unique for each cache instance using same key.
+class cache_t
+{
+public:
+  cache_t(const uint8_t* const __restrict key,   // 128 -bit secret key
+          const uint8_t* const __restrict nonce, // 96 -bit base nonce
+          const size_t hot_cap,                  // max decrypted values
+          const size_t batch = 64,               // values sealed per batch
+          const bool background = true           // seal on background thread
+          )
+    : hot_cap(hot_cap)
+    , batch(std::max<size_t>(batch, 1))
+  {
+    std::memcpy(skey, key, 16);
+    std::memcpy(bnonce, nonce, 12);
+
+    if (background) {
+      sealer = std::thread([this] { seal_loop(); });
+    }
+  }
+
+  cache_t(const cache_t&) = delete;
+  cache_t& operator=(const cache_t&) = delete;
+
+  ~cache_t()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stop = true;
+    }
+    cv.notify_all();
+
+    if (sealer.joinable()) {
+      sealer.join();
+    }
+
+    for (auto& kv : map) {
+      wipe(kv.second.plain);
+    }
+    std::memset(skey, 0, sizeof(skey));
+  }
+
+  // Inserts or replaces value of given key, which enters hot set
+  void put(const std::string& k, const uint8_t* const val, const size_t len)
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    entry_t& e = map[k];
+    wipe(e.plain);
+    e.plain.assign(val, val + len);
+    e.sealed.reset();
+    e.version++;
+    make_hot(k, e);
+
+    evict();
+  }
+
+  // Looks up value of given key, copying it to `out`; cold values are
+  // decrypted & verified ( larger ones without holding cache lock ) and move to
+  // hot set.
+  // Returns false if key is absent or its sealed value fails authentication.
+  bool get(const std::string& k, std::vector<uint8_t>& out)
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+
+    auto it = map.find(k);
+    if (it == map.end()) {
+      stat.misses++;
+      return false;
+    }
+
+    entry_t& e = it->second;
+
+    if (e.state != COLD) {
+      stat.hot_hits++;
+      make_hot(k, e);
+      out.assign(e.plain.begin(), e.plain.end());
+      evict();
+      return true;
+    }
+
+    if (e.sealed->enc.size() <= SMALL_LEN) {
+      std::vector<uint8_t> plain(e.sealed->enc.size());
+      if (!open(k, *e.sealed, plain.data())) {
+        stat.auth_failures++;
+        return false;
+      }
+
+      stat.cold_hits++;
+      out.assign(plain.begin(), plain.end());
+      e.plain = std::move(plain);
+      e.sealed.reset();
+      make_hot(k, e);
+      evict();
+      return true;
+    }
+
+    const auto sealed = e.sealed;
+    const uint64_t version = e.version;
+    lock.unlock();
+
+    std::vector<uint8_t> plain(sealed->enc.size());
+    if (!open(k, *sealed, plain.data())) {
+      lock.lock();
+      stat.auth_failures++;
+      return false;
+    }
+
+    out.assign(plain.begin(), plain.end());
+
+    lock.lock();
+    stat.cold_hits++;
+
+    // promote, unless value changed/ got removed meanwhile
+    it = map.find(k);
+    if (it != map.end() && it->second.version == version &&
+        it->second.state == COLD) {
+      entry_t& en = it->second;
+      en.plain = std::move(plain);
+      en.sealed.reset();
+      make_hot(k, en);
+      evict();
+    } else {
+      wipe(plain);
+    }
+
+    return true;
+  }
+
+  // Removes key, returning whether it was present
+  bool erase(const std::string& k)
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    auto it = map.find(k);
+    if (it == map.end()) {
+      return false;
+    }
+
+    if (it->second.state == HOT) {
+      lru.erase(it->second.pos);
+    }
+    queued -= it->second.state == PENDING;
+    wipe(it->second.plain);
+    map.erase(it);
+
+    return true;
+  }
+
+  // Copies sealed value of given key ( say, for spilling it to storage );
+  // returns false if key is absent or its value isn't sealed
+  bool get_sealed(const std::string& k, sealed_t& out) const
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    const auto it = map.find(k);
+    if (it == map.end() || it->second.state != COLD) {
+      return false;
+    }
+
+    out = *it->second.sealed;
+    return true;
+  }
+
+  // Inserts or replaces value of given key with a sealed one ( as obtained
+  // from `get_sealed` ), which is opened & verified only when looked up
+  void put_sealed(const std::string& k, const sealed_t& s)
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    entry_t& e = map[k];
+    if (e.state == HOT) {
+      lru.erase(e.pos);
+    }
+    queued -= e.state == PENDING;
+
+    wipe(e.plain);
+    e.sealed = std::make_shared<const sealed_t>(s);
+    e.state = COLD;
+    e.version++;
+  }
+
+  // Seals all values queued for sealing, on calling thread
+  void flush()
+  {
+    while (seal_batch(std::numeric_limits<size_t>::max()) > 0) {
+    }
+  }
+
+  // Number of values, kept decrypted ( hot or queued for sealing )
+  size_t decrypted() const
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    return lru.size() + queued;
+  }
+
+  // Number of values kept sealed
+  size_t sealed() const
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    return map.size() - lru.size() - queued;
+  }
+
+  stats_t stats() const
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    return stat;
+  }
+
+private:
+  enum state_t : uint8_t
+  {
+    HOT,     // decrypted, in LRU list
+    PENDING, // decrypted, queued for sealing
+    COLD     // sealed
+  };
+
+  struct entry_t
+  {
+    std::vector<uint8_t> plain;
+    std::shared_ptr<const sealed_t> sealed;
+    state_t state = COLD;
+    uint64_t version = 0;
+    std::list<std::string>::iterator pos;
+  };
+
+  // Value queued for sealing, copied out of cache, so that sealing runs
+  // without holding cache lock
+  struct job_t
+  {
+    std::string key;
+    uint64_t version;
+    std::vector<uint8_t> plain;
+    std::shared_ptr<sealed_t> sealed;
+  };
+
+  static void wipe(std::vector<uint8_t>& v)
+  {
+    std::fill(v.begin(), v.end(), 0);
+    v.clear();
+    v.shrink_to_fit();
+  }
+
+  // Moves entry to front of LRU list ( inserting it, if not hot )
+  void make_hot(const std::string& k, entry_t& e)
+  {
+    if (e.state == HOT) {
+      lru.splice(lru.begin(), lru, e.pos);
+      return;
+    }
+
+    queued -= e.state == PENDING;
+    lru.push_front(k);
+    e.pos = lru.begin();
+    e.state = HOT;
+  }
+
+  // Moves least recently used values out of hot set, while it's over capacity
+  void evict()
+  {
+    bool wake = false;
+
+    while (lru.size() > hot_cap) {
+      const std::string k = std::move(lru.back());
+      lru.pop_back();
+
+      entry_t& e = map[k];
+      e.state = PENDING;
+      pending.push_back(k);
+      queued++;
+
+      wake |= pending.size() >= batch;
+    }
+
+    if (wake) {
+      cv.notify_one();
+    }
+  }
+
+  bool open(const std::string& k, const sealed_t& s, uint8_t* const out) const
+  {
+    uint8_t nonce[12];
+    grain_128aead::derive_nonce(bnonce, s.id, nonce);
+
+    const auto ad = reinterpret_cast<const uint8_t*>(k.data());
+    return grain_128aead::decrypt(
+      skey, nonce, s.tag, ad, k.size(), s.enc.data(), out, s.enc.size());
+  }
+
+  // Seals up to `max` -many queued values, returning how many were taken from
+  // queue
+  size_t seal_batch(const size_t max)
+  {
+    std::vector<job_t> jobs;
+    size_t taken = 0;
+
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      while (!pending.empty() && taken < max) {
+        const std::string k = std::move(pending.front());
+        pending.pop_front();
+        taken++;
+
+        auto it = map.find(k);
+        if (it == map.end() || it->second.state != PENDING) {
+          continue; // removed or moved back to hot set
+        }
+
+        job_t j;
+        j.key = k;
+        j.version = it->second.version;
+        j.plain = it->second.plain;
+        j.sealed = std::make_shared<sealed_t>();
+        j.sealed->id = next_id++;
+        jobs.push_back(std::move(j));
+      }
+    }
+
+    for (auto& j : jobs) {
+      uint8_t nonce[12];
+      grain_128aead::derive_nonce(bnonce, j.sealed->id, nonce);
+
+      const auto ad = reinterpret_cast<const uint8_t*>(j.key.data());
+      j.sealed->enc.resize(j.plain.size());
+      grain_128aead::encrypt(skey,
+                             nonce,
+                             ad,
+                             j.key.size(),
+                             j.plain.data(),
+                             j.sealed->enc.data(),
+                             j.plain.size(),
+                             j.sealed->tag);
+      wipe(j.plain);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      for (auto& j : jobs) {
+        auto it = map.find(j.key);
+        if (it == map.end() || it->second.version != j.version ||
+            it->second.state != PENDING) {
+          continue;
+        }
+
+        entry_t& e = it->second;
+        wipe(e.plain);
+        e.sealed = std::move(j.sealed);
+        e.state = COLD;
+        queued--;
+        stat.seals++;
+      }
+    }
+
+    return taken;
+  }
+
+  // Background sealing loop, sealing full batches as soon as they're queued and
+  // partial ones after a short delay
+  void seal_loop()
+  {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait_for(lock, std::chrono::milliseconds(10), [this] {
+          return stop || pending.size() >= batch;
+        });
+
+        if (stop) {
+          return;
+        }
+        if (pending.empty()) {
+          continue;
+        }
+      }
+
+      seal_batch(batch);
+    }
+  }
+
+  uint8_t skey[16]{};
+  uint8_t bnonce[12]{};
+  const size_t hot_cap;
+  const size_t batch;
+
+  mutable std::mutex mtx;
+  std::condition_variable cv;
+  bool stop = false;
+
+  std::unordered_map<std::string, entry_t> map;
+  std::list<std::string> lru;
+  std::deque<std::string> pending;
+  size_t queued = 0;
+  uint64_t next_id = 0;
+  stats_t stat;
+
+  std::thread sealer;
+};
+
+}
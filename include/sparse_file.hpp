@@ -0,0 +1,103 @@
+#pragma once
+#include "grain_128aead.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+// Sparse file aware Grain-128 AEAD encryption, which never reads holes of input
+// file ( as reported by SEEK_DATA/ SEEK_HOLE ) and skips accumulator updates
+// for all-zero regions
+namespace sparse_file {
+
+// Finds start of next data region at or after `off`, returning `flen` when
+// rest of the file is a hole. Filesystems not supporting SEEK_DATA report whole
+// file as data.
+inline static size_t
+next_data(const int fd, const size_t off, const size_t flen)
+{
+  const off_t pos = lseek(fd, static_cast<off_t>(off), SEEK_DATA);
+
+  if (pos < 0) {
+    return errno == ENXIO ? flen : off;
+  }
+
+  return std::min(static_cast<size_t>(pos), flen);
+}
+
+// Encrypts first `flen` -bytes of file `in_fd` into file `out_fd` ( at same
+// offsets ), using Grain-128 AEAD, while computing 8 -bytes authentication tag,
+// which is bit-identical to what `grain_128aead::encrypt` computes over file
+// content.
+//
+// File is processed in chunks of `chunk` -bytes ( must be multiple of 4 ).
+// Chunks lying inside holes of input file are never read, their cipher text is
+// key stream itself; data chunks are read and encrypted using sparse-aware
+// path, which still skips accumulator work for all-zero pages.
+//
+// Returns false if reading/ writing any chunk fails, in which case tag and
+// written cipher text must not be used.
+//
+// Note, execution time leaks location of holes and all-zero pages.
+static bool
+encrypt(const uint8_t* const __restrict key,   // 128 -bit secret key
+        const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+        const uint8_t* const __restrict data,  // N -bytes associated data
+        const size_t dlen,                     // len(data) = N | >= 0
+        const int in_fd,                       // plain text file
+        const int out_fd,                      // encrypted text file
+        const size_t flen,                     // bytes to encrypt | >= 0
+        uint8_t* const __restrict tag,         // 64 -bit authentication tag
+        const size_t chunk = 1ul << 20         // chunk size | multiple of 4
+)
+{
+  if ((chunk == 0) || ((chunk & 3ul) != 0)) {
+    return false;
+  }
+
+  std::vector<uint8_t> txt(chunk);
+  std::vector<uint8_t> enc(chunk);
+
+  grain_128::state_t st;
+
+  aead::initialize(&st, key, nonce);
+  aead::auth_associated_data(&st, data, dlen);
+
+  size_t off = 0;
+  while (off < flen) {
+    size_t len = std::min(chunk, flen - off);
+
+    const size_t doff = next_data(in_fd, off, flen);
+    const size_t hlen = (doff - off) & ~3ul;
+
+    // Only last chunk can have length not being multiple of 4, so that word
+    // oriented encryption of consecutive chunks stays aligned
+    const bool hole = (doff >= off + len) || (hlen > 0);
+
+    if (hole) {
+      len = doff >= off + len ? len : hlen;
+      aead::enc_and_auth_zeros(&st, enc.data(), len);
+    } else {
+      const ssize_t rd = pread(in_fd, txt.data(), len, static_cast<off_t>(off));
+      if (rd != static_cast<ssize_t>(len)) {
+        return false;
+      }
+
+      aead::enc_and_auth_sparse_txt(&st, txt.data(), enc.data(), len);
+    }
+
+    const ssize_t wr = pwrite(out_fd, enc.data(), len, static_cast<off_t>(off));
+    if (wr != static_cast<ssize_t>(len)) {
+      return false;
+    }
+
+    off += len;
+  }
+
+  aead::auth_padding_bit(&st);
+  std::memcpy(tag, st.acc, 8);
+
+  return true;
+}
+
+}
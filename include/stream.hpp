@@ -0,0 +1,407 @@
+#pragma once
+#include "checksum.hpp"
+#include "grain_128aead.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Incremental ( streaming ) Grain-128 AEAD, where associated data & plain/
+// cipher text are fed in arbitrary sized pieces, and whose in-progress context
+// can be exported into a compact, versioned, integrity checked blob, for
+// resuming the stream in another process ( say, when migrating a live
+// connection across workers ), without a fresh nonce & re-initialization.
+namespace stream {
+
+// Whether context encrypts or decrypts
+enum class dir_t : uint8_t
+{
+  ENCRYPT = 1,
+  DECRYPT = 2
+};
+
+// Phase of a streaming context
+enum class phase_t : uint8_t
+{
+  AD = 1,   // expecting associated data
+  TEXT = 2, // expecting plain/ cipher text
+  DONE = 3, // finalized, or exported ( moved out )
+};
+
+// Declared text length, when it isn't known upfront, so that it's not enforced
+constexpr uint64_t UNBOUNDED = ~0ul;
+
+// In-progress streaming context; lengths of associated data & text are
+// declared upfront, as DER encoded associated data length is authenticated
+// first, and are enforced while feeding data ( text length can be declared as
+// `UNBOUNDED` ).
+//
+// Pieces of any length can be fed: whole 32 -bit words go through word
+// kernels and leftover bytes through byte kernels right away, so there's never
+// a partial word carried across calls, and context always sits at a byte
+// boundary.
+struct ctx_t
+{
+  grain_128::state_t st{};
+  uint64_t dlen = 0;  // declared associated data length
+  uint64_t ctlen = 0; // declared plain/ cipher text length
+  uint64_t dpos = 0;  // associated data bytes fed so far
+  uint64_t cpos = 0;  // text bytes fed so far
+  dir_t dir = dir_t::ENCRYPT;
+  phase_t phase = phase_t::DONE;
+};
+
+// Sets up streaming context, initializing cipher state with key & nonce and
+// authenticating DER encoded length of associated data
+static void
+init(ctx_t& ctx,
+     const dir_t dir,
+     const uint8_t* const __restrict key,   // 128 -bit secret key
+     const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+     const uint64_t dlen, // total associated data length | >= 0
+     const uint64_t ctlen // total plain/ cipher text length | >= 0 or UNBOUNDED
+)
+{
+  ctx = ctx_t{};
+  ctx.dir = dir;
+  ctx.dlen = dlen;
+  ctx.ctlen = ctlen;
+  ctx.phase = phase_t::AD;
+
+  aead::initialize(&ctx.st, key, nonce);
+  aead::auth_der_length(&ctx.st, static_cast<size_t>(dlen));
+}
+
+// Feeds next piece of associated data; fails if context doesn't expect
+// associated data anymore or piece runs past declared length
+static bool
+absorb(ctx_t& ctx, const uint8_t* const data, const size_t len)
+{
+  if (ctx.phase != phase_t::AD || len > ctx.dlen - ctx.dpos) {
+    return false;
+  }
+
+  aead::auth_data(&ctx.st, data, len);
+  ctx.dpos += len;
+
+  return true;
+}
+
+// Encrypts/ decrypts next piece of text ( as per direction of context ),
+// writing equal length output; fails if associated data isn't yet completely
+// fed or piece runs past declared length.
+//
+// Note, decrypted pieces are released before tag is verified ( by `finish` ),
+// so they must not be acted upon, until then.
+static bool
+update(ctx_t& ctx,
+       const uint8_t* const __restrict in,
+       uint8_t* const __restrict out,
+       const size_t len)
+{
+  if (ctx.phase == phase_t::AD && ctx.dpos == ctx.dlen) {
+    ctx.phase = phase_t::TEXT;
+  }
+  if (ctx.phase != phase_t::TEXT || len > ctx.ctlen - ctx.cpos) {
+    return false;
+  }
+
+  if (ctx.dir == dir_t::ENCRYPT) {
+    aead::enc_and_auth_txt(&ctx.st, in, out, len);
+  } else {
+    aead::dec_and_auth_txt(&ctx.st, in, out, len);
+  }
+  ctx.cpos += len;
+
+  return true;
+}
+
+// Finalizes context, once all declared data is fed. When encrypting, tag is
+// written to `tag`; when decrypting, `tag` is verified. Returns false, if not
+// all declared data was fed or tag doesn't verify. Context is wiped either way.
+static bool
+finish(ctx_t& ctx, uint8_t* const tag // 64 -bit authentication tag
+)
+{
+  if (ctx.phase == phase_t::AD && ctx.dpos == ctx.dlen) {
+    ctx.phase = phase_t::TEXT;
+  }
+
+  bool ok = ctx.phase == phase_t::TEXT &&
+            (ctx.ctlen == UNBOUNDED || ctx.cpos == ctx.ctlen);
+
+  if (ok) {
+    aead::auth_padding_bit(&ctx.st);
+
+    if (ctx.dir == dir_t::ENCRYPT) {
+      std::memcpy(tag, ctx.st.acc, 8);
+    } else {
+      uint8_t flg = 0;
+      for (size_t i = 0; i < 8; i++) {
+        flg |= ctx.st.acc[i] ^ tag[i];
+      }
+      ok = flg == 0;
+    }
+  }
+
+  std::memset(&ctx.st, 0, sizeof(ctx.st));
+  ctx.phase = phase_t::DONE;
+
+  return ok;
+}
+
+// Exported context layout ( all integers little endian )
+//
+// [ 4 -bytes magic "G128" ] [ 1 -byte version ] [ 1 -byte direction ] [ 1
+// -byte phase ] [ 1 -byte reserved, = 0 ] [ 8 -bytes declared associated data
+// length ] [ 8 -bytes declared text length ] [ 8 -bytes associated data fed ] [
+// 8 -bytes text fed ] [ 16 -bytes LFSR ] [ 16 -bytes NFSR ] [ 8 -bytes
+// accumulator ] [ 8 -bytes shift register ] [ 4 -bytes CRC32C of preceding
+// bytes ]
+//
+// CRC32C only catches accidental corruption; exported blob holds cipher state,
+// which is as sensitive as key stream itself, so it must only travel through
+// channels trusted as much as the process holding key.
+constexpr uint8_t MAGIC[]{ 'G', '1', '2', '8' };
+constexpr uint8_t VERSION = 1;
+constexpr size_t EXPORT_LEN = 4 + 4 + 32 + 48 + 4;
+
+inline static void
+put_le64(uint8_t* const dst, const uint64_t v)
+{
+  for (size_t i = 0; i < 8; i++) {
+    dst[i] = static_cast<uint8_t>(v >> (i << 3));
+  }
+}
+
+inline static uint64_t
+get_le64(const uint8_t* const src)
+{
+  uint64_t v = 0;
+  for (size_t i = 0; i < 8; i++) {
+    v |= static_cast<uint64_t>(src[i]) << (i << 3);
+  }
+  return v;
+}
+
+// Serializes in-progress context into `EXPORT_LEN` -bytes blob, moving it out:
+// source context is wiped, so that same key stream can't be used from two
+// places. Fails, if context is already finalized/ exported.
+inline static bool
+export_ctx(ctx_t& ctx, uint8_t* const out // EXPORT_LEN -bytes
+)
+{
+  if (ctx.phase == phase_t::DONE) {
+    return false;
+  }
+
+  std::memcpy(out, MAGIC, 4);
+  out[4] = VERSION;
+  out[5] = static_cast<uint8_t>(ctx.dir);
+  out[6] = static_cast<uint8_t>(ctx.phase);
+  out[7] = 0;
+
+  put_le64(out + 8, ctx.dlen);
+  put_le64(out + 16, ctx.ctlen);
+  put_le64(out + 24, ctx.dpos);
+  put_le64(out + 32, ctx.cpos);
+
+  std::memcpy(out + 40, ctx.st.lfsr, 16);
+  std::memcpy(out + 56, ctx.st.nfsr, 16);
+  std::memcpy(out + 72, ctx.st.acc, 8);
+  std::memcpy(out + 80, ctx.st.sreg, 8);
+
+  checksum::crc32c_t crc;
+  crc.update(out, EXPORT_LEN - 4);
+  const uint32_t c = crc.digest();
+  for (size_t i = 0; i < 4; i++) {
+    out[EXPORT_LEN - 4 + i] = static_cast<uint8_t>(c >> (i << 3));
+  }
+
+  std::memset(&ctx.st, 0, sizeof(ctx.st));
+  ctx.phase = phase_t::DONE;
+
+  return true;
+}
+
+// Deserializes context exported by `export_ctx`, checking magic, version,
+// CRC32C and consistency of lengths/ phase; returns false ( leaving `ctx`
+// untouched ) if any check fails
+inline static bool
+import_ctx(ctx_t& ctx, const uint8_t* const in // EXPORT_LEN -bytes
+)
+{
+  if (std::memcmp(in, MAGIC, 4) != 0 || in[4] != VERSION || in[7] != 0) {
+    return false;
+  }
+
+  checksum::crc32c_t crc;
+  crc.update(in, EXPORT_LEN - 4);
+  uint32_t c = 0;
+  for (size_t i = 0; i < 4; i++) {
+    c |= static_cast<uint32_t>(in[EXPORT_LEN - 4 + i]) << (i << 3);
+  }
+  if (crc.digest() != c) {
+    return false;
+  }
+
+  ctx_t t;
+  t.dir = static_cast<dir_t>(in[5]);
+  t.phase = static_cast<phase_t>(in[6]);
+  t.dlen = get_le64(in + 8);
+  t.ctlen = get_le64(in + 16);
+  t.dpos = get_le64(in + 24);
+  t.cpos = get_le64(in + 32);
+
+  const bool dir_ok = t.dir == dir_t::ENCRYPT || t.dir == dir_t::DECRYPT;
+  const bool phase_ok = (t.phase == phase_t::AD && t.cpos == 0) ||
+                        (t.phase == phase_t::TEXT && t.dpos == t.dlen);
+  if (!dir_ok || !phase_ok || t.dpos > t.dlen || t.cpos > t.ctlen) {
+    return false;
+  }
+
+  std::memcpy(t.st.lfsr, in + 40, 16);
+  std::memcpy(t.st.nfsr, in + 56, 16);
+  std::memcpy(t.st.acc, in + 72, 8);
+  std::memcpy(t.st.sreg, in + 80, 8);
+
+  ctx = t;
+  return true;
+}
+
+// Exports context straight into a fresh, sealed memfd ( which can be passed to
+// another process over a Unix domain socket, see `send_fd` ), returning its
+// file descriptor, or -1 on failure. Context is moved out only once memfd is
+// sealed, so on failure it's left intact.
+inline static int
+export_memfd(ctx_t& ctx)
+{
+  const int fd =
+    memfd_create("grain_128aead_ctx", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    return -1;
+  }
+
+  // size is fixed before blob is written, so it can't be resized under mapping
+  if (ftruncate(fd, EXPORT_LEN) != 0 ||
+      fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  void* const mem =
+    mmap(nullptr, EXPORT_LEN, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mem == MAP_FAILED) {
+    close(fd);
+    return -1;
+  }
+
+  // serialized from a copy, so that context isn't wiped before memfd is sealed
+  ctx_t t = ctx;
+  uint8_t blob[EXPORT_LEN];
+  const bool ok = export_ctx(t, blob);
+
+  if (ok) {
+    std::memcpy(mem, blob, EXPORT_LEN);
+    std::memset(blob, 0, sizeof(blob));
+  }
+  munmap(mem, EXPORT_LEN);
+
+  // receiver can rely on blob never changing; write seal can only be added
+  // once writable mapping is gone
+  if (!ok || fcntl(fd, F_ADD_SEALS, F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  std::memset(&ctx.st, 0, sizeof(ctx.st));
+  ctx.phase = phase_t::DONE;
+
+  return fd;
+}
+
+// Imports context from memfd, created by `export_memfd`, mapping it read-only;
+// file descriptor isn't closed. Memfd must be large enough to hold a blob, and
+// sealed against writes & shrinking, so that sender can neither modify blob
+// after it's checked nor truncate it under the mapping ( raising SIGBUS ).
+inline static bool
+import_memfd(ctx_t& ctx, const int fd)
+{
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(EXPORT_LEN)) {
+    return false;
+  }
+
+  constexpr int need = F_SEAL_WRITE | F_SEAL_SHRINK;
+  const int seals = fcntl(fd, F_GET_SEALS);
+  if (seals < 0 || (seals & need) != need) {
+    return false;
+  }
+
+  void* const mem = mmap(nullptr, EXPORT_LEN, PROT_READ, MAP_SHARED, fd, 0);
+  if (mem == MAP_FAILED) {
+    return false;
+  }
+
+  const bool ok = import_ctx(ctx, static_cast<const uint8_t*>(mem));
+  munmap(mem, EXPORT_LEN);
+
+  return ok;
+}
+
+// Passes file descriptor over connected Unix domain socket, using SCM_RIGHTS
+inline static bool
+send_fd(const int sock, const int fd)
+{
+  char byte = 0;
+  iovec iov{ &byte, 1 };
+
+  alignas(cmsghdr) char ctrl[CMSG_SPACE(sizeof(int))]{};
+
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = ctrl;
+  msg.msg_controllen = sizeof(ctrl);
+
+  cmsghdr* const cm = CMSG_FIRSTHDR(&msg);
+  cm->cmsg_level = SOL_SOCKET;
+  cm->cmsg_type = SCM_RIGHTS;
+  cm->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(cm), &fd, sizeof(int));
+
+  return sendmsg(sock, &msg, MSG_NOSIGNAL) == 1;
+}
+
+// Receives file descriptor, sent by `send_fd`, returning -1 on failure
+inline static int
+recv_fd(const int sock)
+{
+  char byte = 0;
+  iovec iov{ &byte, 1 };
+
+  alignas(cmsghdr) char ctrl[CMSG_SPACE(sizeof(int))]{};
+
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = ctrl;
+  msg.msg_controllen = sizeof(ctrl);
+
+  if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) != 1) {
+    return -1;
+  }
+
+  const cmsghdr* const cm = CMSG_FIRSTHDR(&msg);
+  if (cm == nullptr || cm->cmsg_level != SOL_SOCKET ||
+      cm->cmsg_type != SCM_RIGHTS || cm->cmsg_len != CMSG_LEN(sizeof(int))) {
+    return -1;
+  }
+
+  int fd = -1;
+  std::memcpy(&fd, CMSG_DATA(cm), sizeof(int));
+  return fd;
+}
+
+}
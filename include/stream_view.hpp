@@ -0,0 +1,221 @@
+#pragma once
+#include "stream.hpp"
+#include <iterator>
+#include <ranges>
+#include <span>
+
+// C++20 range adaptors, lazily encrypting/ decrypting a range of bytes as
+// consumer iterates, on top of streaming context ( see stream.hpp ), so that
+// neither input nor output has to be materialized, say
+//
+// auto enc = bytes | stream::encrypt(key, nonce, ad);
+// for (const uint8_t b : enc) { ... }
+// const uint8_t* tag = enc.tag();
+namespace stream {
+
+// Number of bytes pulled from underlying range at once; it's a multiple of 4,
+// so that all but last chunk are processed by 32 -bit word kernels
+constexpr size_t VIEW_CHUNK = 64;
+
+// Input view over underlying range of bytes, producing encrypted/ decrypted
+// bytes on demand. Bytes are pulled from underlying range `VIEW_CHUNK` at a
+// time and processed together, so that fast word kernels still run, even
+// though consumer sees one byte at a time.
+//
+// Once underlying range is exhausted, context is finalized: encryption tag is
+// available from `tag`, while `verified` tells whether decryption tag checked
+// out. If underlying range is sized, so is this view, and that size is declared
+// as text length of streaming context.
+//
+// Note, decrypted bytes are released before tag is verified, so they must not
+// be acted upon, until view is exhausted and `verified` returns true.
+template<std::ranges::input_range R>
+  requires std::ranges::view<R> &&
+           std::convertible_to<std::ranges::range_reference_t<R>, uint8_t>
+class crypt_view : public std::ranges::view_interface<crypt_view<R>>
+{
+public:
+  crypt_view() = default;
+
+  crypt_view(R base,
+             const dir_t dir,
+             const uint8_t* const key,         // 128 -bit secret key
+             const uint8_t* const nonce,       // 96 -bit public message nonce
+             std::span<const uint8_t> data,    // associated data
+             const uint8_t* const tag = nullptr // 64 -bit tag, to be verified
+             )
+    : base_(std::move(base))
+  {
+    uint64_t ctlen = UNBOUNDED;
+    if constexpr (std::ranges::sized_range<R>) {
+      ctlen = static_cast<uint64_t>(std::ranges::size(base_));
+    }
+
+    init(ctx, dir, key, nonce, data.size(), ctlen);
+    absorb(ctx, data.data(), data.size());
+
+    if (dir == dir_t::DECRYPT) {
+      std::memcpy(tag_, tag, 8);
+    }
+  }
+
+  // Input iterator, yielding one output byte at a time
+  class iterator
+  {
+  public:
+    using iterator_concept = std::input_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = uint8_t;
+
+    iterator() = default;
+
+    explicit iterator(crypt_view* const v)
+      : v(v)
+    {
+    }
+
+    uint8_t operator*() const { return v->out[v->pos]; }
+
+    iterator& operator++()
+    {
+      if (++v->pos == v->len && !v->finished) {
+        v->fill();
+      }
+      return *this;
+    }
+
+    void operator++(int) { ++*this; }
+
+    friend bool operator==(const iterator& it, std::default_sentinel_t)
+    {
+      return it.at_end();
+    }
+
+  private:
+    bool at_end() const { return v->pos == v->len && v->finished; }
+
+    crypt_view* v = nullptr;
+  };
+
+  // Starts pulling from underlying range; being an input view, it can only be
+  // iterated once
+  iterator begin()
+  {
+    cur = std::ranges::begin(base_);
+    fill();
+    return iterator(this);
+  }
+
+  std::default_sentinel_t end() const { return std::default_sentinel; }
+
+  auto size() const
+    requires std::ranges::sized_range<const R>
+  {
+    return std::ranges::size(base_);
+  }
+
+  auto size()
+    requires std::ranges::sized_range<R>
+  {
+    return std::ranges::size(base_);
+  }
+
+  // Whether underlying range is exhausted and context finalized
+  bool done() const { return finished; }
+
+  // Authentication tag of encrypted bytes, once view is exhausted, otherwise
+  // nullptr
+  const uint8_t* tag() const { return finished && ok ? tag_ : nullptr; }
+
+  // Whether decrypted bytes are authentic, once view is exhausted
+  bool verified() const { return finished && ok; }
+
+private:
+  // Pulls next chunk from underlying range and encrypts/ decrypts it,
+  // finalizing context once underlying range is exhausted
+  void fill()
+  {
+    uint8_t in[VIEW_CHUNK];
+    size_t n = 0;
+
+    const auto last = std::ranges::end(base_);
+    while (n < VIEW_CHUNK && cur != last) {
+      in[n++] = static_cast<uint8_t>(*cur);
+      ++cur;
+    }
+
+    ok = update(ctx, in, out, n);
+    pos = 0;
+    len = ok ? n : 0;
+
+    if (!ok || cur == last) {
+      ok = ok && finish(ctx, tag_);
+      finished = true;
+    }
+  }
+
+  R base_{};
+  std::ranges::iterator_t<R> cur{};
+  ctx_t ctx{};
+
+  uint8_t out[VIEW_CHUNK]{};
+  size_t pos = 0;
+  size_t len = 0;
+
+  uint8_t tag_[8]{};
+  bool ok = false;
+  bool finished = false;
+};
+
+template<class R>
+crypt_view(R&&,
+           dir_t,
+           const uint8_t*,
+           const uint8_t*,
+           std::span<const uint8_t>,
+           const uint8_t* = nullptr) -> crypt_view<std::views::all_t<R>>;
+
+// Range adaptor closure, created by `encrypt`/ `decrypt`; key & nonce must
+// stay alive until it's applied to a range
+struct crypt_fn
+{
+  dir_t dir;
+  const uint8_t* key;
+  const uint8_t* nonce;
+  std::span<const uint8_t> data;
+  const uint8_t* tag;
+
+  template<std::ranges::viewable_range R>
+  friend auto operator|(R&& r, const crypt_fn& f)
+  {
+    return crypt_view(std::views::all(std::forward<R>(r)),
+                      f.dir,
+                      f.key,
+                      f.nonce,
+                      f.data,
+                      f.tag);
+  }
+};
+
+// Adaptor, lazily encrypting a range of bytes
+inline crypt_fn
+encrypt(const uint8_t* const key,          // 128 -bit secret key
+        const uint8_t* const nonce,        // 96 -bit public message nonce
+        std::span<const uint8_t> data = {} // associated data
+)
+{
+  return crypt_fn{ dir_t::ENCRYPT, key, nonce, data, nullptr };
+}
+
+// Adaptor, lazily decrypting a range of bytes, verifying given tag at end
+inline crypt_fn
+decrypt(const uint8_t* const key,          // 128 -bit secret key
+        const uint8_t* const nonce,        // 96 -bit public message nonce
+        const uint8_t* const tag,          // 64 -bit authentication tag
+        std::span<const uint8_t> data = {} // associated data
+)
+{
+  return crypt_fn{ dir_t::DECRYPT, key, nonce, data, tag };
+}
+
+}
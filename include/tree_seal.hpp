@@ -0,0 +1,665 @@
+#pragma once
+#include "grain_128aead.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// Parallel encryption of a directory tree, where directories are enumerated
+// concurrently, small files are sealed in batches, large files are split into
+// independently sealed chunks, all of it running on a work-stealing pool ( see
+// `worker_pool::pool_t` ), with a bounded number of files in flight.
+namespace tree_seal {
+
+// Sealed file layout, for M -bytes file sealed with C -bytes chunks
+//
+// [ chunk 0 cipher text | tag 0 ] ... [ chunk (n-1) cipher text | tag (n-1) ]
+//
+// where n = max(1, ceil(M / C)) and last chunk can be shorter than C -bytes.
+// Associated data of each chunk is file's path relative to tree root, followed
+// by 8 -bytes little endian encoded M, so that files can't be swapped, renamed
+// or truncated unnoticed.
+//
+// Each file is assigned a contiguous range of n counters, out of 2^64 counters
+// of whole tree, so that chunk i of a file whose range starts at counter f is
+// sealed under `derive_nonce(base, f + i)` ( see `grain_128aead::derive_nonce`
+// ) and no two chunks of a tree share a nonce. File's nonce, as recorded in
+// `manifest`, is that of its chunk 0, which carries f in its last 8 -bytes.
+constexpr size_t TAG_LEN = 8;
+
+// Number of chunks of M -bytes file
+inline static constexpr size_t
+chunk_count(const size_t len, const size_t chunk)
+{
+  return len == 0 ? 1 : (len + chunk - 1) / chunk;
+}
+
+// Length of sealed M -bytes file
+inline static constexpr size_t
+sealed_len(const size_t len, const size_t chunk)
+{
+  return len + chunk_count(len, chunk) * TAG_LEN;
+}
+
+// Associated data of a file
+inline static std::vector<uint8_t>
+file_ad(const std::string& rel, const size_t len)
+{
+  std::vector<uint8_t> ad(rel.begin(), rel.end());
+  for (size_t i = 0; i < 8; i++) {
+    ad.push_back(static_cast<uint8_t>(static_cast<uint64_t>(len) >> (i << 3)));
+  }
+  return ad;
+}
+
+// Nonce of i -th chunk of a file, given file's nonce
+inline static void
+chunk_nonce(const uint8_t* const __restrict fnonce, // 96 -bit file nonce
+            const size_t idx,                       // chunk index
+            uint8_t* const __restrict nonce         // 96 -bit chunk nonce
+)
+{
+  uint64_t first = 0;
+  for (size_t i = 0; i < 8; i++) {
+    first |= static_cast<uint64_t>(fnonce[4 + i]) << (i << 3);
+  }
+  grain_128aead::derive_nonce(fnonce, first + idx, nonce);
+}
+
+// Seals i -th chunk of a file
+inline static void
+seal_chunk(const uint8_t* const __restrict key,   // 128 -bit secret key
+           const uint8_t* const __restrict fnonce, // 96 -bit file nonce
+           const std::vector<uint8_t>& ad,         // file's associated data
+           const size_t idx,                       // chunk index
+           const uint8_t* const __restrict txt,    // chunk plain text
+           const size_t len,                       // chunk length
+           uint8_t* const __restrict out           // len + TAG_LEN -bytes
+)
+{
+  uint8_t nonce[12];
+  chunk_nonce(fnonce, idx, nonce);
+
+  grain_128aead::encrypt(
+    key, nonce, ad.data(), ad.size(), txt, out, len, out + len);
+}
+
+// Opens sealed file content ( as produced by `seal_tree` ), kept in memory,
+// writing M -bytes plain text to `txt`. Returns false if any chunk fails
+// authentication check or sealed length doesn't match M.
+inline static bool
+open_buffer(const uint8_t* const __restrict key,    // 128 -bit secret key
+            const uint8_t* const __restrict fnonce, // 96 -bit file nonce
+            const std::string& rel,                 // path relative to root
+            const uint8_t* const __restrict sealed, // sealed file content
+            const size_t slen,                      // its length
+            const size_t chunk,                     // chunk size C
+            uint8_t* const __restrict txt,          // M -bytes plain text
+            const size_t len                        // M
+)
+{
+  if (slen != sealed_len(len, chunk)) {
+    return false;
+  }
+
+  const auto ad = file_ad(rel, len);
+  const size_t cnt = chunk_count(len, chunk);
+
+  bool ok = true;
+  for (size_t i = 0; i < cnt; i++) {
+    const size_t off = i * chunk;
+    const size_t clen = std::min(chunk, len - off);
+    const uint8_t* const enc = sealed + off + i * TAG_LEN;
+
+    uint8_t nonce[12];
+    chunk_nonce(fnonce, i, nonce);
+    ok &= grain_128aead::decrypt(
+      key, nonce, enc + clen, ad.data(), ad.size(), enc, txt + off, clen);
+  }
+
+  return ok;
+}
+
+// Tuning knobs of tree sealing
+struct options_t
+{
+  size_t threads = 0;        // worker threads | 0 = hardware concurrency
+  size_t inflight = 256;     // files being sealed at once | > 0
+  size_t chunk = 1ul << 22;  // chunk size of large files | > 0
+  size_t small = 1ul << 16;  // files smaller than this are batched | <= chunk
+  size_t batch = 32;         // small files per batch job | > 0
+};
+
+// Per-file manifest entry
+struct entry_t
+{
+  std::string path;  // relative to tree root
+  uint64_t id = 0;   // first nonce counter of file's range
+  uint8_t nonce[12]; // file nonce
+  uint64_t size = 0; // plain text length
+};
+
+// Summary of sealing run
+struct report_t
+{
+  uint64_t files = 0;
+  uint64_t bytes = 0;
+  uint64_t dirs = 0;
+  uint64_t errors = 0;
+  double seconds = 0.;
+
+  double files_per_sec() const { return seconds > 0. ? files / seconds : 0.; }
+  double bytes_per_sec() const { return seconds > 0. ? bytes / seconds : 0.; }
+};
+
+// Seals all regular files under `in_root` into same relative paths under
+// `out_root` ( directories are created as needed, other file types are skipped
+// ), while collecting per-file manifest entries into `manifest` ( sorted by
+// path ). Files which can't be read/ written are counted as errors.
+//
+// Each file gets its own range of nonce counters, so base nonce must never be
+// reused under same key, for sealing another tree. Files, which don't fit in
+// what's left of 2^64 counters of the tree, are counted as errors, without
+// using up any counters. So are output directories, which can't be created,
+// along with everything under them.
+class sealer_t
+{
+public:
+  sealer_t(const uint8_t* const __restrict key,
+           const uint8_t* const __restrict nonce,
+           const options_t& opts)
+    : opts(opts)
+    , pool(opts.threads)
+  {
+    // small files are sealed as single chunk
+    this->opts.small = std::min(opts.small, opts.chunk);
+    std::memcpy(skey, key, 16);
+    std::memcpy(bnonce, nonce, 12);
+  }
+
+  ~sealer_t() { std::memset(skey, 0, sizeof(skey)); }
+
+  report_t run(const std::string& in_root,
+               const std::string& out_root,
+               std::vector<entry_t>& manifest)
+  {
+    const auto beg = std::chrono::steady_clock::now();
+
+    if (!make_dir(out_root)) {
+      report_t rep;
+      rep.errors = 1;
+      manifest.clear();
+      return rep;
+    }
+
+    begin();
+    pool.submit([this, in_root, out_root] { walk(in_root, out_root, ""); });
+    wait();
+
+    // walking done, flush partially filled small file batch
+    walked.store(true, std::memory_order_release);
+    flush_small();
+    wait();
+
+    std::sort(
+      entries.begin(), entries.end(), [](const entry_t& a, const entry_t& b) {
+        return a.path < b.path;
+      });
+    manifest = std::move(entries);
+
+    report_t rep;
+    rep.files = files.load();
+    rep.bytes = bytes.load();
+    rep.dirs = dirs.load();
+    rep.errors = errors.load();
+
+    const std::chrono::duration<double> took =
+      std::chrono::steady_clock::now() - beg;
+    rep.seconds = took.count();
+
+    return rep;
+  }
+
+private:
+  // File, discovered while walking, waiting to be sealed
+  struct file_t
+  {
+    std::string src;
+    std::string dst;
+    std::string rel;
+    size_t size = 0;
+  };
+
+  // State of a large file, shared by its chunk jobs
+  struct large_t
+  {
+    int ifd = -1;
+    int ofd = -1;
+    std::atomic<size_t> remaining{ 0 };
+    std::atomic<bool> ok{ true };
+    std::vector<uint8_t> ad;
+    entry_t e;
+  };
+
+  // Outstanding work tracking, so that `wait` returns once walkers and sealers
+  // are all done
+  void begin() { outstanding.fetch_add(1, std::memory_order_relaxed); }
+
+  void end()
+  {
+    if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::lock_guard<std::mutex> lock(done_mtx);
+      done_cv.notify_all();
+    }
+  }
+
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(done_mtx);
+    done_cv.wait(lock, [this] {
+      return outstanding.load(std::memory_order_acquire) == 0;
+    });
+  }
+
+  // Enumerates one directory, spawning walkers for subdirectories and queueing
+  // regular files
+  void walk(const std::string src, const std::string dst, const std::string rel)
+  {
+    DIR* dir = opendir(src.c_str());
+    if (dir == nullptr) {
+      errors.fetch_add(1, std::memory_order_relaxed);
+      end();
+      return;
+    }
+
+    dirs.fetch_add(1, std::memory_order_relaxed);
+    const int dfd = dirfd(dir);
+
+    while (const dirent* de = readdir(dir)) {
+      const std::string name = de->d_name;
+      if (name == "." || name == "..") {
+        continue;
+      }
+
+      struct stat sb;
+      if (fstatat(dfd, de->d_name, &sb, AT_SYMLINK_NOFOLLOW) != 0) {
+        errors.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+
+      const std::string csrc = src + "/" + name;
+      const std::string cdst = dst + "/" + name;
+      const std::string crel = rel.empty() ? name : rel + "/" + name;
+
+      if (S_ISDIR(sb.st_mode)) {
+        if (!make_dir(cdst)) {
+          errors.fetch_add(1, std::memory_order_relaxed);
+          continue;
+        }
+
+        begin();
+        pool.submit([this, csrc, cdst, crel] { walk(csrc, cdst, crel); });
+      } else if (S_ISREG(sb.st_mode)) {
+        enqueue({ csrc, cdst, crel, static_cast<size_t>(sb.st_size) });
+      }
+    }
+
+    closedir(dir);
+    end();
+  }
+
+  // Queues discovered file, scheduling as many sealing jobs as in-flight limit
+  // allows
+  void enqueue(file_t&& f)
+  {
+    {
+      std::lock_guard<std::mutex> lock(queue_mtx);
+      if (f.size < opts.small) {
+        smalls.push_back(std::move(f));
+      } else {
+        larges.push_back(std::move(f));
+      }
+    }
+
+    pump();
+    flush_small();
+  }
+
+  // Schedules large files, while fewer than `inflight` -many files are being
+  // sealed
+  void pump()
+  {
+    while (true) {
+      file_t f;
+
+      {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        if (larges.empty() || inflight >= opts.inflight) {
+          return;
+        }
+
+        f = std::move(larges.back());
+        larges.pop_back();
+        inflight++;
+      }
+
+      begin();
+      pool.submit([this, f = std::move(f)] { seal_large(f); });
+    }
+  }
+
+  // Schedules batch(es) of small files, once enough of them are queued ( or
+  // whatever is left, once walking is done )
+  void flush_small()
+  {
+    const bool force = walked.load(std::memory_order_acquire);
+
+    while (true) {
+      std::vector<file_t> batch;
+
+      {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        const bool ready =
+          smalls.size() >= opts.batch || (force && !smalls.empty());
+        if (!ready || inflight >= opts.inflight) {
+          return;
+        }
+
+        const size_t n = std::min(opts.batch, smalls.size());
+        for (size_t i = 0; i < n; i++) {
+          batch.push_back(std::move(smalls.back()));
+          smalls.pop_back();
+        }
+        inflight += n;
+      }
+
+      begin();
+      pool.submit([this, batch = std::move(batch)] { seal_small(batch); });
+    }
+  }
+
+  // Marks `n` -many files done, letting queued files take their place
+  void release(const size_t n)
+  {
+    {
+      std::lock_guard<std::mutex> lock(queue_mtx);
+      inflight -= n;
+    }
+
+    pump();
+    flush_small();
+  }
+
+  // Creates output directory, unless there's one already
+  static bool make_dir(const std::string& path)
+  {
+    if (mkdir(path.c_str(), 0700) == 0) {
+      return true;
+    }
+
+    struct stat sb;
+    return errno == EEXIST && stat(path.c_str(), &sb) == 0 &&
+           S_ISDIR(sb.st_mode);
+  }
+
+  // Assigns range of nonce counters & nonce to a file; false if what's left of
+  // counters can't cover all its chunks, in which case none are reserved
+  bool make_entry(const file_t& f, entry_t& e)
+  {
+    const uint64_t cnt = chunk_count(f.size, opts.chunk);
+    uint64_t id = next_ctr.load(std::memory_order_relaxed);
+
+    do {
+      if (cnt > ~0ul - id) {
+        return false;
+      }
+    } while (!next_ctr.compare_exchange_weak(
+      id, id + cnt, std::memory_order_relaxed));
+
+    e.path = f.rel;
+    e.id = id;
+    e.size = f.size;
+
+    grain_128aead::derive_nonce(bnonce, e.id, e.nonce);
+    return true;
+  }
+
+  void record(entry_t&& e)
+  {
+    files.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(e.size, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(manifest_mtx);
+    entries.push_back(std::move(e));
+  }
+
+  // Seals a batch of small files, each being read, sealed and written in one
+  // go, reusing same buffers
+  void seal_small(const std::vector<file_t>& batch)
+  {
+    std::vector<uint8_t> txt;
+    std::vector<uint8_t> out;
+
+    for (const auto& f : batch) {
+      entry_t e;
+      bool ok = make_entry(f, e);
+
+      txt.resize(f.size);
+      out.resize(sealed_len(f.size, opts.chunk));
+
+      const int ifd = open(f.src.c_str(), O_RDONLY | O_CLOEXEC);
+      const int ofd =
+        open(f.dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+
+      ok = ok && (ifd >= 0) && (ofd >= 0);
+      ok = ok && read_full(ifd, txt.data(), f.size, 0);
+
+      if (ok) {
+        const auto ad = file_ad(f.rel, f.size);
+        seal_chunk(skey, e.nonce, ad, 0, txt.data(), f.size, out.data());
+        ok = write_full(ofd, out.data(), out.size(), 0);
+      }
+
+      if (ifd >= 0) {
+        close(ifd);
+      }
+      if (ofd >= 0) {
+        close(ofd);
+      }
+
+      if (ok) {
+        record(std::move(e));
+      } else {
+        errors.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    std::fill(txt.begin(), txt.end(), 0);
+    release(batch.size());
+    end();
+  }
+
+  // Seals a large file, by splitting it into chunk jobs, which can be stolen
+  // by idle workers; last chunk job to finish closes file & releases its slot
+  void seal_large(const file_t& f)
+  {
+    auto sh = std::make_shared<large_t>();
+    const bool fits = make_entry(f, sh->e);
+    sh->ad = file_ad(f.rel, f.size);
+    sh->ifd = open(f.src.c_str(), O_RDONLY | O_CLOEXEC);
+    sh->ofd =
+      open(f.dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+
+    const size_t cnt = chunk_count(f.size, opts.chunk);
+
+    if (!fits || sh->ifd < 0 || sh->ofd < 0) {
+      sh->ok = false;
+      sh->remaining = 1;
+      finish_large(sh);
+      return;
+    }
+
+    sh->remaining.store(cnt, std::memory_order_relaxed);
+
+    std::vector<worker_pool::job_t> jobs;
+    jobs.reserve(cnt);
+
+    for (size_t i = 0; i < cnt; i++) {
+      jobs.emplace_back([this, sh, i, len = f.size] {
+        const size_t off = i * opts.chunk;
+        const size_t clen = std::min(opts.chunk, len - off);
+
+        std::vector<uint8_t> txt(clen);
+        std::vector<uint8_t> out(clen + TAG_LEN);
+
+        bool ok = read_full(sh->ifd, txt.data(), clen, off);
+        if (ok) {
+          seal_chunk(
+            skey, sh->e.nonce, sh->ad, i, txt.data(), clen, out.data());
+          ok = write_full(sh->ofd, out.data(), out.size(), off + i * TAG_LEN);
+        }
+
+        if (!ok) {
+          sh->ok.store(false, std::memory_order_relaxed);
+        }
+
+        std::fill(txt.begin(), txt.end(), 0);
+        finish_large(sh);
+      });
+    }
+
+    pool.submit_batch(std::move(jobs));
+  }
+
+  void finish_large(const std::shared_ptr<large_t>& sh)
+  {
+    if (sh->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+
+    if (sh->ifd >= 0) {
+      close(sh->ifd);
+    }
+    if (sh->ofd >= 0) {
+      close(sh->ofd);
+    }
+
+    if (sh->ok.load(std::memory_order_relaxed)) {
+      record(std::move(sh->e));
+    } else {
+      errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    release(1);
+    end();
+  }
+
+  static bool read_full(const int fd,
+                        uint8_t* const buf,
+                        const size_t len,
+                        const size_t off)
+  {
+    size_t done = 0;
+    while (done < len) {
+      const ssize_t n = pread(fd, buf + done, len - done, off + done);
+      if (n <= 0) {
+        return false;
+      }
+      done += static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  static bool write_full(const int fd,
+                         const uint8_t* const buf,
+                         const size_t len,
+                         const size_t off)
+  {
+    size_t done = 0;
+    while (done < len) {
+      const ssize_t n = pwrite(fd, buf + done, len - done, off + done);
+      if (n <= 0) {
+        return false;
+      }
+      done += static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  uint8_t skey[16]{};
+  uint8_t bnonce[12]{};
+  options_t opts;
+
+  std::mutex queue_mtx;
+  std::vector<file_t> smalls;
+  std::vector<file_t> larges;
+  size_t inflight = 0;
+  std::atomic<bool> walked{ false };
+
+  std::mutex manifest_mtx;
+  std::vector<entry_t> entries;
+
+  std::atomic<uint64_t> next_ctr{ 0 };
+  std::atomic<uint64_t> files{ 0 };
+  std::atomic<uint64_t> bytes{ 0 };
+  std::atomic<uint64_t> dirs{ 0 };
+  std::atomic<uint64_t> errors{ 0 };
+
+  std::atomic<size_t> outstanding{ 0 };
+  std::mutex done_mtx;
+  std::condition_variable done_cv;
+
+  // declared last, so that workers are joined before anything they touch is
+  // destroyed
+  worker_pool::pool_t pool;
+};
+
+// Seals directory tree, see `sealer_t`
+static report_t
+seal_tree(const uint8_t* const __restrict key,   // 128 -bit secret key
+          const uint8_t* const __restrict nonce, // 96 -bit base nonce
+          const std::string& in_root,            // tree to be sealed
+          const std::string& out_root,           // where sealed tree goes
+          std::vector<entry_t>& manifest,        // per-file nonce manifest
+          const options_t& opts = {})
+{
+  sealer_t s(key, nonce, opts);
+  return s.run(in_root, out_root, manifest);
+}
+
+// Writes manifest as tab separated lines of hex encoded file nonce, plain text
+// length, chunk size & relative path. Returns false if it can't be written.
+inline static bool
+write_manifest(const std::string& path,
+               const std::vector<entry_t>& manifest,
+               const size_t chunk)
+{
+  FILE* fp = std::fopen(path.c_str(), "w");
+  if (fp == nullptr) {
+    return false;
+  }
+
+  for (const auto& e : manifest) {
+    for (size_t i = 0; i < 12; i++) {
+      std::fprintf(fp, "%02x", e.nonce[i]);
+    }
+    std::fprintf(fp,
+                 "\t%llu\t%zu\t%s\n",
+                 static_cast<unsigned long long>(e.size),
+                 chunk,
+                 e.path.c_str());
+  }
+
+  return std::fclose(fp) == 0;
+}
+
+}
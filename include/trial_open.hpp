@@ -0,0 +1,285 @@
+#pragma once
+#include "grain_128aead.hpp"
+#include <bit>
+#include <cstddef>
+
+// Trial decryption of a message, sealed under one of K candidate keys ( say
+// during key rotation, when receiver doesn't know which of active keys was
+// used ), where all candidates are verified in one interleaved pass, without
+// writing any plain text, and message is decrypted only under the key which
+// verified.
+//
+// Cipher states of up to `MAX_LANES` candidates are clocked in lockstep, one
+// 32 -bit word at a time, so that their independent dependency chains overlap
+// in out-of-order core, instead of running K serial `grain_128aead::decrypt`
+// calls, each paying for plain text writes ( and memset on failure ).
+namespace trial_open {
+
+// Number of candidate keys verified together, in one interleaved pass
+constexpr size_t MAX_LANES = 4;
+
+// Clocks cipher 32 times, returning 32 pre-output generator bits
+inline static uint32_t
+clockx32(grain_128::state_t* const st)
+{
+  const uint32_t yt = grain_128::ksbx32(st);
+
+  const uint32_t s96 = grain_128::lx32(st);
+  const uint32_t b96 = grain_128::fx32(st);
+
+  grain_128::update_lfsrx32(st, s96);
+  grain_128::update_nfsrx32(st, b96);
+
+  return yt;
+}
+
+// Clocks cipher 8 times, returning 8 pre-output generator bits
+inline static uint8_t
+clock(grain_128::state_t* const st)
+{
+  const uint8_t yt = grain_128::ksb(st);
+
+  const uint8_t s120 = grain_128::l(st);
+  const uint8_t b120 = grain_128::f(st);
+
+  grain_128::update_lfsr(st, s120);
+  grain_128::update_nfsr(st, b120);
+
+  return yt;
+}
+
+// Same as `aead::initialize`, for K cipher states ( with different keys but
+// same nonce ), clocked in lockstep
+template<const size_t K>
+static void
+initialize(grain_128::state_t* const __restrict st,
+           const uint8_t* const* const __restrict keys,
+           const uint8_t* const __restrict nonce)
+{
+  constexpr uint8_t lfsr32[]{ 0xff, 0xff, 0xff, 0x7f };
+
+  for (size_t k = 0; k < K; k++) {
+    std::memcpy(st[k].nfsr, keys[k], 16);
+    std::memcpy(st[k].lfsr, nonce, 12);
+    std::memcpy(st[k].lfsr + 12, lfsr32, 4);
+  }
+
+  for (size_t t = 0; t < 10; t++) {
+    for (size_t k = 0; k < K; k++) {
+      const uint32_t yt = grain_128::ksbx32(&st[k]);
+
+      const uint32_t s96 = grain_128::lx32(&st[k]);
+      const uint32_t b96 = grain_128::fx32(&st[k]);
+
+      grain_128::update_lfsrx32(&st[k], s96 ^ yt);
+      grain_128::update_nfsrx32(&st[k], b96 ^ yt);
+    }
+  }
+
+  for (size_t t = 0; t < 2; t++) {
+    const size_t toff = t << 2;
+
+    for (size_t k = 0; k < K; k++) {
+      const uint8_t* const key = keys[k];
+
+      const uint32_t ka = grain_128::from_le_bytes<uint32_t>(key + toff + 8);
+      const uint32_t kb = grain_128::from_le_bytes<uint32_t>(key + toff);
+
+      const uint32_t yt = grain_128::ksbx32(&st[k]);
+
+      const uint32_t s96 = grain_128::lx32(&st[k]);
+      const uint32_t b96 = grain_128::fx32(&st[k]);
+
+      grain_128::update_lfsrx32(&st[k], s96 ^ yt ^ ka);
+      grain_128::update_nfsrx32(&st[k], b96 ^ yt ^ kb);
+    }
+  }
+
+  // first 64 pre-output bits go to accumulator, next 64 to shift register
+  for (size_t t = 0; t < 4; t++) {
+    for (size_t k = 0; k < K; k++) {
+      const uint32_t yt = clockx32(&st[k]);
+
+      uint8_t* const reg = t < 2 ? st[k].acc : st[k].sreg;
+      grain_128::to_le_bytes<uint32_t>(yt, reg + ((t & 1) << 2));
+    }
+  }
+}
+
+// Authenticates 8 input bits on each of K cipher states
+template<const size_t K>
+inline static void
+auth_byte(grain_128::state_t* const st, const uint8_t msg)
+{
+  for (size_t k = 0; k < K; k++) {
+    const uint8_t yt0 = clock(&st[k]);
+    const uint8_t yt1 = clock(&st[k]);
+
+    const auto splitted = aead::split_bits<uint8_t>(yt0, yt1);
+    grain_128::authenticate<uint8_t>(&st[k], msg, splitted.second);
+  }
+}
+
+// Verifies authentication tag of message against K candidate keys, in one
+// interleaved pass, decrypting cipher text only in registers ( plain text is
+// authenticated but never written ); returns bit mask of keys which verified
+template<const size_t K>
+static uint32_t
+verify_lanes(const uint8_t* const* const __restrict keys,
+             const uint8_t* const __restrict nonce,
+             const uint8_t* const __restrict tag,
+             const uint8_t* const __restrict data,
+             const size_t dlen,
+             const uint8_t* const __restrict enc,
+             const size_t ctlen)
+{
+  grain_128::state_t st[K];
+
+  initialize<K>(st, keys, nonce);
+
+  // Authenticate DER encoded length of associated data & associated data
+
+  uint8_t der[9]{};
+  const size_t der_len = aead::encode_der(dlen, der);
+
+  for (size_t i = 0; i < der_len; i++) {
+    auth_byte<K>(st, der[i]);
+  }
+
+  const size_t dword_cnt = dlen >> 2;
+
+  for (size_t i = 0; i < dword_cnt; i++) {
+    const uint32_t dataw = grain_128::from_le_bytes<uint32_t>(data + (i << 2));
+
+    for (size_t k = 0; k < K; k++) {
+      const uint32_t yt0 = clockx32(&st[k]);
+      const uint32_t yt1 = clockx32(&st[k]);
+
+      const auto splitted = aead::split_bits<uint32_t>(yt0, yt1);
+      grain_128::authenticate<uint32_t>(&st[k], dataw, splitted.second);
+    }
+  }
+
+  for (size_t i = dword_cnt << 2; i < dlen; i++) {
+    auth_byte<K>(st, data[i]);
+  }
+
+  // Decrypt cipher text in registers, authenticating recovered plain text
+
+  const size_t cword_cnt = ctlen >> 2;
+
+  for (size_t i = 0; i < cword_cnt; i++) {
+    const uint32_t encw = grain_128::from_le_bytes<uint32_t>(enc + (i << 2));
+
+    for (size_t k = 0; k < K; k++) {
+      const uint32_t yt0 = clockx32(&st[k]);
+      const uint32_t yt1 = clockx32(&st[k]);
+
+      const auto splitted = aead::split_bits<uint32_t>(yt0, yt1);
+      const uint32_t txtw = encw ^ splitted.first;
+      grain_128::authenticate<uint32_t>(&st[k], txtw, splitted.second);
+    }
+  }
+
+  for (size_t i = cword_cnt << 2; i < ctlen; i++) {
+    for (size_t k = 0; k < K; k++) {
+      const uint8_t yt0 = clock(&st[k]);
+      const uint8_t yt1 = clock(&st[k]);
+
+      const auto splitted = aead::split_bits<uint8_t>(yt0, yt1);
+      const uint8_t txtb = enc[i] ^ splitted.first;
+      grain_128::authenticate<uint8_t>(&st[k], txtb, splitted.second);
+    }
+  }
+
+  // Authenticate padding bit & compare tags, without early exit
+
+  uint32_t mask = 0;
+
+  for (size_t k = 0; k < K; k++) {
+    aead::auth_padding_bit(&st[k]);
+
+    uint8_t flg = 0;
+    for (size_t i = 0; i < 8; i++) {
+      flg |= st[k].acc[i] ^ tag[i];
+    }
+
+    mask |= static_cast<uint32_t>(flg == 0) << k;
+  }
+
+  return mask;
+}
+
+// Verifies message against K candidate keys, `MAX_LANES` of them at a time,
+// returning index of first key under which authentication check passes, or -1
+// if none does. No plain text is produced.
+static ptrdiff_t
+verify(const uint8_t* const* const __restrict keys, // K 128 -bit secret keys
+       const size_t nkeys,                          // K | >= 0
+       const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+       const uint8_t* const __restrict tag,   // 64 -bit authentication tag
+       const uint8_t* const __restrict data,  // N -bytes associated data
+       const size_t dlen,                     // len(data) = N | >= 0
+       const uint8_t* const __restrict enc,   // M -bytes encrypted text
+       const size_t ctlen                     // len(enc) = M | >= 0
+)
+{
+  for (size_t base = 0; base < nkeys; base += MAX_LANES) {
+    const uint8_t* const* const ks = keys + base;
+    const size_t n = std::min(MAX_LANES, nkeys - base);
+
+    uint32_t mask = 0;
+
+    switch (n) {
+      case 1:
+        mask = verify_lanes<1>(ks, nonce, tag, data, dlen, enc, ctlen);
+        break;
+      case 2:
+        mask = verify_lanes<2>(ks, nonce, tag, data, dlen, enc, ctlen);
+        break;
+      case 3:
+        mask = verify_lanes<3>(ks, nonce, tag, data, dlen, enc, ctlen);
+        break;
+      default:
+        mask = verify_lanes<4>(ks, nonce, tag, data, dlen, enc, ctlen);
+        break;
+    }
+
+    if (mask != 0) {
+      return static_cast<ptrdiff_t>(base + std::countr_zero(mask));
+    }
+  }
+
+  return -1;
+}
+
+// Trial-opens message sealed under one of K candidate keys: verifies all
+// candidates ( see `verify` ), then decrypts cipher text under the key which
+// verified, returning its index. If no key verifies, plain text is zeroed and
+// -1 is returned.
+static ptrdiff_t
+open(const uint8_t* const* const __restrict keys, // K 128 -bit secret keys
+     const size_t nkeys,                          // K | >= 0
+     const uint8_t* const __restrict nonce, // 96 -bit public message nonce
+     const uint8_t* const __restrict tag,   // 64 -bit authentication tag
+     const uint8_t* const __restrict data,  // N -bytes associated data
+     const size_t dlen,                     // len(data) = N | >= 0
+     const uint8_t* const __restrict enc,   // M -bytes encrypted text
+     uint8_t* const __restrict txt,         // M -bytes decrypted text
+     const size_t ctlen                     // len(enc) = len(txt) = M | >= 0
+)
+{
+  const ptrdiff_t idx =
+    verify(keys, nkeys, nonce, tag, data, dlen, enc, ctlen);
+
+  if (idx < 0) {
+    std::memset(txt, 0, ctlen);
+    return -1;
+  }
+
+  const bool ok = grain_128aead::decrypt(
+    keys[idx], nonce, tag, data, dlen, enc, txt, ctlen);
+  return ok ? idx : -1;
+}
+
+}
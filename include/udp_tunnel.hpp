@@ -0,0 +1,651 @@
+#pragma once
+#include "grain_128aead.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Datagram tunnel engine, sealing/ opening UDP datagrams using Grain-128 AEAD,
+// where datagrams are received in bursts ( using `recvmmsg` ), whole burst is
+// sealed/ opened in one batched pass and transmitted back in one go ( using
+// `sendmmsg` ), so that syscall cost is amortized over burst. Each worker owns
+// its socket, bound to same address with SO_REUSEPORT, so that kernel spreads
+// incoming flows across workers.
+namespace udp_tunnel {
+
+// Sealed datagram layout
+//
+// [ 4 -bytes session id ] [ 8 -bytes sequence number ] [ cipher text ] [ 8
+// -bytes authentication tag ]
+//
+// where both header fields are little endian encoded and whole 12 -bytes header
+// is used as associated data. Nonce of datagram is derived from base nonce and
+// sequence number ( see `grain_128aead::derive_nonce` ), so sequence numbers
+// must never repeat under same key.
+constexpr size_t HDR_LEN = 12;
+constexpr size_t TAG_LEN = 8;
+
+// End of sequence number space; sequence numbers are below it, so that counter
+// of next sequence number never wraps around to reuse one
+constexpr uint64_t SEQ_END = ~0ul;
+
+// Largest datagram handled by engine ( sealed or not )
+constexpr size_t MAX_DGRAM = 2048;
+
+// Largest plain text payload, which can be sealed
+constexpr size_t MAX_PAYLOAD = MAX_DGRAM - HDR_LEN - TAG_LEN;
+
+// Encodes datagram header
+inline static void
+encode_header(const uint32_t session, const uint64_t seq, uint8_t* const hdr)
+{
+  for (size_t i = 0; i < 4; i++) {
+    hdr[i] = static_cast<uint8_t>(session >> (i << 3));
+  }
+  for (size_t i = 0; i < 8; i++) {
+    hdr[4 + i] = static_cast<uint8_t>(seq >> (i << 3));
+  }
+}
+
+// Decodes datagram header
+inline static void
+decode_header(const uint8_t* const hdr, uint32_t& session, uint64_t& seq)
+{
+  session = 0u;
+  for (size_t i = 0; i < 4; i++) {
+    session |= static_cast<uint32_t>(hdr[i]) << (i << 3);
+  }
+  seq = 0ul;
+  for (size_t i = 0; i < 8; i++) {
+    seq |= static_cast<uint64_t>(hdr[4 + i]) << (i << 3);
+  }
+}
+
+// Seals a burst of `cnt` -many plain text datagrams, where i -th datagram gets
+// sequence number `seq + i`; sealed datagram i is written to `out[i]` ( which
+// must have room for `len[i] + HDR_LEN + TAG_LEN` -bytes ), while its length is
+// written to `olen[i]`. Returns number of sealed datagrams, which is less than
+// `cnt` only when sequence numbers reach `SEQ_END`; datagrams from there on
+// aren't sealed and get `olen[i] = 0`.
+inline static size_t
+seal_burst(const uint8_t* const __restrict key,   // 128 -bit secret key
+           const uint8_t* const __restrict nonce, // 96 -bit base nonce
+           const uint32_t session,                // session id
+           const uint64_t seq,                    // first sequence number
+           const uint8_t* const* const in,        // plain text datagrams
+           const size_t* const len,               // their lengths
+           uint8_t* const* const out,             // sealed datagrams
+           size_t* const olen,                    // their lengths
+           const size_t cnt                       // burst size
+)
+{
+  const uint64_t left = seq < SEQ_END ? SEQ_END - seq : 0ul;
+  const size_t scnt = static_cast<size_t>(std::min<uint64_t>(cnt, left));
+
+  for (size_t i = 0; i < scnt; i++) {
+    uint8_t dnonce[12];
+    grain_128aead::derive_nonce(nonce, seq + i, dnonce);
+
+    uint8_t* const hdr = out[i];
+    encode_header(session, seq + i, hdr);
+
+    uint8_t* const enc = hdr + HDR_LEN;
+    uint8_t* const tag = enc + len[i];
+
+    grain_128aead::encrypt(
+      key, dnonce, hdr, HDR_LEN, in[i], enc, len[i], tag);
+    olen[i] = len[i] + HDR_LEN + TAG_LEN;
+  }
+
+  std::fill(olen + scnt, olen + cnt, 0ul);
+  return scnt;
+}
+
+// Opens a burst of `cnt` -many sealed datagrams, writing plain text of i -th
+// one to `out[i]` ( which must have room for `len[i]` -bytes ) and its length
+// to `olen[i]`. Datagrams which are too short, belong to some other session,
+// carry a sequence number at or past `SEQ_END` or fail authentication check get
+// `olen[i] = 0` and `ok[i] = false`. Returns number of authentic datagrams.
+inline static size_t
+open_burst(const uint8_t* const __restrict key,   // 128 -bit secret key
+           const uint8_t* const __restrict nonce, // 96 -bit base nonce
+           const uint32_t session,                // session id
+           const uint8_t* const* const in,        // sealed datagrams
+           const size_t* const len,               // their lengths
+           uint8_t* const* const out,             // plain text datagrams
+           size_t* const olen,                    // their lengths
+           bool* const ok,                        // authentication status
+           const size_t cnt                       // burst size
+)
+{
+  size_t good = 0;
+
+  for (size_t i = 0; i < cnt; i++) {
+    ok[i] = false;
+    olen[i] = 0;
+
+    if (len[i] < HDR_LEN + TAG_LEN) {
+      continue;
+    }
+
+    uint32_t dsession = 0;
+    uint64_t seq = 0;
+    decode_header(in[i], dsession, seq);
+
+    if (dsession != session || seq >= SEQ_END) {
+      continue;
+    }
+
+    uint8_t dnonce[12];
+    grain_128aead::derive_nonce(nonce, seq, dnonce);
+
+    const size_t ctlen = len[i] - HDR_LEN - TAG_LEN;
+    const uint8_t* const enc = in[i] + HDR_LEN;
+    const uint8_t* const tag = enc + ctlen;
+
+    ok[i] = grain_128aead::decrypt(
+      key, dnonce, tag, in[i], HDR_LEN, enc, out[i], ctlen);
+    olen[i] = ok[i] ? ctlen : 0;
+    good += ok[i];
+  }
+
+  return good;
+}
+
+// Direction of tunnel engine
+enum class direction_t
+{
+  SEAL, // plain text datagrams in, sealed datagrams out
+  OPEN  // sealed datagrams in, authentic plain text datagrams out
+};
+
+// Configuration of tunnel engine
+struct config_t
+{
+  uint8_t key[16]{};          // 128 -bit secret key
+  uint8_t nonce[12]{};        // 96 -bit base nonce
+  uint32_t session = 0;       // session id, carried in header
+  uint64_t seq = 0;           // first sequence number ( when sealing )
+  direction_t dir = direction_t::SEAL;
+  sockaddr_in listen{};       // address, where datagrams are received
+  sockaddr_in peer{};         // address, where processed datagrams are sent
+  size_t workers = 0;         // 0 = hardware concurrency
+  size_t burst = 32;          // datagrams per recvmmsg/ sendmmsg | <= 1024
+  bool pin = true;            // pin i -th worker to i -th core
+};
+
+// Opens UDP socket bound to given address, with SO_REUSEPORT set, so that many
+// workers can bind to same address; receive calls time out after 100ms, so that
+// workers can notice stop requests. Returns -1 on failure.
+inline static int
+bind_socket(const sockaddr_in& addr)
+{
+  const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+
+  const int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+  const int buf = 1 << 22;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buf, sizeof(buf));
+  setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buf, sizeof(buf));
+
+  const timeval tv{ 0, 100000 };
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  const sockaddr* sa = reinterpret_cast<const sockaddr*>(&addr);
+  if (bind(fd, sa, sizeof(addr)) < 0) {
+    ::close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+// Best-effort pinning of calling thread to given core
+inline static void
+pin_to_core(const size_t core)
+{
+  const size_t ncores = std::thread::hardware_concurrency();
+  if (ncores == 0) {
+    return;
+  }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(core % ncores, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// Receive/ transmit buffers of a worker, for a burst of datagrams
+struct burst_t
+{
+  explicit burst_t(const size_t n)
+    : n(n)
+    , rx_buf(n * MAX_DGRAM)
+    , tx_buf(n * MAX_DGRAM)
+    , rx_iov(n)
+    , tx_iov(n)
+    , rx_msg(n)
+    , tx_msg(n)
+    , in(n)
+    , out(n)
+    , len(n)
+    , olen(n)
+    , ok(new bool[n])
+  {
+    for (size_t i = 0; i < n; i++) {
+      in[i] = rx_buf.data() + i * MAX_DGRAM;
+      out[i] = tx_buf.data() + i * MAX_DGRAM;
+
+      rx_iov[i] = { in[i], MAX_DGRAM };
+      rx_msg[i].msg_hdr.msg_iov = &rx_iov[i];
+      rx_msg[i].msg_hdr.msg_iovlen = 1;
+
+      tx_iov[i] = { out[i], 0 };
+      tx_msg[i].msg_hdr.msg_iov = &tx_iov[i];
+      tx_msg[i].msg_hdr.msg_iovlen = 1;
+    }
+  }
+
+  size_t n;
+  std::vector<uint8_t> rx_buf;
+  std::vector<uint8_t> tx_buf;
+  std::vector<iovec> rx_iov;
+  std::vector<iovec> tx_iov;
+  std::vector<mmsghdr> rx_msg;
+  std::vector<mmsghdr> tx_msg;
+  std::vector<uint8_t*> in;
+  std::vector<uint8_t*> out;
+  std::vector<size_t> len;
+  std::vector<size_t> olen;
+  std::unique_ptr<bool[]> ok;
+};
+
+// Multi-worker tunnel engine, each worker receiving bursts on its own
+// SO_REUSEPORT socket, sealing/ opening them and sending processed datagrams to
+// configured peer.
+//
+// When sealing, workers reserve sequence numbers for whole burst, using single
+// atomic update of shared counter, so that nonces never repeat across workers.
+// Once sequence numbers reach `SEQ_END`, nothing more is sealed; such datagrams
+// are counted by `exhausted`, apart from dropped ones. When opening, no replay
+// protection is offered.
+struct engine_t
+{
+  engine_t() = default;
+  engine_t(const engine_t&) = delete;
+  engine_t& operator=(const engine_t&) = delete;
+
+  ~engine_t() { stop(); }
+
+  // Binds worker sockets and starts workers. Returns false if any socket can't
+  // be set up, in which case nothing is left running.
+  bool start(const config_t& config)
+  {
+    cfg = config;
+    cfg.burst = std::min<size_t>(std::max<size_t>(cfg.burst, 1), 1024);
+    if (cfg.workers == 0) {
+      cfg.workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    seq.store(cfg.seq, std::memory_order_relaxed);
+    running.store(true, std::memory_order_relaxed);
+    stats = std::make_unique<counters_t[]>(cfg.workers);
+
+    for (size_t i = 0; i < cfg.workers; i++) {
+      const int fd = bind_socket(cfg.listen);
+      if (fd < 0) {
+        stop();
+        return false;
+      }
+      fds.push_back(fd);
+    }
+
+    for (size_t i = 0; i < cfg.workers; i++) {
+      threads.emplace_back([this, i] { work(i); });
+    }
+
+    return true;
+  }
+
+  // Stops workers ( within ~100ms ) and closes their sockets
+  void stop()
+  {
+    running.store(false, std::memory_order_relaxed);
+
+    for (auto& t : threads) {
+      t.join();
+    }
+    threads.clear();
+
+    for (const int fd : fds) {
+      ::close(fd);
+    }
+    fds.clear();
+
+    std::memset(cfg.key, 0, sizeof(cfg.key));
+  }
+
+  // Number of workers, as of last start
+  size_t workers() const { return stats ? cfg.workers : 0; }
+
+  // Datagrams received so far, by all workers
+  uint64_t rx_packets() const { return total(&counters_t::rx); }
+
+  // Datagrams sent so far, by all workers
+  uint64_t tx_packets() const { return total(&counters_t::tx); }
+
+  // Datagrams dropped so far, because they failed authentication check ( or
+  // were malformed/ oversized ), by all workers
+  uint64_t dropped() const { return total(&counters_t::drop); }
+
+  // Datagrams left unsealed ( and unsent ) so far, because sequence numbers ran
+  // out, by all workers; once non-zero, key or base nonce must be rotated
+  uint64_t exhausted() const { return total(&counters_t::exhaust); }
+
+  // Same as above, but for i -th worker only, so that spread of flows across
+  // SO_REUSEPORT sockets can be seen | i < workers()
+  uint64_t rx_packets(const size_t i) const { return load(i, &counters_t::rx); }
+  uint64_t tx_packets(const size_t i) const { return load(i, &counters_t::tx); }
+  uint64_t dropped(const size_t i) const { return load(i, &counters_t::drop); }
+  uint64_t exhausted(const size_t i) const
+  {
+    return load(i, &counters_t::exhaust);
+  }
+
+  // Next sequence number to be used, when sealing; persist it ( or rotate key )
+  // before restarting engine under same key
+  uint64_t next_seq() const { return seq.load(std::memory_order_relaxed); }
+
+private:
+  // Counters of a worker, on their own cache line, so that workers don't
+  // contend on shared ones
+  struct alignas(64) counters_t
+  {
+    std::atomic<uint64_t> rx{ 0 };
+    std::atomic<uint64_t> tx{ 0 };
+    std::atomic<uint64_t> drop{ 0 };
+    std::atomic<uint64_t> exhaust{ 0 };
+  };
+
+  using counter_t = std::atomic<uint64_t> counters_t::*;
+
+  uint64_t load(const size_t i, const counter_t c) const
+  {
+    return (stats[i].*c).load(std::memory_order_relaxed);
+  }
+
+  uint64_t total(const counter_t c) const
+  {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < workers(); i++) {
+      sum += load(i, c);
+    }
+    return sum;
+  }
+
+  void work(const size_t idx)
+  {
+    if (cfg.pin) {
+      pin_to_core(idx);
+    }
+
+    const int fd = fds[idx];
+    counters_t& st = stats[idx];
+    burst_t b(cfg.burst);
+
+    for (size_t i = 0; i < b.n; i++) {
+      b.tx_msg[i].msg_hdr.msg_name = &cfg.peer;
+      b.tx_msg[i].msg_hdr.msg_namelen = sizeof(cfg.peer);
+    }
+
+    while (running.load(std::memory_order_relaxed)) {
+      const int n = recvmmsg(fd, b.rx_msg.data(), b.n, MSG_WAITFORONE, nullptr);
+      if (n <= 0) {
+        continue;
+      }
+
+      const size_t cnt = static_cast<size_t>(n);
+      st.rx.fetch_add(cnt, std::memory_order_relaxed);
+
+      size_t m = 0;
+      size_t unsealed = 0;
+
+      if (cfg.dir == direction_t::SEAL) {
+        // oversized/ truncated datagrams are dropped, before reserving
+        // sequence numbers
+        for (size_t i = 0; i < cnt; i++) {
+          const size_t l = b.rx_msg[i].msg_len;
+          const bool fits = (l <= MAX_PAYLOAD) &&
+                            !(b.rx_msg[i].msg_hdr.msg_flags & MSG_TRUNC);
+
+          b.in[m] = b.rx_buf.data() + i * MAX_DGRAM;
+          b.len[m] = l;
+          m += fits;
+        }
+
+        // never reserving past `SEQ_END`, so that counter doesn't wrap
+        // around; once it's reached, nothing more is sealed ( or sent )
+        uint64_t seq0 = seq.load(std::memory_order_relaxed);
+        uint64_t take = 0;
+        do {
+          take = std::min<uint64_t>(m, SEQ_END - seq0);
+        } while (!seq.compare_exchange_weak(
+          seq0, seq0 + take, std::memory_order_relaxed));
+
+        const size_t sealed = seal_burst(cfg.key,
+                                         cfg.nonce,
+                                         cfg.session,
+                                         seq0,
+                                         b.in.data(),
+                                         b.len.data(),
+                                         b.out.data(),
+                                         b.olen.data(),
+                                         static_cast<size_t>(take));
+        unsealed = m - sealed;
+        m = sealed;
+
+        for (size_t i = 0; i < m; i++) {
+          b.tx_iov[i].iov_len = b.olen[i];
+        }
+      } else {
+        for (size_t i = 0; i < cnt; i++) {
+          b.in[i] = b.rx_buf.data() + i * MAX_DGRAM;
+          b.len[i] = b.rx_msg[i].msg_len;
+        }
+
+        open_burst(cfg.key,
+                   cfg.nonce,
+                   cfg.session,
+                   b.in.data(),
+                   b.len.data(),
+                   b.out.data(),
+                   b.olen.data(),
+                   b.ok.get(),
+                   cnt);
+
+        // compact authentic datagrams, keeping transmit buffers in place
+        for (size_t i = 0; i < cnt; i++) {
+          if (b.ok[i]) {
+            b.tx_iov[m].iov_base = b.out[i];
+            b.tx_iov[m].iov_len = b.olen[i];
+            m++;
+          }
+        }
+      }
+
+      st.drop.fetch_add(cnt - m - unsealed, std::memory_order_relaxed);
+      st.exhaust.fetch_add(unsealed, std::memory_order_relaxed);
+
+      size_t sent = 0;
+      while (sent < m) {
+        const int s = sendmmsg(fd, b.tx_msg.data() + sent, m - sent, 0);
+        if (s <= 0) {
+          break;
+        }
+        sent += static_cast<size_t>(s);
+      }
+
+      st.tx.fetch_add(sent, std::memory_order_relaxed);
+    }
+  }
+
+  config_t cfg{};
+  std::vector<int> fds;
+  std::vector<std::thread> threads;
+
+  std::atomic<bool> running{ false };
+  std::atomic<uint64_t> seq{ 0 };
+  std::unique_ptr<counters_t[]> stats;
+};
+
+// Result of running packet generator/ sink for a while
+struct report_t
+{
+  uint64_t packets = 0;
+  double seconds = 0.;
+
+  double mpps() const { return seconds > 0. ? packets / seconds / 1e6 : 0.; }
+};
+
+// Built-in packet generator, blasting `len` -bytes datagrams to `dst` from
+// `threads` -many threads, in bursts of `burst` datagrams ( using `sendmmsg` ),
+// for given duration. Reports how many datagrams were handed to kernel.
+//
+// Datagrams are sent over `flows` -many sockets ( i.e. distinct source ports ),
+// spread round-robin over threads, with each thread cycling through its own
+// sockets burst by burst; SO_REUSEPORT hashes flows, not threads, onto workers,
+// so it takes several flows to keep several workers busy | flows >= threads
+inline static report_t
+generate(const sockaddr_in& dst,
+         const size_t len,
+         const size_t threads,
+         const size_t flows,
+         const size_t burst,
+         const std::chrono::milliseconds duration)
+{
+  std::atomic<uint64_t> total{ 0 };
+  std::vector<std::thread> ts;
+
+  const auto beg = std::chrono::steady_clock::now();
+  const auto end = beg + duration;
+
+  const size_t tcnt = std::max<size_t>(threads, 1);
+  const size_t fcnt = std::max(flows, tcnt);
+
+  for (size_t t = 0; t < tcnt; t++) {
+    ts.emplace_back([&, t] {
+      std::vector<int> fds;
+      for (size_t f = t; f < fcnt; f += tcnt) {
+        const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0) {
+          fds.push_back(fd);
+        }
+      }
+      if (fds.empty()) {
+        return;
+      }
+
+      std::vector<uint8_t> payload(len, static_cast<uint8_t>(t));
+      std::vector<iovec> iov(burst, iovec{ payload.data(), len });
+      std::vector<mmsghdr> msg(burst);
+
+      for (size_t i = 0; i < burst; i++) {
+        msg[i].msg_hdr.msg_name = const_cast<sockaddr_in*>(&dst);
+        msg[i].msg_hdr.msg_namelen = sizeof(dst);
+        msg[i].msg_hdr.msg_iov = &iov[i];
+        msg[i].msg_hdr.msg_iovlen = 1;
+      }
+
+      uint64_t cnt = 0;
+      for (size_t i = 0; std::chrono::steady_clock::now() < end; i++) {
+        const int fd = fds[i % fds.size()];
+        const int s = sendmmsg(fd, msg.data(), burst, 0);
+        cnt += s > 0 ? static_cast<uint64_t>(s) : 0;
+      }
+
+      total.fetch_add(cnt, std::memory_order_relaxed);
+      for (const int fd : fds) {
+        ::close(fd);
+      }
+    });
+  }
+
+  for (auto& t : ts) {
+    t.join();
+  }
+
+  const std::chrono::duration<double> took =
+    std::chrono::steady_clock::now() - beg;
+  return { total.load(), took.count() };
+}
+
+// Packet sink, counting datagrams arriving at given address, until stopped
+struct sink_t
+{
+  sink_t() = default;
+  sink_t(const sink_t&) = delete;
+  sink_t& operator=(const sink_t&) = delete;
+
+  ~sink_t() { stop(); }
+
+  bool start(const sockaddr_in& addr, const size_t burst = 64)
+  {
+    fd = bind_socket(addr);
+    if (fd < 0) {
+      return false;
+    }
+
+    running.store(true, std::memory_order_relaxed);
+    beg = std::chrono::steady_clock::now();
+
+    thread = std::thread([this, burst] {
+      burst_t b(burst);
+      while (running.load(std::memory_order_relaxed)) {
+        const int n =
+          recvmmsg(fd, b.rx_msg.data(), b.n, MSG_WAITFORONE, nullptr);
+        if (n > 0) {
+          cnt.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+        }
+      }
+    });
+
+    return true;
+  }
+
+  // Stops sink, reporting datagrams received since start
+  report_t stop()
+  {
+    if (thread.joinable()) {
+      running.store(false, std::memory_order_relaxed);
+      thread.join();
+      ::close(fd);
+      fd = -1;
+
+      const std::chrono::duration<double> took =
+        std::chrono::steady_clock::now() - beg;
+      secs = took.count();
+    }
+
+    return { cnt.load(), secs };
+  }
+
+private:
+  int fd = -1;
+  double secs = 0.;
+  std::chrono::steady_clock::time_point beg;
+  std::atomic<bool> running{ false };
+  std::atomic<uint64_t> cnt{ 0 };
+  std::thread thread;
+};
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+
+// Statically defined user-level tracepoints ( USDT ), emitted as standard
+// `.note.stapsdt` ELF notes, without depending on systemtap headers, so that
+// production binaries can be traced with bpftrace/ perf, without rebuilding.
+//
+// Each probe site compiles to a single NOP, while note records its address &
+// where to find its arguments; a tracer, when attached, replaces NOP with a
+// breakpoint. No semaphore is used, so arguments ( which are all lengths or
+// flags, already in registers ) are always materialized.
+//
+// Probes, under provider `grain_128aead`
+//
+// - encrypt_entry( dlen, ctlen ), encrypt_return( dlen, ctlen )
+// - decrypt_entry( dlen, ctlen ), decrypt_return( dlen, ctlen, ok )
+// - tag_failure( dlen, ctlen )
+// - initialized, ad_authenticated( dlen ), txt_encrypted( ctlen ),
+// txt_decrypted( ctlen ), txt_reencrypted( ctlen ), finalized | stage
+// boundaries in `aead.hpp`
+//
+// Note, text stage probes fire once per `aead::{enc,dec}_and_auth_txt` call, so
+// decoupled variants ( see decoupled.hpp ) fire them for leftover tail bytes
+// only.
+//
+// List probes with `bpftrace -l 'usdt:./a.out:*'` or `readelf -n ./a.out`, and
+// trace, say, `bpftrace -e 'usdt:./a.out:grain_128aead:tag_failure {
+// @[arg0, arg1] = count(); }'`.
+//
+// Define GRAIN_128AEAD_NO_USDT, for compiling probes out completely.
+
+#if defined __linux__ && (defined __x86_64__ || defined __aarch64__) &&        \
+  !defined GRAIN_128AEAD_NO_USDT
+
+// ELF note, describing probe at preceding NOP ( see
+// https://sourceware.org/systemtap/wiki/UserSpaceProbeImplementation )
+#define GRAIN_USDT_NOTE_(name, args)                                           \
+  "990: nop\n"                                                                 \
+  ".pushsection .note.stapsdt,\"?\",\"note\"\n"                                \
+  ".balign 4\n"                                                                \
+  ".4byte 992f-991f, 994f-993f, 3\n"                                           \
+  "991: .asciz \"stapsdt\"\n"                                                  \
+  "992: .balign 4\n"                                                           \
+  "993: .8byte 990b\n"                                                         \
+  ".8byte _.stapsdt.base\n"                                                    \
+  ".8byte 0\n"                                                                 \
+  ".asciz \"grain_128aead\"\n"                                                 \
+  ".asciz \"" name "\"\n"                                                      \
+  ".asciz \"" args "\"\n"                                                      \
+  "994: .balign 4\n"                                                           \
+  ".popsection\n"                                                              \
+  ".ifndef _.stapsdt.base\n"                                                   \
+  ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"      \
+  ".weak _.stapsdt.base\n"                                                     \
+  ".hidden _.stapsdt.base\n"                                                   \
+  "_.stapsdt.base: .space 1\n"                                                 \
+  ".size _.stapsdt.base, 1\n"                                                  \
+  ".popsection\n"                                                              \
+  ".endif\n"
+
+#define GRAIN_USDT_ARG_(v) "nor"(static_cast<uint64_t>(v))
+
+#define GRAIN_USDT0(name) __asm__ __volatile__(GRAIN_USDT_NOTE_(#name, "") ::)
+
+#define GRAIN_USDT1(name, a)                                                   \
+  __asm__ __volatile__(GRAIN_USDT_NOTE_(#name, "8@%0")::GRAIN_USDT_ARG_(a))
+
+#define GRAIN_USDT2(name, a, b)                                                \
+  __asm__ __volatile__(GRAIN_USDT_NOTE_(#name, "8@%0 8@%1")::GRAIN_USDT_ARG_(  \
+    a), GRAIN_USDT_ARG_(b))
+
+#define GRAIN_USDT3(name, a, b, c)                                             \
+  __asm__ __volatile__(                                                        \
+    GRAIN_USDT_NOTE_(#name, "8@%0 8@%1 8@%2")::GRAIN_USDT_ARG_(a),             \
+    GRAIN_USDT_ARG_(b),                                                        \
+    GRAIN_USDT_ARG_(c))
+
+#else
+
+#define GRAIN_USDT0(name) ((void)0)
+#define GRAIN_USDT1(name, a) ((void)(a))
+#define GRAIN_USDT2(name, a, b) ((void)(a), (void)(b))
+#define GRAIN_USDT3(name, a, b, c) ((void)(a), (void)(b), (void)(c))
+
+#endif
@@ -0,0 +1,292 @@
+#pragma once
+#include "decoupled.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+// Per-thread selection of vector width of decoupled Grain-128 AEAD ( see
+// decoupled.hpp ), accounting for the fact that wide vector instructions ( say
+// AVX-512 ) can lower core frequency for a while after a burst, slowing down
+// scalar code co-located on same core. So wide lanes should only be used when
+// crypto is a large enough share of thread's time to make up for that, not
+// just whenever messages are long.
+//
+// Widths map to lane counts of LFSR word generator, whose segments compiler
+// maps to SIMD registers of 32 -bit words; actual instructions depend on target
+// ( say -march=native ).
+namespace width_policy {
+
+// Vector width, as number of parallel 32 -bit LFSR lanes
+enum class width_t : size_t
+{
+  SCALAR = 1,
+  V256 = 8,
+  V512 = 16
+};
+
+struct config_t
+{
+  size_t min_wide_bytes = 8192; // messages shorter than this ( on average )
+                                // are always processed by scalar kernels
+  double speedup256 = 1.3;      // crypto speedup of 256 -bit over scalar
+  double speedup512 = 1.5;      // crypto speedup of 512 -bit over scalar
+  double penalty256 = 0.03;     // slow down of non-crypto code after 256
+                                // -bit bursts | [0, 1)
+  double penalty512 = 0.12;     // same, after 512 -bit bursts | [0, 1)
+  double alpha = 0.125;         // weight of newest observation, in moving
+                                // averages of batch size & duty cycle
+  double hysteresis = 0.02;     // gain by which new width must beat current
+                                // one, before switching
+  uint64_t idle_reset_ns = 10'000'000; // idle gap, beyond which duty cycle
+                                       // restarts from 0
+#if defined __AVX512F__
+  width_t max_width = width_t::V512; // widest width ever selected
+#else
+  width_t max_width = width_t::V256;
+#endif
+};
+
+struct stats_t
+{
+  uint64_t scalar_calls = 0; // calls processed by scalar kernels
+  uint64_t v256_calls = 0;   // calls processed by 256 -bit kernels
+  uint64_t v512_calls = 0;   // calls processed by 512 -bit kernels
+  uint64_t scalar_bytes = 0; // text bytes processed by scalar kernels
+  uint64_t v256_bytes = 0;   // text bytes processed by 256 -bit kernels
+  uint64_t v512_bytes = 0;   // text bytes processed by 512 -bit kernels
+  uint64_t switches = 0;     // width changes, summed over all threads
+};
+
+// What calling thread has observed so far
+struct observed_t
+{
+  double batch = 0.; // moving average of text length, in bytes
+  double duty = 0.;  // moving average of fraction of time spent in crypto
+  width_t width = width_t::SCALAR; // currently selected width
+};
+
+// Encrypts/ decrypts using `decoupled::{encrypt,decrypt}<lanes>`, where lane
+// count is picked per calling thread. Each call is timed, and together with
+// gap since previous call returned ( on same thread ), it updates moving
+// averages of batch size & duty cycle d. Expected whole-thread gain of width w
+// is then modeled as
+//
+// gain(w) = d * (1 - 1 / speedup(w)) - (1 - d) * penalty(w)
+//
+// i.e. crypto time saved minus non-crypto time lost, with scalar's gain being
+// 0, and width with highest gain is selected ( subject to `min_wide_bytes` &
+// `hysteresis` ). Default speedups/ penalties are rough; calibrate them on
+// target using `mixed_load` benchmark.
+//
+// Per-thread state lives in a thread local, which is reset when calling thread
+// switches to another selector.
+class selector_t
+{
+public:
+  explicit selector_t(const config_t& cfg = {})
+    : cfg(cfg)
+    , id(next_id())
+  {
+  }
+
+  selector_t(const selector_t&) = delete;
+  selector_t& operator=(const selector_t&) = delete;
+
+  // Same as `grain_128aead::encrypt`
+  void encrypt(const uint8_t* const __restrict key,
+               const uint8_t* const __restrict nonce,
+               const uint8_t* const __restrict data,
+               const size_t dlen,
+               const uint8_t* const __restrict txt,
+               uint8_t* const __restrict enc,
+               const size_t ctlen,
+               uint8_t* const __restrict tag)
+  {
+    run(ctlen, [&](const width_t w) {
+      switch (w) {
+        case width_t::V512:
+          decoupled::encrypt<16>(key, nonce, data, dlen, txt, enc, ctlen, tag);
+          break;
+        case width_t::V256:
+          decoupled::encrypt<8>(key, nonce, data, dlen, txt, enc, ctlen, tag);
+          break;
+        default:
+          decoupled::encrypt<1>(key, nonce, data, dlen, txt, enc, ctlen, tag);
+          break;
+      }
+      return true;
+    });
+  }
+
+  // Same as `grain_128aead::decrypt`
+  bool decrypt(const uint8_t* const __restrict key,
+               const uint8_t* const __restrict nonce,
+               const uint8_t* const __restrict tag,
+               const uint8_t* const __restrict data,
+               const size_t dlen,
+               const uint8_t* const __restrict enc,
+               uint8_t* const __restrict txt,
+               const size_t ctlen)
+  {
+    return run(ctlen, [&](const width_t w) {
+      switch (w) {
+        case width_t::V512:
+          return decoupled::decrypt<16>(
+            key, nonce, tag, data, dlen, enc, txt, ctlen);
+        case width_t::V256:
+          return decoupled::decrypt<8>(
+            key, nonce, tag, data, dlen, enc, txt, ctlen);
+        default:
+          return decoupled::decrypt<1>(
+            key, nonce, tag, data, dlen, enc, txt, ctlen);
+      }
+    });
+  }
+
+  // Moving averages & selected width, as seen by calling thread
+  observed_t observed() const
+  {
+    const thread_t& t = local();
+    return observed_t{ t.batch, t.duty, t.width };
+  }
+
+  stats_t stats() const
+  {
+    stats_t s;
+    s.scalar_calls = calls[0].load(std::memory_order_relaxed);
+    s.v256_calls = calls[1].load(std::memory_order_relaxed);
+    s.v512_calls = calls[2].load(std::memory_order_relaxed);
+    s.scalar_bytes = bytes[0].load(std::memory_order_relaxed);
+    s.v256_bytes = bytes[1].load(std::memory_order_relaxed);
+    s.v512_bytes = bytes[2].load(std::memory_order_relaxed);
+    s.switches = switches.load(std::memory_order_relaxed);
+    return s;
+  }
+
+private:
+  using steady_t = std::chrono::steady_clock;
+
+  // Per-thread moving averages
+  struct thread_t
+  {
+    uint64_t owner = 0;
+    double batch = 0.;
+    double duty = 0.;
+    width_t width = width_t::SCALAR;
+    steady_t::time_point last{};
+  };
+
+  // Unique id of a selector, so that thread local state isn't mistaken for
+  // own, when a new selector reuses address of a destroyed one
+  static uint64_t next_id()
+  {
+    static std::atomic<uint64_t> ids{ 0 };
+    return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  // Thread local state of calling thread, reset if it belongs to another
+  // selector
+  thread_t& local() const
+  {
+    static thread_local thread_t t;
+
+    if (t.owner != id) {
+      t = thread_t{};
+      t.owner = id;
+    }
+    return t;
+  }
+
+  // Modeled whole-thread gain of using width `w`, at duty cycle `d`
+  double gain(const width_t w, const double d) const
+  {
+    switch (w) {
+      case width_t::V512:
+        return d * (1. - 1. / cfg.speedup512) - (1. - d) * cfg.penalty512;
+      case width_t::V256:
+        return d * (1. - 1. / cfg.speedup256) - (1. - d) * cfg.penalty256;
+      default:
+        return 0.;
+    }
+  }
+
+  // Picks width for next call, from thread's moving averages
+  width_t select(const thread_t& t) const
+  {
+    if (t.batch < static_cast<double>(cfg.min_wide_bytes)) {
+      return width_t::SCALAR;
+    }
+
+    width_t best = width_t::SCALAR;
+    for (const width_t w : { width_t::V256, width_t::V512 }) {
+      if (w <= cfg.max_width && gain(w, t.duty) > gain(best, t.duty)) {
+        best = w;
+      }
+    }
+
+    if (t.width > cfg.max_width) {
+      return best;
+    }
+    return gain(best, t.duty) > gain(t.width, t.duty) + cfg.hysteresis
+             ? best
+             : t.width;
+  }
+
+  static size_t index(const width_t w)
+  {
+    return w == width_t::V512 ? 2 : w == width_t::V256 ? 1 : 0;
+  }
+
+  // Selects width, runs `fn` with it, timing it, and updates moving averages
+  template<typename F>
+  bool run(const size_t ctlen, F&& fn)
+  {
+    thread_t& t = local();
+
+    const double a = cfg.alpha;
+    const auto t0 = steady_t::now();
+
+    const bool first = t.last == steady_t::time_point{};
+    t.batch = first ? static_cast<double>(ctlen)
+                    : t.batch + a * (static_cast<double>(ctlen) - t.batch);
+
+    const width_t w = select(t);
+    if (w != t.width) {
+      switches.fetch_add(1, std::memory_order_relaxed);
+      t.width = w;
+    }
+
+    const bool ok = fn(w);
+    const auto t1 = steady_t::now();
+
+    const size_t i = index(w);
+    calls[i].fetch_add(1, std::memory_order_relaxed);
+    bytes[i].fetch_add(ctlen, std::memory_order_relaxed);
+
+    using ns = std::chrono::nanoseconds;
+    const double busy = static_cast<double>(
+      std::chrono::duration_cast<ns>(t1 - t0).count());
+    const double idle = static_cast<double>(
+      std::chrono::duration_cast<ns>(t0 - t.last).count());
+
+    if (first) {
+      // no previous call on this thread, so idle gap is unknown
+    } else if (idle > static_cast<double>(cfg.idle_reset_ns)) {
+      t.duty = 0.;
+    } else {
+      t.duty += a * (busy / std::max(busy + idle, 1.) - t.duty);
+    }
+    t.last = t1;
+
+    return ok;
+  }
+
+  const config_t cfg;
+  const uint64_t id;
+
+  std::atomic<uint64_t> calls[3]{};
+  std::atomic<uint64_t> bytes[3]{};
+  std::atomic<uint64_t> switches{ 0 };
+};
+
+}
@@ -0,0 +1,258 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed size native worker pool, used for offloading Grain-128 AEAD jobs from
+// caller threads
+namespace worker_pool {
+
+// Job type, executed on one of the worker threads
+using job_t = std::function<void()>;
+
+// Pool of N worker threads with work stealing. Each worker owns a job deque;
+// jobs submitted from a worker thread ( say a job splitting itself into
+// smaller ones ) go to that worker's own deque, which it pops in LIFO order,
+// for cache locality, while idle workers steal from other deques in FIFO order.
+// Jobs submitted from outside the pool are spread across deques, round-robin.
+//
+// Workers are started in constructor and joined in destructor, after all queued
+// jobs ( including ones submitted by jobs, while draining ) are executed.
+struct pool_t
+{
+  explicit pool_t(const size_t n)
+  {
+    const size_t cnt = n > 0 ? n : default_size();
+
+    queues.reserve(cnt);
+    for (size_t i = 0; i < cnt; i++) {
+      queues.emplace_back(std::make_unique<queue_t>());
+    }
+
+    workers.reserve(cnt);
+    for (size_t i = 0; i < cnt; i++) {
+      workers.emplace_back([this, i] { run(i); });
+    }
+  }
+
+  pool_t(const pool_t&) = delete;
+  pool_t& operator=(const pool_t&) = delete;
+
+  ~pool_t()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stop = true;
+    }
+
+    cv.notify_all();
+
+    for (auto& w : workers) {
+      w.join();
+    }
+  }
+
+  // Number of worker threads, to be used when no preference is given
+  static size_t default_size()
+  {
+    const size_t n = static_cast<size_t>(std::thread::hardware_concurrency());
+    return n > 0 ? n : 1ul;
+  }
+
+  // Number of worker threads in this pool
+  size_t size() const { return workers.size(); }
+
+  // Enqueues single job, waking up one idle worker
+  void submit(job_t job)
+  {
+    // counted before being queued, so that it never drops below zero, when a
+    // worker takes job right away
+    pending.fetch_add(1, std::memory_order_release);
+
+    {
+      queue_t& q = *queues[target()];
+      std::lock_guard<std::mutex> lock(q.mtx);
+      q.jobs.push_back(std::move(job));
+    }
+
+    wake(false);
+  }
+
+  // Enqueues a batch of jobs, spreading them across deques ( or keeping them on
+  // calling worker's own deque, from where they can be stolen ), while
+  // acquiring each deque lock only once
+  void submit_batch(std::vector<job_t>&& batch)
+  {
+    if (batch.empty()) {
+      return;
+    }
+
+    pending.fetch_add(batch.size(), std::memory_order_release);
+
+    const size_t own = current_worker();
+
+    if (own < queues.size()) {
+      queue_t& q = *queues[own];
+      std::lock_guard<std::mutex> lock(q.mtx);
+      for (auto& job : batch) {
+        q.jobs.push_back(std::move(job));
+      }
+    } else {
+      const size_t qcnt = queues.size();
+      const size_t start = next.fetch_add(1, std::memory_order_relaxed);
+
+      for (size_t k = 0; k < qcnt; k++) {
+        queue_t& q = *queues[(start + k) % qcnt];
+        std::lock_guard<std::mutex> lock(q.mtx);
+        for (size_t i = k; i < batch.size(); i += qcnt) {
+          q.jobs.push_back(std::move(batch[i]));
+        }
+      }
+    }
+
+    wake(true);
+  }
+
+  // Enqueues a batch of jobs and blocks calling thread, until all of them are
+  // executed; must not be called from a worker thread of same pool
+  void run_batch(std::vector<job_t>&& batch)
+  {
+    std::mutex done_mtx;
+    std::condition_variable done_cv;
+    size_t remaining = batch.size();
+
+    std::vector<job_t> wrapped;
+    wrapped.reserve(batch.size());
+
+    for (auto& job : batch) {
+      wrapped.emplace_back([&, job = std::move(job)] {
+        job();
+
+        std::lock_guard<std::mutex> lock(done_mtx);
+        if (--remaining == 0) {
+          done_cv.notify_one();
+        }
+      });
+    }
+
+    submit_batch(std::move(wrapped));
+
+    std::unique_lock<std::mutex> lock(done_mtx);
+    done_cv.wait(lock, [&] { return remaining == 0; });
+  }
+
+private:
+  // Job deque of a worker
+  struct queue_t
+  {
+    std::mutex mtx;
+    std::deque<job_t> jobs;
+  };
+
+  // Index of calling worker thread, if it belongs to this pool, otherwise an
+  // index past end of worker list
+  size_t current_worker() const
+  {
+    return tls_pool == this ? tls_index : queues.size();
+  }
+
+  // Deque, where a job submitted by calling thread should go
+  size_t target()
+  {
+    const size_t own = current_worker();
+    if (own < queues.size()) {
+      return own;
+    }
+    return next.fetch_add(1, std::memory_order_relaxed) % queues.size();
+  }
+
+  // Wakes up idle worker(s); taking sleep lock makes sure a worker, which just
+  // found all deques empty, doesn't miss this wake up
+  void wake(const bool all)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+    }
+
+    if (all) {
+      cv.notify_all();
+    } else {
+      cv.notify_one();
+    }
+  }
+
+  // Pops a job from own deque ( LIFO ) or steals one from some other deque (
+  // FIFO ), returning false if all deques are empty
+  bool take(const size_t idx, job_t& job)
+  {
+    {
+      queue_t& q = *queues[idx];
+      std::lock_guard<std::mutex> lock(q.mtx);
+      if (!q.jobs.empty()) {
+        job = std::move(q.jobs.back());
+        q.jobs.pop_back();
+        return true;
+      }
+    }
+
+    const size_t qcnt = queues.size();
+    for (size_t k = 1; k < qcnt; k++) {
+      queue_t& q = *queues[(idx + k) % qcnt];
+      std::lock_guard<std::mutex> lock(q.mtx);
+      if (!q.jobs.empty()) {
+        job = std::move(q.jobs.front());
+        q.jobs.pop_front();
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Worker loop, which keeps executing jobs until pool is asked to stop and all
+  // deques are drained
+  void run(const size_t idx)
+  {
+    tls_pool = this;
+    tls_index = idx;
+
+    while (true) {
+      job_t job;
+
+      if (take(idx, job)) {
+        pending.fetch_sub(1, std::memory_order_relaxed);
+        job();
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait(lock, [this] {
+        return stop || pending.load(std::memory_order_acquire) > 0;
+      });
+
+      if (stop && pending.load(std::memory_order_acquire) == 0) {
+        return;
+      }
+    }
+  }
+
+  static inline thread_local const pool_t* tls_pool = nullptr;
+  static inline thread_local size_t tls_index = 0;
+
+  std::vector<std::unique_ptr<queue_t>> queues;
+  std::atomic<size_t> next{ 0 };
+  std::atomic<size_t> pending{ 0 };
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::vector<std::thread> workers;
+  bool stop = false;
+};
+
+}
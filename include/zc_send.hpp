@@ -0,0 +1,563 @@
+#pragma once
+#include "grain_128aead.hpp"
+#include <cerrno>
+#include <deque>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#if defined __linux__
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#endif
+
+// Streams a file over a connected stream socket, as a sequence of Grain-128
+// AEAD sealed records, where file is read through a read-only mapping, each
+// chunk is encrypted straight into one of a ring of locked send buffers, which
+// is transmitted using MSG_ZEROCOPY and recycled once kernel notifies ( on
+// socket error queue ) that it's done with it. So no user space read buffer is
+// needed and kernel doesn't copy cipher text into socket buffers.
+//
+// Where zero-copy isn't available ( SO_ZEROCOPY rejected, kernel running out of
+// option memory, or kernel reporting that it copied anyway, as it always does
+// for loopback ), sender falls back to regular sends from same ring.
+namespace zc_send {
+
+// Sealed record layout
+//
+// [ 8 -bytes record index ] [ 4 -bytes length ] [ cipher text ] [ 8 -bytes
+// authentication tag ]
+//
+// where both header fields are little endian encoded, most significant bit of
+// length marks last record of stream and whole 12 -bytes header is used as
+// associated data. Nonce of record is derived from base nonce and record index
+// ( see `grain_128aead::derive_nonce` ). Last record is always sent ( possibly
+// empty ), so that truncated streams are detected.
+constexpr size_t HDR_LEN = 12;
+constexpr size_t TAG_LEN = 8;
+
+// Marks last record of stream, in length field of header
+constexpr uint32_t LAST = 1u << 31;
+
+// Encodes record header
+inline static void
+encode_header(const uint64_t idx, const uint32_t len, uint8_t* const hdr)
+{
+  for (size_t i = 0; i < 8; i++) {
+    hdr[i] = static_cast<uint8_t>(idx >> (i << 3));
+  }
+  for (size_t i = 0; i < 4; i++) {
+    hdr[8 + i] = static_cast<uint8_t>(len >> (i << 3));
+  }
+}
+
+// Decodes record header
+inline static void
+decode_header(const uint8_t* const hdr, uint64_t& idx, uint32_t& len)
+{
+  idx = 0ul;
+  for (size_t i = 0; i < 8; i++) {
+    idx |= static_cast<uint64_t>(hdr[i]) << (i << 3);
+  }
+  len = 0u;
+  for (size_t i = 0; i < 4; i++) {
+    len |= static_cast<uint32_t>(hdr[8 + i]) << (i << 3);
+  }
+}
+
+// Seals `len` -bytes of plain text as record `idx` into `rec`, which must have
+// room for `HDR_LEN + len + TAG_LEN` -bytes
+inline static void
+seal_record(const uint8_t* const __restrict key,  // 128 -bit secret key
+            const uint8_t* const __restrict base, // 96 -bit base nonce
+            const uint64_t idx,
+            const bool last,
+            const uint8_t* const __restrict txt, // len -bytes plain text
+            const size_t len,                    // < 2^31
+            uint8_t* const __restrict rec        // sealed record
+)
+{
+  uint8_t nonce[12];
+  grain_128aead::derive_nonce(base, idx, nonce);
+
+  const uint32_t hlen = static_cast<uint32_t>(len) | (last ? LAST : 0u);
+  encode_header(idx, hlen, rec);
+
+  uint8_t* const enc = rec + HDR_LEN;
+  grain_128aead::encrypt(key, nonce, rec, HDR_LEN, txt, enc, len, enc + len);
+}
+
+struct config_t
+{
+  size_t chunk = 1ul << 16; // plain text bytes per record | (0, 2^31)
+  size_t ring = 16;         // number of send buffers | > 0
+  bool zerocopy = true;     // try MSG_ZEROCOPY, when available
+  size_t probe = 64;        // completed sends after which zero-copy is turned
+                            // off, if kernel copied all of them
+};
+
+struct stats_t
+{
+  uint64_t records = 0;     // records sent
+  uint64_t bytes = 0;       // sealed bytes sent
+  uint64_t zc_sends = 0;    // send calls made with MSG_ZEROCOPY
+  uint64_t plain_sends = 0; // send calls made without it
+  uint64_t completions = 0; // zero-copy sends completed
+  uint64_t copied = 0;      // of which kernel copied data anyway
+  bool zerocopy = false;    // whether zero-copy was still on, at end
+};
+
+// Sends whole buffer, using regular send calls; false on error
+inline static bool
+send_all(const int sock,
+         const uint8_t* const buf,
+         const size_t len,
+         stats_t& st)
+{
+  size_t off = 0;
+  while (off < len) {
+    const ssize_t n = send(sock, buf + off, len - off, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+
+    st.plain_sends++;
+    off += static_cast<size_t>(n);
+  }
+
+  return true;
+}
+
+// Receives exactly `len` -bytes, false on error or end of stream
+inline static bool
+recv_all(const int sock, uint8_t* const buf, const size_t len)
+{
+  size_t off = 0;
+  while (off < len) {
+    const ssize_t n = recv(sock, buf + off, len - off, 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+
+    off += static_cast<size_t>(n);
+  }
+
+  return true;
+}
+
+// Streaming sender, bound to a connected stream socket, owning a ring of send
+// buffers, each holding one sealed record, which are transmitted with
+// MSG_ZEROCOPY ( while it's on ) and handed out again only after kernel
+// completes all zero-copy sends referring to them.
+//
+// Kernel numbers zero-copy sends per socket, so keep one sender per socket,
+// for its whole lifetime, sending any number of files through it.
+class sender_t
+{
+public:
+  sender_t(const int sock, const config_t& cfg = {})
+    : sock(sock)
+    , cfg(cfg)
+    , stride((HDR_LEN + cfg.chunk + TAG_LEN + 4095ul) & ~4095ul)
+    , pending(cfg.ring, 0)
+  {
+    if (cfg.chunk == 0 || cfg.chunk >= LAST || cfg.ring == 0) {
+      return;
+    }
+
+    void* const mem = mmap(nullptr,
+                           stride * cfg.ring,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS,
+                           -1,
+                           0);
+    if (mem == MAP_FAILED) {
+      return;
+    }
+
+    bufs = static_cast<uint8_t*>(mem);
+    // best effort, RLIMIT_MEMLOCK may not allow it
+    mlock(bufs, stride * cfg.ring);
+
+#if defined SO_ZEROCOPY && defined MSG_ZEROCOPY
+    const int one = 1;
+    zc = cfg.zerocopy &&
+         setsockopt(sock, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+#endif
+  }
+
+  sender_t(const sender_t&) = delete;
+  sender_t& operator=(const sender_t&) = delete;
+
+  // Unmapping ring is safe even with sends in flight, as kernel holds its own
+  // references to pages, so there's no waiting for completions here
+  ~sender_t()
+  {
+    if (bufs != nullptr) {
+      munmap(bufs, stride * cfg.ring);
+    }
+  }
+
+  // Whether send buffers could be set up ( and config is valid )
+  bool ok() const { return bufs != nullptr; }
+
+  stats_t stats() const
+  {
+    stats_t s = st;
+    s.zerocopy = zc;
+    return s;
+  }
+
+  // Streams first `flen` -bytes of file `in_fd` as sealed records of
+  // `cfg.chunk` -bytes plain text each. Returns false if file is shorter than
+  // `flen` -bytes ( touching mapping beyond end of file raises SIGBUS ), can't
+  // be mapped or sending fails, in which case stream is incomplete ( receiver
+  // notices, as last record never arrives ) and socket shouldn't be used any
+  // further.
+  //
+  // Returns as soon as last record is handed to kernel, which may still be
+  // reading ring buffers; see `drain`.
+  //
+  // Base nonce must never be reused under same secret key, for another stream.
+  bool send_file(const uint8_t* const __restrict key,   // 128 -bit secret key
+                 const uint8_t* const __restrict nonce, // 96 -bit base nonce
+                 const int in_fd,                       // plain text file
+                 const size_t flen                      // bytes to send | >= 0
+  )
+  {
+    if (!ok()) {
+      return false;
+    }
+
+    struct stat sb;
+    if (fstat(in_fd, &sb) != 0 || sb.st_size < 0 ||
+        static_cast<uint64_t>(sb.st_size) < flen) {
+      return false;
+    }
+
+    const uint8_t* src = nullptr;
+    if (flen > 0) {
+      void* const mem = mmap(nullptr, flen, PROT_READ, MAP_PRIVATE, in_fd, 0);
+      if (mem == MAP_FAILED) {
+        return false;
+      }
+
+      src = static_cast<const uint8_t*>(mem);
+      madvise(mem, flen, MADV_SEQUENTIAL);
+    }
+
+    const size_t cnt = flen == 0 ? 1 : (flen + cfg.chunk - 1) / cfg.chunk;
+    bool sent = true;
+
+    for (size_t i = 0; sent && i < cnt; i++) {
+      const size_t off = i * cfg.chunk;
+      const size_t len = std::min(cfg.chunk, flen - off);
+      const size_t slot = next++ % cfg.ring;
+
+      uint8_t* const rec = acquire(slot);
+      if (rec == nullptr) {
+        sent = false;
+        break;
+      }
+
+      seal_record(key, nonce, i, i + 1 == cnt, src + off, len, rec);
+      sent = send(slot, HDR_LEN + len + TAG_LEN);
+
+      st.records++;
+      st.bytes += HDR_LEN + len + TAG_LEN;
+    }
+
+    if (src != nullptr) {
+      munmap(const_cast<uint8_t*>(src), flen);
+    }
+    return sent;
+  }
+
+  // Waits for all zero-copy sends to complete; false on socket error
+  bool drain()
+  {
+    while (!inflight.empty()) {
+      if (!reap(true)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  // Returns buffer `slot`, waiting till kernel is done with it; nullptr on
+  // socket error
+  uint8_t* acquire(const size_t slot)
+  {
+    while (pending[slot] > 0) {
+      if (!reap(true)) {
+        return nullptr;
+      }
+    }
+    return bufs + slot * stride;
+  }
+
+  // Transmits first `len` -bytes of buffer `slot`; false on socket error
+  bool send(const size_t slot, const size_t len)
+  {
+    const uint8_t* const buf = bufs + slot * stride;
+
+#if defined MSG_ZEROCOPY
+    size_t off = 0;
+    while (zc && off < len) {
+      const ssize_t n =
+        ::send(sock, buf + off, len - off, MSG_ZEROCOPY | MSG_NOSIGNAL);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno != ENOBUFS) {
+          return false;
+        }
+
+        // out of option memory for pinning pages; wait for completions, if
+        // any, otherwise send rest of buffer by copying
+        if (inflight.empty()) {
+          return send_all(sock, buf + off, len - off, st);
+        }
+        if (!reap(true)) {
+          return false;
+        }
+        continue;
+      }
+
+      st.zc_sends++;
+      inflight.emplace_back(seq++, slot);
+      pending[slot]++;
+      off += static_cast<size_t>(n);
+    }
+
+    return send_all(sock, buf + off, len - off, st);
+#else
+    return send_all(sock, buf, len, st);
+#endif
+  }
+
+  // Reads completion notifications from socket error queue, blocking till at
+  // least one arrives, when `block` is set; false on socket error
+  bool reap(const bool block)
+  {
+#if defined __linux__ && defined SO_EE_ORIGIN_ZEROCOPY
+    bool got = false;
+
+    while (true) {
+      alignas(cmsghdr) uint8_t ctl[128];
+
+      msghdr msg{};
+      msg.msg_control = ctl;
+      msg.msg_controllen = sizeof(ctl);
+
+      const ssize_t n = recvmsg(sock, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+          return false;
+        }
+        if (got || !block) {
+          return true;
+        }
+
+        // error queue is empty; wait till it's not ( reported as POLLERR )
+        pollfd pfd{ sock, 0, 0 };
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+          return false;
+        }
+        if ((pfd.revents & POLLHUP) != 0 || pending_error()) {
+          return false;
+        }
+        continue;
+      }
+
+      for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c != nullptr;
+           c = CMSG_NXTHDR(&msg, c)) {
+        const bool v4 = c->cmsg_level == SOL_IP && c->cmsg_type == IP_RECVERR;
+        const bool v6 =
+          c->cmsg_level == SOL_IPV6 && c->cmsg_type == IPV6_RECVERR;
+        if (!v4 && !v6) {
+          continue;
+        }
+
+        sock_extended_err err;
+        std::memcpy(&err, CMSG_DATA(c), sizeof(err));
+
+        if (err.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+          return false;
+        }
+
+        complete(err.ee_info,
+                 err.ee_data,
+                 (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0);
+        got = true;
+      }
+    }
+#else
+    (void)block;
+    return inflight.empty();
+#endif
+  }
+
+  // Whether socket has an error pending, other than completion notifications
+  bool pending_error() const
+  {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    return getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0;
+  }
+
+  // Releases zero-copy sends with sequence numbers in [lo, hi]
+  void complete(const uint32_t lo, const uint32_t hi, const bool copied)
+  {
+    const uint32_t span = hi - lo;
+
+    for (auto it = inflight.begin(); it != inflight.end();) {
+      if (it->first - lo <= span) {
+        pending[it->second]--;
+        it = inflight.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    const uint64_t cnt = static_cast<uint64_t>(span) + 1;
+    st.completions += cnt;
+    st.copied += copied ? cnt : 0;
+
+    // kernel keeps copying ( say over loopback ), which makes zero-copy more
+    // expensive than regular sends, so stop asking for it
+    if (st.completions >= cfg.probe && st.copied == st.completions) {
+      zc = false;
+    }
+  }
+
+  const int sock;
+  const config_t cfg;
+  stats_t st{};
+
+  const size_t stride;
+  uint8_t* bufs = nullptr;
+  bool zc = false;
+
+  size_t next = 0;  // slot of next record
+  uint32_t seq = 0; // sequence number of next zero-copy send
+  std::deque<std::pair<uint32_t, size_t>> inflight; // ( seq, slot )
+  std::vector<size_t> pending; // in-flight zero-copy sends per slot
+};
+
+// Same as `sender_t::send_file`, using plain read/ encrypt/ send loop, with one
+// read buffer and one send buffer, for reference & benchmarking
+static bool
+send_file_copy(const uint8_t* const __restrict key,   // 128 -bit secret key
+               const uint8_t* const __restrict nonce, // 96 -bit base nonce
+               const int in_fd,                       // plain text file
+               const size_t flen,                     // bytes to send | >= 0
+               const int sock,                        // connected socket
+               const size_t chunk = 1ul << 16         // | (0, 2^31)
+)
+{
+  if (chunk == 0 || chunk >= LAST) {
+    return false;
+  }
+
+  std::vector<uint8_t> txt(chunk);
+  std::vector<uint8_t> rec(HDR_LEN + chunk + TAG_LEN);
+
+  stats_t st;
+
+  const size_t cnt = flen == 0 ? 1 : (flen + chunk - 1) / chunk;
+
+  for (size_t i = 0; i < cnt; i++) {
+    const size_t off = i * chunk;
+    const size_t len = std::min(chunk, flen - off);
+
+    const ssize_t rd = pread(in_fd, txt.data(), len, static_cast<off_t>(off));
+    if (rd != static_cast<ssize_t>(len)) {
+      return false;
+    }
+
+    seal_record(key, nonce, i, i + 1 == cnt, txt.data(), len, rec.data());
+    if (!send_all(sock, rec.data(), HDR_LEN + len + TAG_LEN, st)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Receives a stream of sealed records ( sent by `sender_t::send_file` ) from
+// socket, appending decrypted plain text to `out`. Returns true only if all
+// records are authentic, in order, and last record was received.
+//
+// Records claiming more than `max_chunk` -bytes plain text are rejected before
+// anything is allocated for them, so that unauthenticated length field can't
+// make receiver allocate up to 2 GB per record; set it to sender's chunk size.
+inline static bool
+recv_file(const uint8_t* const __restrict key,   // 128 -bit secret key
+          const uint8_t* const __restrict nonce, // 96 -bit base nonce
+          const int sock,                        // connected stream socket
+          std::vector<uint8_t>& out,             // decrypted plain text
+          const size_t max_chunk = 1ul << 16     // | > 0
+)
+{
+  std::vector<uint8_t> rec;
+
+  for (uint64_t i = 0;; i++) {
+    uint8_t hdr[HDR_LEN];
+    if (!recv_all(sock, hdr, HDR_LEN)) {
+      return false;
+    }
+
+    uint64_t idx = 0;
+    uint32_t hlen = 0;
+    decode_header(hdr, idx, hlen);
+
+    const size_t len = hlen & ~LAST;
+    if (idx != i || len > max_chunk) {
+      return false;
+    }
+
+    rec.resize(len + TAG_LEN);
+    if (!recv_all(sock, rec.data(), rec.size())) {
+      return false;
+    }
+
+    uint8_t rnonce[12];
+    grain_128aead::derive_nonce(nonce, idx, rnonce);
+
+    const size_t base = out.size();
+    out.resize(base + len);
+
+    const bool ok = grain_128aead::decrypt(key,
+                                           rnonce,
+                                           rec.data() + len,
+                                           hdr,
+                                           HDR_LEN,
+                                           rec.data(),
+                                           out.data() + base,
+                                           len);
+    if (!ok) {
+      out.resize(base);
+      return false;
+    }
+    if ((hlen & LAST) != 0) {
+      return true;
+    }
+  }
+}
+
+}
@@ -0,0 +1,165 @@
+#include "checksum.hpp"
+#include "grain_128aead.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Tests streaming checksums ( see checksum.hpp ) against known CRC32C &
+// xxHash32 vectors, checking that digests don't depend on how input is split
+// into words/ bytes and that checksums fused into encryption/ decryption match
+// standalone ones, computed over cipher text.
+
+struct vector_t
+{
+  std::vector<uint8_t> msg;
+  uint32_t crc32c;
+  uint32_t xxh32;      // seed = 0
+  uint32_t xxh32_seed; // seed = 0x9e3779b1
+};
+
+static std::vector<uint8_t>
+bytes_of(const char* const str)
+{
+  return std::vector<uint8_t>(str, str + std::strlen(str));
+}
+
+static std::vector<vector_t>
+known_vectors()
+{
+  std::vector<vector_t> v;
+
+  v.push_back({ {}, 0x00000000u, 0x02cc5d05u, 0x36b78ae7u });
+  v.push_back({ bytes_of("a"), 0xc1d04330u, 0x550d7456u, 0x9e1633e4u });
+  v.push_back({ bytes_of("abc"), 0x364b3fb7u, 0x32d153ffu, 0xa1ae7709u });
+  v.push_back({ bytes_of("123456789"), 0xe3069283u, 0x937bad67u, 0x9355e7ecu });
+  v.push_back({ bytes_of("Nobody inspects the spammish repetition"),
+                0x2cc89212u,
+                0xe2293b2fu,
+                0xc9e89e68u });
+
+  // RFC 3720, section B.4
+  std::vector<uint8_t> msg(32, 0x00);
+  v.push_back({ msg, 0x8a9136aau, 0x2ca90bd2u, 0x8a3c233bu });
+
+  msg.assign(32, 0xff);
+  v.push_back({ msg, 0x62a8ab43u, 0xd03c6d18u, 0x7c1341d8u });
+
+  for (size_t i = 0; i < msg.size(); i++) {
+    msg[i] = static_cast<uint8_t>(i);
+  }
+  v.push_back({ msg, 0x46dd794eu, 0x830741c1u, 0x8535b112u });
+
+  // several 16 -bytes stripes, followed by trailing bytes
+  msg.resize(1024);
+  for (size_t i = 0; i < msg.size(); i++) {
+    msg[i] = static_cast<uint8_t>(i);
+  }
+  msg.insert(msg.end(), { 'x', 'y', 'z' });
+  v.push_back({ msg, 0x1b222f45u, 0x7202bd2bu, 0x0bafead1u });
+
+  return v;
+}
+
+// Absorbs message, alternating between single bytes & little endian words, so
+// that words land on both aligned & unaligned offsets
+template<typename S>
+static uint32_t
+split_digest(S sum, const std::vector<uint8_t>& msg, const size_t pattern)
+{
+  size_t off = 0;
+  size_t i = 0;
+
+  while (off < msg.size()) {
+    const bool as_byte = (pattern >> (i++ & 7)) & 1ul;
+
+    if (as_byte || msg.size() - off < 4) {
+      sum.update(msg[off]);
+      off += 1;
+    } else {
+      uint32_t w = 0;
+      for (size_t j = 0; j < 4; j++) {
+        w |= static_cast<uint32_t>(msg[off + j]) << (j << 3);
+      }
+      sum.update(w);
+      off += 4;
+    }
+  }
+
+  return sum.digest();
+}
+
+template<typename S>
+static void
+check_fused(S sum)
+{
+  uint8_t key[16], nonce[12], data[32], tag[8];
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+  random_data(data, sizeof(data));
+
+  for (const size_t ctlen : { 0ul, 1ul, 3ul, 4ul, 15ul, 64ul, 1001ul }) {
+    std::vector<uint8_t> txt(ctlen), enc(ctlen), dec(ctlen);
+    random_data(txt.data(), ctlen);
+
+    S esum = sum;
+    grain_128aead::encrypt_checksum(key,
+                                    nonce,
+                                    data,
+                                    sizeof(data),
+                                    txt.data(),
+                                    enc.data(),
+                                    ctlen,
+                                    tag,
+                                    esum);
+
+    S ref = sum;
+    ref.update(enc.data(), ctlen);
+    assert(esum.digest() == ref.digest());
+
+    S dsum = sum;
+    [[maybe_unused]] const bool ok =
+      grain_128aead::decrypt_checksum(key,
+                                      nonce,
+                                      tag,
+                                      data,
+                                      sizeof(data),
+                                      enc.data(),
+                                      dec.data(),
+                                      ctlen,
+                                      dsum);
+    assert(ok);
+    assert(dsum.digest() == ref.digest());
+    assert(txt == dec);
+  }
+}
+
+int
+main()
+{
+  for (const auto& v : known_vectors()) {
+    checksum::crc32c_t crc;
+    checksum::xxh32_t xxh;
+    checksum::xxh32_t xxh_seed(0x9e3779b1u);
+
+    crc.update(v.msg.data(), v.msg.size());
+    xxh.update(v.msg.data(), v.msg.size());
+    xxh_seed.update(v.msg.data(), v.msg.size());
+
+    assert(crc.digest() == v.crc32c);
+    assert(xxh.digest() == v.xxh32);
+    assert(xxh_seed.digest() == v.xxh32_seed);
+
+    for (const size_t pattern : { 0x00ul, 0xfful, 0x01ul, 0x5aul, 0xc3ul }) {
+      assert(split_digest(checksum::crc32c_t{}, v.msg, pattern) == v.crc32c);
+      assert(split_digest(checksum::xxh32_t{}, v.msg, pattern) == v.xxh32);
+    }
+  }
+
+  check_fused(checksum::crc32c_t{});
+  check_fused(checksum::xxh32_t{ 0x9e3779b1u });
+
+  std::cout << "[test] checksum : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
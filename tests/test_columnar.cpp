@@ -0,0 +1,229 @@
+#include "columnar.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Tests columnar container ( see columnar.hpp ), checking that projected
+// columns of selected batches round trip, both serially & on a worker pool,
+// that tampered schema/ directory entries, wrong keys & truncated containers
+// are all rejected, and that batch indices past 16 bits get nonces of their
+// own.
+
+using batch_t = std::vector<std::vector<uint8_t>>;
+
+constexpr size_t NBATCH = 5;
+constexpr size_t NCOL = 3;
+
+static std::vector<uint8_t>
+build(const uint8_t* const key,
+      const uint8_t* const nonce,
+      std::vector<batch_t>& src)
+{
+  std::vector<columnar::column_t> schema{ { "id", 1 },
+                                          { "price", 2 },
+                                          { "name", 3 } };
+  columnar::writer_t w(key, nonce, schema);
+  assert(w.valid());
+
+  src.resize(NBATCH);
+  for (uint32_t b = 0; b < NBATCH; b++) {
+    const uint8_t* cols[NCOL];
+    size_t lens[NCOL];
+
+    for (size_t c = 0; c < NCOL; c++) {
+      // empty column in first batch, too
+      src[b].emplace_back(100 * b + 7 * c);
+      random_data(src[b][c].data(), src[b][c].size());
+      cols[c] = src[b][c].data();
+      lens[c] = src[b][c].size();
+    }
+
+    [[maybe_unused]] const bool ok = w.add_batch(10 + b, cols, lens);
+    assert(ok);
+  }
+
+  return w.finish();
+}
+
+// Output buffers for given batches & columns, in `reader_t::read` order
+static std::vector<uint8_t*>
+alloc_out(const columnar::reader_t& r,
+          const std::vector<uint32_t>& bs,
+          const std::vector<uint16_t>& cs)
+{
+  std::vector<uint8_t*> out;
+  for (const uint32_t b : bs) {
+    for (const uint16_t c : cs) {
+      out.push_back(columnar::alloc_column(r.column_len(b, c) + 1));
+    }
+  }
+  return out;
+}
+
+static bool
+read_all(const columnar::reader_t& r,
+         const uint8_t* const key,
+         const std::vector<uint32_t>& bs,
+         const std::vector<uint16_t>& cs,
+         const std::vector<uint8_t*>& out,
+         worker_pool::pool_t* const pool)
+{
+  return r.read(
+    key, bs.data(), bs.size(), cs.data(), cs.size(), out.data(), pool);
+}
+
+static void
+free_out(std::vector<uint8_t*>& out)
+{
+  for (auto p : out) {
+    std::free(p);
+  }
+  out.clear();
+}
+
+int
+main()
+{
+  uint8_t key[16], nonce[12];
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+
+  std::vector<batch_t> src;
+  const auto buf = build(key, nonce, src);
+
+  worker_pool::pool_t pool(4);
+  const std::vector<uint32_t> bs{ 4, 0, 2 };
+  const std::vector<uint16_t> cs{ 2, 1 };
+
+  // projected columns of selected batches round trip
+  {
+    columnar::reader_t r;
+    assert(r.open(buf.data(), buf.size()));
+    assert(r.batches() == NBATCH && r.columns() == NCOL);
+    assert(r.column_index("price") == 1 && r.column_index("qty") == -1);
+    assert(r.rows(3) == 13);
+
+    auto out = alloc_out(r, bs, cs);
+    for (auto* p : { static_cast<worker_pool::pool_t*>(nullptr), &pool }) {
+      assert(read_all(r, key, bs, cs, out, p));
+
+      for (size_t i = 0; i < bs.size(); i++) {
+        for (size_t j = 0; j < cs.size(); j++) {
+          const auto& exp = src[bs[i]][cs[j]];
+          const uint8_t* const got = out[i * cs.size() + j];
+          assert(std::memcmp(got, exp.data(), exp.size()) == 0);
+        }
+      }
+    }
+
+    // out of range batch/ column
+    const uint32_t bad_b = NBATCH;
+    const uint16_t bad_c = NCOL;
+    assert(!r.read(key, &bad_b, 1, cs.data(), 1, out.data(), nullptr));
+    assert(!r.read(key, bs.data(), 1, &bad_c, 1, out.data(), nullptr));
+
+    // wrong key
+    uint8_t bad_key[16];
+    std::memcpy(bad_key, key, sizeof(key));
+    bad_key[0] ^= 1;
+    assert(!read_all(r, bad_key, bs, cs, out, &pool));
+
+    free_out(out);
+  }
+
+  // flipping type of column "name" in schema fails its reads only
+  {
+    auto bad = buf;
+    bad[columnar::HDR_LEN + (2 + 2) + (2 + 5)] ^= 1;
+
+    columnar::reader_t r;
+    assert(r.open(bad.data(), bad.size()));
+
+    auto out = alloc_out(r, bs, cs);
+    assert(!read_all(r, key, bs, cs, out, &pool));
+    free_out(out);
+
+    out = alloc_out(r, bs, { 1 });
+    assert(read_all(r, key, bs, { 1 }, out, &pool));
+    free_out(out);
+  }
+
+  // flipping tag of one column fails that column only, zeroing its output
+  {
+    const size_t schema_len = (2 + 2) + (2 + 5) + (2 + 4);
+    const size_t bentry = 4 + NCOL * columnar::ENTRY_LEN;
+    const size_t tag_off = columnar::HDR_LEN + schema_len + 2 * bentry + 4 +
+                           1 * columnar::ENTRY_LEN + 16;
+
+    auto bad = buf;
+    bad[tag_off] ^= 1;
+
+    columnar::reader_t r;
+    assert(r.open(bad.data(), bad.size()));
+
+    const size_t clen = r.column_len(2, 1);
+    uint8_t* out = columnar::alloc_column(clen);
+    std::memset(out, 0xff, clen);
+
+    assert(!r.read_column(key, 2, 1, out));
+    for (size_t i = 0; i < clen; i++) {
+      assert(out[i] == 0);
+    }
+
+    // shorter columns of same/ other batch
+    assert(r.read_column(key, 2, 0, out));
+    assert(r.read_column(key, 1, 1, out));
+    std::free(out);
+  }
+
+  // truncated containers & column buffers pointing beyond container
+  {
+    columnar::reader_t r;
+    assert(!r.open(buf.data(), buf.size() - 1));
+    assert(!r.open(buf.data(), columnar::HDR_LEN - 1));
+
+    auto bad = buf;
+    bad[8] = static_cast<uint8_t>(NBATCH + 1);
+    assert(!r.open(bad.data(), bad.size()));
+  }
+
+  // batch indices past 16 bits get nonces of their own, not shared with any
+  // earlier batch
+  {
+    constexpr uint32_t MANY = (1u << 16) + 2;
+
+    std::vector<columnar::column_t> schema{ { "v", 1 } };
+    columnar::writer_t w(key, nonce, schema);
+
+    std::vector<uint8_t> col(16);
+    random_data(col.data(), col.size());
+    const uint8_t* cols[]{ col.data() };
+    const size_t lens[]{ col.size() };
+
+    for (uint32_t b = 0; b < MANY; b++) {
+      [[maybe_unused]] const bool ok = w.add_batch(1, cols, lens);
+      assert(ok);
+    }
+    const auto buf = w.finish();
+
+    columnar::reader_t r;
+    assert(r.open(buf.data(), buf.size()));
+    assert(r.batches() == MANY);
+
+    std::vector<std::vector<uint8_t>> encs;
+    for (const uint32_t b : { 0u, 1u, 1u << 16, (1u << 16) + 1 }) {
+      const uint8_t* const enc = buf.data() + buf.size() - (MANY - b) * 16;
+      encs.emplace_back(enc, enc + 16);
+
+      std::vector<uint8_t> out(col.size());
+      assert(r.read_column(key, b, 0, out.data()));
+      assert(out == col);
+    }
+    assert(encs[0] != encs[2] && encs[1] != encs[3]);
+  }
+
+  std::cout << "[test] columnar : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include "decoupled.hpp"
+#include "grain_128aead.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Tests decoupled Grain-128 AEAD ( see decoupled.hpp ), checking that cipher
+// text & tag computed using 1, 8 and 16 parallel LFSR lanes are bit-identical
+// to what `grain_128aead::encrypt` computes, that decryption round-trips and
+// that tampered tag/ cipher text/ associated data fail authentication.
+template<const size_t lanes>
+static void
+test_decoupled(const size_t dlen, const size_t ctlen)
+{
+  std::vector<uint8_t> key(16), nonce(12), data(dlen), txt(ctlen);
+  std::vector<uint8_t> enc0(ctlen), enc1(ctlen), dec(ctlen);
+  uint8_t tag0[8], tag1[8];
+
+  random_data(key.data(), key.size());
+  random_data(nonce.data(), nonce.size());
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  grain_128aead::encrypt(key.data(),
+                         nonce.data(),
+                         data.data(),
+                         dlen,
+                         txt.data(),
+                         enc0.data(),
+                         ctlen,
+                         tag0);
+  decoupled::encrypt<lanes>(key.data(),
+                            nonce.data(),
+                            data.data(),
+                            dlen,
+                            txt.data(),
+                            enc1.data(),
+                            ctlen,
+                            tag1);
+
+  assert(enc0 == enc1);
+  assert(std::memcmp(tag0, tag1, sizeof(tag0)) == 0);
+
+  [[maybe_unused]] bool ok = decoupled::decrypt<lanes>(key.data(),
+                                                       nonce.data(),
+                                                       tag1,
+                                                       data.data(),
+                                                       dlen,
+                                                       enc1.data(),
+                                                       dec.data(),
+                                                       ctlen);
+  assert(ok);
+  assert(dec == txt);
+
+  tag1[7] ^= 0x40;
+  ok = decoupled::decrypt<lanes>(key.data(),
+                                 nonce.data(),
+                                 tag1,
+                                 data.data(),
+                                 dlen,
+                                 enc1.data(),
+                                 dec.data(),
+                                 ctlen);
+  assert(!ok);
+  assert(std::all_of(dec.begin(), dec.end(), [](auto v) { return v == 0; }));
+  tag1[7] ^= 0x40;
+
+  if (ctlen > 0) {
+    enc1[ctlen / 2] ^= 1;
+    ok = decoupled::decrypt<lanes>(key.data(),
+                                   nonce.data(),
+                                   tag1,
+                                   data.data(),
+                                   dlen,
+                                   enc1.data(),
+                                   dec.data(),
+                                   ctlen);
+    assert(!ok);
+    enc1[ctlen / 2] ^= 1;
+  }
+
+  if (dlen > 0) {
+    data[0] ^= 0x80;
+    ok = decoupled::decrypt<lanes>(key.data(),
+                                   nonce.data(),
+                                   tag1,
+                                   data.data(),
+                                   dlen,
+                                   enc1.data(),
+                                   dec.data(),
+                                   ctlen);
+    assert(!ok);
+  }
+}
+
+int
+main()
+{
+  // lengths around word boundaries, lane segment boundaries & long messages
+  constexpr size_t ctlens[]{ 0,   1,    3,    4,    7,    64,
+                             100, 2047, 2048, 2052, 65539 };
+
+  for (const size_t ctlen : ctlens) {
+    for (const size_t dlen : { 0ul, 13ul, 300ul }) {
+      test_decoupled<1>(dlen, ctlen);
+      test_decoupled<8>(dlen, ctlen);
+      test_decoupled<16>(dlen, ctlen);
+    }
+  }
+
+  std::cout << "[test] decoupled : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include "grain_128aead.hpp"
+#include "utils.hpp"
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <vector>
+
+// Tests per-item nonce derivation ( see `grain_128aead::derive_nonce` ),
+// checking that distinct ( base, counter ) pairs always yield distinct nonces,
+// over whole 64 -bit counter range.
+
+using nonce_t = std::array<uint8_t, 12>;
+
+static nonce_t
+derive(const nonce_t& base, const uint64_t ctr)
+{
+  nonce_t nonce{};
+  grain_128aead::derive_nonce(base.data(), ctr, nonce.data());
+  return nonce;
+}
+
+int
+main()
+{
+  // bases differing in one bit of first 4 -bytes, and counters crossing byte
+  // boundaries, 32 -bit boundary & touching upper end of range
+  std::vector<nonce_t> bases;
+
+  nonce_t b0{};
+  random_data(b0.data(), b0.size());
+  bases.push_back(b0);
+
+  for (size_t i = 0; i < 32; i++) {
+    nonce_t b = b0;
+    b[i >> 3] ^= static_cast<uint8_t>(1u << (i & 7));
+    bases.push_back(b);
+  }
+
+  std::vector<uint64_t> ctrs;
+  for (uint64_t c = 0; c < 300; c++) {
+    ctrs.push_back(c);
+  }
+  for (const uint64_t c : { 0xfffful, 0x10000ul, 0xfffffful, 0x1000000ul }) {
+    ctrs.push_back(c);
+  }
+  for (uint64_t c = 0; c < 64; c++) {
+    ctrs.push_back((1ul << 32) - 32 + c);
+    ctrs.push_back(~0ul - c);
+  }
+
+  std::set<nonce_t> seen;
+  for (const auto& b : bases) {
+    for (const uint64_t c : ctrs) {
+      seen.insert(derive(b, c));
+    }
+  }
+  assert(seen.size() == bases.size() * ctrs.size());
+
+  // XOR-ing counter into base used to make derive(B, c) equal to derive(B ^ d,
+  // c ^ d), for any d; with disjoint fields such pairs stay apart
+  for (const uint64_t c : { 1ul, 5ul, 0xabcdul }) {
+    for (const uint64_t d : { 1ul, 2ul, 0x100ul, 0x12345678ul }) {
+      nonce_t b1 = b0;
+      for (size_t i = 0; i < 4; i++) {
+        b1[4 + i] ^= static_cast<uint8_t>(d >> (i << 3));
+      }
+      assert(derive(b0, c) != derive(b1, c ^ d));
+    }
+  }
+
+  // last 8 -bytes of base aren't part of derived nonce
+  nonce_t b2 = b0;
+  b2[4] ^= 0xff;
+  b2[11] ^= 0xff;
+  assert(derive(b0, 7) == derive(b2, 7));
+  assert(std::memcmp(derive(b0, 7).data(), b0.data(), 4) == 0);
+
+  std::cout << "[test] derive_nonce : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+#include "lazy_map.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <csetjmp>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// Tests lazily decrypted mappings ( see lazy_map.hpp ), checking that sealed
+// files round-trip, with & without read-ahead, and that tampered pages are
+// reported and made inaccessible, while other pages stay readable.
+
+struct failures_t
+{
+  std::atomic<size_t> count{ 0 };
+  std::atomic<size_t> last{ 0 };
+};
+
+static void
+on_failure(const size_t idx, void* const ctx)
+{
+  auto f = static_cast<failures_t*>(ctx);
+  f->last.store(idx);
+  f->count.fetch_add(1);
+}
+
+static sigjmp_buf jump;
+
+static void
+on_segv(int)
+{
+  siglongjmp(jump, 1);
+}
+
+// Whether reading given byte raises SIGSEGV
+static bool
+faults(const volatile uint8_t* const ptr)
+{
+  struct sigaction sa{}, old{};
+  sa.sa_handler = on_segv;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGSEGV, &sa, &old);
+
+  // modified between sigsetjmp & siglongjmp, so it must be volatile
+  volatile bool faulted = true;
+  if (sigsetjmp(jump, 1) == 0) {
+    [[maybe_unused]] const uint8_t v = *ptr;
+    faulted = false;
+  }
+
+  sigaction(SIGSEGV, &old, nullptr);
+  return faulted;
+}
+
+// Writes sealed file to an unlinked temporary file
+static FILE*
+sealed_file(const std::vector<uint8_t>& sealed)
+{
+  FILE* const fp = std::tmpfile();
+  assert(fp != nullptr);
+
+  [[maybe_unused]] const size_t n =
+    std::fwrite(sealed.data(), 1, sealed.size(), fp);
+  assert(n == sealed.size());
+  std::fflush(fp);
+
+  return fp;
+}
+
+int
+main()
+{
+  const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t len = page * 37 + 123;
+
+  uint8_t key[16], nonce[12];
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+
+  std::vector<uint8_t> txt(len);
+  std::vector<uint8_t> sealed(lazy_map::sealed_len(len, page));
+  random_data(txt.data(), len);
+
+  lazy_map::seal(key, nonce, txt.data(), len, page, sealed.data());
+
+  // round-trip, with & without read-ahead
+  {
+    FILE* const fp = sealed_file(sealed);
+
+    for (const size_t ahead : { 0ul, 4ul }) {
+      lazy_map::map_t m;
+      if (!m.open(fileno(fp), key, nonce, len, ahead, 2)) {
+        std::cout << "[test] lazy_map : skipped, userfaultfd unavailable"
+                  << std::endl;
+        return EXIT_SUCCESS;
+      }
+
+      assert(m.size() == len);
+      assert(m.decrypted_pages() == 0);
+
+      // single page touched, single page decrypted ( without read-ahead )
+      assert(std::memcmp(m.data() + page * 9, txt.data() + page * 9, page) ==
+             0);
+      if (ahead == 0) {
+        assert(m.decrypted_pages() == 1);
+      }
+
+      assert(std::memcmp(m.data(), txt.data(), len) == 0);
+      assert(m.failed_pages() == 0);
+    }
+
+    std::fclose(fp);
+  }
+
+  // cipher text of one page & tag of another are tampered with
+  {
+    constexpr size_t bad_enc = 7;
+    constexpr size_t bad_tag = 21;
+
+    std::vector<uint8_t> forged = sealed;
+    forged[page * bad_enc + 5] ^= 1;
+    forged[len + bad_tag * 8] ^= 0x80;
+
+    FILE* const fp = sealed_file(forged);
+
+    failures_t f;
+    lazy_map::map_t m;
+    [[maybe_unused]] const bool ok =
+      m.open(fileno(fp), key, nonce, len, 0, 0, on_failure, &f);
+    assert(ok);
+
+    // untouched pages stay readable
+    for (size_t i = 0; i < lazy_map::page_count(len, page); i++) {
+      if (i == bad_enc || i == bad_tag) {
+        continue;
+      }
+
+      const size_t off = i * page;
+      const size_t plen = std::min(page, len - off);
+      assert(std::memcmp(m.data() + off, txt.data() + off, plen) == 0);
+    }
+    assert(m.failed_pages() == 0);
+
+    // tampered ones are reported & can't be read
+    assert(faults(m.data() + page * bad_enc + 100));
+    assert(m.failed_pages() == 1);
+    assert(f.count == 1 && f.last == bad_enc);
+
+    assert(faults(m.data() + page * bad_tag));
+    assert(faults(m.data() + page * bad_tag + page - 1));
+    assert(m.failed_pages() == 2);
+    assert(f.count == 2 && f.last == bad_tag);
+
+    m.close();
+    std::fclose(fp);
+  }
+
+  // truncated sealed file is rejected, instead of raising SIGBUS on access
+  {
+    const std::vector<uint8_t> cut(sealed.begin(), sealed.end() - 1);
+    FILE* const fp = sealed_file(cut);
+
+    lazy_map::map_t m;
+    assert(!m.open(fileno(fp), key, nonce, len, 0, 0));
+    assert(m.data() == nullptr);
+
+    std::fclose(fp);
+  }
+
+  std::cout << "[test] lazy_map : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+#include "redundant.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+// Tests sampled redundant computation ( see redundant.hpp ), checking that
+// reference encryption matches fast path, that deliberately corrupted cipher
+// text/ tag is reported with right offset, and that samples are spread
+// round-robin over checkers pinned to cores other than caller's.
+
+struct reports_t
+{
+  std::mutex mtx;
+  std::vector<redundant::mismatch_t> seen;
+};
+
+int
+main()
+{
+  // reference encryption matches fast path
+  for (const size_t dlen : { 0ul, 1ul, 4ul, 5ul, 127ul, 128ul, 300ul }) {
+    for (const size_t ctlen : { 0ul, 1ul, 3ul, 4ul, 8ul, 33ul, 1000ul }) {
+      uint8_t key[16], nonce[12], tag[8], rtag[8];
+      std::vector<uint8_t> data(dlen), txt(ctlen), enc(ctlen), ref(ctlen);
+
+      random_data(key, sizeof(key));
+      random_data(nonce, sizeof(nonce));
+      random_data(data.data(), dlen);
+      random_data(txt.data(), ctlen);
+
+      grain_128aead::encrypt(
+        key, nonce, data.data(), dlen, txt.data(), enc.data(), ctlen, tag);
+      redundant::reference_encrypt(
+        key, nonce, data.data(), dlen, txt.data(), ref.data(), ctlen, rtag);
+
+      assert(enc == ref);
+      assert(std::memcmp(tag, rtag, sizeof(tag)) == 0);
+    }
+  }
+
+  // keep calling thread on one core, so that checker pinned to it is skipped
+  const int core = sched_getcpu();
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(static_cast<size_t>(core), &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+  redundant::config_t cfg;
+  cfg.fraction = 1.;
+  cfg.cores = { static_cast<size_t>(core),
+                static_cast<size_t>(core) + 1,
+                static_cast<size_t>(core) + 2 };
+
+  reports_t r;
+  redundant::checker_t ck(cfg, [&](const redundant::mismatch_t& m) {
+    std::lock_guard<std::mutex> lock(r.mtx);
+    r.seen.push_back(m);
+  });
+
+  uint8_t key[16], nonce[12], tag[8];
+  std::vector<uint8_t> data(20), txt(300), enc(300);
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+  random_data(data.data(), data.size());
+  random_data(txt.data(), txt.size());
+
+  // correct outputs aren't reported
+  for (size_t i = 0; i < 8; i++) {
+    nonce[0] = static_cast<uint8_t>(i);
+    ck.encrypt(key,
+               nonce,
+               data.data(),
+               data.size(),
+               txt.data(),
+               enc.data(),
+               enc.size(),
+               tag);
+  }
+  ck.drain();
+  assert(ck.stats().checked == 8 && ck.stats().mismatches == 0);
+  assert(r.seen.empty());
+
+  // corrupted cipher text byte, reported at its offset, and corrupted tag,
+  // reported at offset = ctlen
+  const size_t offs[]{ 0, 5, 299, 300, 300, 300 };
+  for (const size_t off : offs) {
+    auto bad = enc;
+    uint8_t bad_tag[8];
+    std::memcpy(bad_tag, tag, sizeof(tag));
+
+    if (off < bad.size()) {
+      bad[off] ^= 0x10;
+    } else {
+      bad_tag[7] ^= 0x01;
+    }
+
+    ck.verify(key,
+              nonce,
+              data.data(),
+              data.size(),
+              txt.data(),
+              bad.data(),
+              bad.size(),
+              bad_tag);
+  }
+  ck.drain();
+
+  const auto st = ck.stats();
+  assert(st.checked == 8 + std::size(offs));
+  assert(st.mismatches == std::size(offs));
+  assert(r.seen.size() == std::size(offs));
+
+  std::vector<size_t> got, per_checker(cfg.cores.size());
+  for (const auto& m : r.seen) {
+    assert(m.core == core && !m.migrated);
+    assert(m.dlen == data.size() && m.ctlen == enc.size());
+    got.push_back(m.offset);
+    per_checker[m.checker]++;
+  }
+
+  // checkers may report out of order
+  std::sort(got.begin(), got.end());
+  assert(std::equal(got.begin(), got.end(), std::begin(offs)));
+
+  // checker pinned to caller's core is skipped, others take turns
+  assert(per_checker[0] == 0);
+  assert(per_checker[1] == per_checker[2]);
+
+  std::cout << "[test] redundant : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,183 @@
+#include "sealed_cache.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <iostream>
+
+// Tests sealed object cache ( see sealed_cache.hpp ), walking entries through
+// hot, queued & sealed states with put/ get/ evict/ erase/ flush, while
+// checking decrypted/ sealed counts & stats at each step, and that tampered or
+// swapped sealed values fail authentication.
+
+static std::vector<uint8_t>
+value_of(const std::string& k, const size_t len)
+{
+  std::vector<uint8_t> v(len);
+  for (size_t i = 0; i < len; i++) {
+    v[i] = static_cast<uint8_t>(k[i % k.size()] + i);
+  }
+  return v;
+}
+
+static void
+put(sealed_cache::cache_t& c, const std::string& k, const size_t len = 32)
+{
+  const auto v = value_of(k, len);
+  c.put(k, v.data(), v.size());
+}
+
+static bool
+has(sealed_cache::cache_t& c, const std::string& k, const size_t len = 32)
+{
+  std::vector<uint8_t> out;
+  return c.get(k, out) && out == value_of(k, len);
+}
+
+int
+main()
+{
+  uint8_t key[16], nonce[12];
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+
+  // state machine, with sealing done only by `flush`
+  {
+    sealed_cache::cache_t c(key, nonce, 2, 2, false);
+
+    put(c, "a");
+    put(c, "b");
+    put(c, "c"); // a queued for sealing
+    assert(c.decrypted() == 3 && c.sealed() == 0);
+
+    // erasing queued value drops it from queue too
+    assert(c.erase("a"));
+    assert(!c.erase("a"));
+    assert(c.decrypted() == 2 && c.sealed() == 0);
+
+    c.flush();
+    assert(c.stats().seals == 0);
+
+    put(c, "d"); // b queued
+    put(c, "e"); // c queued
+    assert(c.decrypted() == 4 && c.sealed() == 0);
+
+    // queued value looked up before sealing goes back to hot set, evicting d
+    assert(has(c, "c"));
+    assert(c.stats().hot_hits == 1);
+    assert(c.decrypted() == 4 && c.sealed() == 0);
+
+    c.flush(); // b, d sealed
+    assert(c.stats().seals == 2);
+    assert(c.decrypted() == 2 && c.sealed() == 2);
+
+    // cold value is decrypted & promoted, evicting e
+    assert(has(c, "b"));
+    assert(c.stats().cold_hits == 1);
+    assert(c.decrypted() == 3 && c.sealed() == 1);
+
+    // replacing cold value makes it hot again, evicting c
+    put(c, "d", 48);
+    assert(c.decrypted() == 4 && c.sealed() == 0);
+
+    c.flush(); // e, c sealed
+    assert(c.stats().seals == 4);
+    assert(c.decrypted() == 2 && c.sealed() == 2);
+
+    // erasing cold value
+    assert(c.erase("e"));
+    assert(c.decrypted() == 2 && c.sealed() == 1);
+
+    std::vector<uint8_t> out;
+    assert(!c.get("a", out) && !c.get("e", out));
+    assert(c.stats().misses == 2);
+
+    assert(has(c, "d", 48) && has(c, "b") && has(c, "c"));
+    c.flush();
+    assert(c.decrypted() == 2 && c.sealed() == 1);
+    assert(c.stats().auth_failures == 0);
+  }
+
+  // tampered, swapped & foreign sealed values fail authentication, for values
+  // opened both under cache lock and without it
+  for (const size_t len : { 32ul, sealed_cache::SMALL_LEN + 1 }) {
+    sealed_cache::cache_t c(key, nonce, 1, 1, false);
+
+    put(c, "x", len);
+    put(c, "y", len);
+    put(c, "z", len);
+    c.flush(); // x, y sealed
+
+    sealed_cache::sealed_t sx, sy;
+    assert(c.get_sealed("x", sx) && c.get_sealed("y", sy));
+    assert(!c.get_sealed("z", sx) && !c.get_sealed("w", sx));
+    assert(c.get_sealed("x", sx));
+
+    // sealed value round trips
+    c.put_sealed("x", sx);
+    assert(has(c, "x", len));
+    assert(c.stats().auth_failures == 0);
+
+    std::vector<uint8_t> out;
+    sealed_cache::sealed_t bad = sx;
+
+    bad.enc[len / 2] ^= 1;
+    c.put_sealed("x", bad);
+    assert(!c.get("x", out));
+    assert(c.stats().auth_failures == 1);
+
+    bad = sx;
+    bad.tag[0] ^= 1;
+    c.put_sealed("x", bad);
+    assert(!c.get("x", out));
+    assert(c.stats().auth_failures == 2);
+
+    bad = sx;
+    bad.id ^= 1;
+    c.put_sealed("x", bad);
+    assert(!c.get("x", out));
+    assert(c.stats().auth_failures == 3);
+
+    // sealed value of y, under key x
+    c.put_sealed("x", sy);
+    assert(!c.get("x", out));
+    assert(c.stats().auth_failures == 4);
+
+    // sealed under another base nonce
+    uint8_t other[12];
+    std::memcpy(other, nonce, sizeof(other));
+    other[0] ^= 1;
+
+    sealed_cache::cache_t c2(key, other, 1, 1, false);
+    c2.put_sealed("y", sy);
+    assert(!c2.get("y", out));
+
+    // failed lookups leave value sealed; replacing it works as usual
+    assert(c.sealed() == 2);
+    put(c, "x", len);
+    assert(has(c, "x", len) && has(c, "y", len));
+    assert(c.stats().auth_failures == 4);
+  }
+
+  // background sealing, with many values cycling through hot set
+  {
+    sealed_cache::cache_t c(key, nonce, 8, 4);
+
+    for (size_t i = 0; i < 256; i++) {
+      put(c, std::to_string(i), 16 + i);
+    }
+
+    for (size_t i = 0; i < 256; i++) {
+      assert(has(c, std::to_string(i), 16 + i));
+    }
+
+    // background thread may still be sealing a batch it took from queue
+    c.flush();
+    while (c.decrypted() > 8) {
+      std::this_thread::yield();
+    }
+    assert(c.sealed() == 248);
+    assert(c.stats().auth_failures == 0);
+  }
+
+  std::cout << "[test] sealed_cache : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+#include "grain_128aead.hpp"
+#include "sparse_file.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+// Tests sparse-aware encryption ( see `grain_128aead::encrypt_sparse` &
+// sparse_file.hpp ), checking that cipher text & tag are bit-identical to what
+// `grain_128aead::encrypt` produces, for plain text mixing all-zero & non-zero
+// pages, and for files with holes.
+
+constexpr size_t PAGE = 4096;
+
+// Fills plain text of `len` -bytes, where bit i of `pattern` decides whether
+// page i ( modulo 32 ) is non-zero
+static void
+mixed_pages(uint8_t* const txt, const size_t len, const uint32_t pattern)
+{
+  std::memset(txt, 0, len);
+
+  for (size_t off = 0; off < len; off += PAGE) {
+    if ((pattern >> ((off / PAGE) & 31)) & 1u) {
+      random_data(txt + off, std::min(PAGE, len - off));
+    }
+  }
+}
+
+static void
+test_encrypt_sparse(const size_t dlen, const size_t ctlen, const uint32_t pat)
+{
+  std::vector<uint8_t> key(16), nonce(12), data(dlen), txt(ctlen);
+  std::vector<uint8_t> enc0(ctlen), enc1(ctlen), tag0(8), tag1(8);
+
+  random_data(key.data(), key.size());
+  random_data(nonce.data(), nonce.size());
+  random_data(data.data(), dlen);
+  mixed_pages(txt.data(), ctlen, pat);
+
+  using namespace grain_128aead;
+  encrypt(key.data(),
+          nonce.data(),
+          data.data(),
+          dlen,
+          txt.data(),
+          enc0.data(),
+          ctlen,
+          tag0.data());
+  encrypt_sparse(key.data(),
+                 nonce.data(),
+                 data.data(),
+                 dlen,
+                 txt.data(),
+                 enc1.data(),
+                 ctlen,
+                 tag1.data());
+
+  assert(enc0 == enc1);
+  assert(tag0 == tag1);
+}
+
+// Writes `len` -bytes file, where only pages selected by `pattern` are written
+// ( with random bytes ), leaving holes elsewhere, encrypts it using
+// `sparse_file::encrypt` and compares against `grain_128aead::encrypt` over
+// file content
+static void
+test_sparse_file(const size_t len, const uint32_t pattern, const size_t chunk)
+{
+  char in_path[] = "/tmp/grain_sparse_in_XXXXXX";
+  char out_path[] = "/tmp/grain_sparse_out_XXXXXX";
+
+  const int in_fd = mkstemp(in_path);
+  const int out_fd = mkstemp(out_path);
+  assert(in_fd >= 0 && out_fd >= 0);
+
+  std::vector<uint8_t> txt(len);
+  mixed_pages(txt.data(), len, pattern);
+
+  [[maybe_unused]] int ret = ftruncate(in_fd, static_cast<off_t>(len));
+  assert(ret == 0);
+
+  for (size_t off = 0; off < len; off += PAGE) {
+    if ((pattern >> ((off / PAGE) & 31)) & 1u) {
+      const size_t n = std::min(PAGE, len - off);
+      [[maybe_unused]] const ssize_t wr =
+        pwrite(in_fd, txt.data() + off, n, static_cast<off_t>(off));
+      assert(wr == static_cast<ssize_t>(n));
+    }
+  }
+
+  std::vector<uint8_t> key(16), nonce(12), data(13);
+  std::vector<uint8_t> enc0(len), enc1(len), tag0(8), tag1(8);
+
+  random_data(key.data(), key.size());
+  random_data(nonce.data(), nonce.size());
+  random_data(data.data(), data.size());
+
+  grain_128aead::encrypt(key.data(),
+                         nonce.data(),
+                         data.data(),
+                         data.size(),
+                         txt.data(),
+                         enc0.data(),
+                         len,
+                         tag0.data());
+
+  [[maybe_unused]] const bool ok = sparse_file::encrypt(key.data(),
+                                                        nonce.data(),
+                                                        data.data(),
+                                                        data.size(),
+                                                        in_fd,
+                                                        out_fd,
+                                                        len,
+                                                        tag1.data(),
+                                                        chunk);
+  assert(ok);
+
+  [[maybe_unused]] const ssize_t rd = pread(out_fd, enc1.data(), len, 0);
+  assert(rd == static_cast<ssize_t>(len));
+
+  assert(enc0 == enc1);
+  assert(tag0 == tag1);
+
+  close(in_fd);
+  close(out_fd);
+  unlink(in_path);
+  unlink(out_path);
+}
+
+int
+main()
+{
+  // all-zero, all non-zero & mixed pages, with partial last page
+  for (const uint32_t pat : { 0u, ~0u, 0b1010u, 0b0110u, 0x5a5a5a5au }) {
+    for (const size_t ctlen : { 0ul, 1ul, 4095ul, 4096ul, 4099ul, 32771ul }) {
+      test_encrypt_sparse(0, ctlen, pat);
+      test_encrypt_sparse(37, ctlen, pat);
+    }
+  }
+
+  // files with holes in front, middle & back, with chunks smaller & larger
+  // than a page
+  for (const uint32_t pat : { 0u, ~0u, 0b0110u, 0b1001u, 0x33u }) {
+    for (const size_t len : { 4096ul * 8, 4096ul * 8 + 3, 1ul << 20 }) {
+      test_sparse_file(len, pat, 1024);
+      test_sparse_file(len, pat, 1ul << 16);
+    }
+  }
+
+  std::cout << "[test] sparse : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
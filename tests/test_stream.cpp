@@ -0,0 +1,261 @@
+#include "stream.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sys/wait.h>
+#include <vector>
+
+// Tests streaming Grain-128 AEAD ( see stream.hpp ), feeding associated data &
+// text in random sized pieces, while exporting/ importing context in between,
+// checking that output matches one-shot encryption, that tampered blobs are
+// rejected, and that context moves across processes through a sealed memfd,
+// while unsealed or too short memfds are rejected.
+
+// Exports context into blob & imports it back into a fresh context, optionally
+// flipping a bit of blob first, which must then be rejected
+static bool
+round_trip(stream::ctx_t& ctx, const bool tamper)
+{
+  uint8_t blob[stream::EXPORT_LEN];
+  if (!stream::export_ctx(ctx, blob)) {
+    return false;
+  }
+
+  // exported context is moved out
+  uint8_t in[1]{}, out[1];
+  if (stream::absorb(ctx, in, 0) || stream::update(ctx, in, out, 0)) {
+    return false;
+  }
+
+  stream::ctx_t t;
+  if (tamper) {
+    blob[50] ^= 1;
+    if (stream::import_ctx(t, blob)) {
+      return false;
+    }
+    blob[50] ^= 1;
+  }
+
+  if (!stream::import_ctx(t, blob)) {
+    return false;
+  }
+
+  ctx = t;
+  return true;
+}
+
+// Creates memfd holding given bytes, optionally sealing it
+static int
+make_memfd(const uint8_t* const data, const size_t len, const int seals)
+{
+  const int fd = memfd_create("test_stream", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  assert(fd >= 0);
+
+  [[maybe_unused]] const ssize_t n = write(fd, data, len);
+  assert(n == static_cast<ssize_t>(len));
+
+  if (seals != 0) {
+    [[maybe_unused]] const int r = fcntl(fd, F_ADD_SEALS, seals);
+    assert(r == 0);
+  }
+  return fd;
+}
+
+int
+main()
+{
+  std::mt19937_64 gen(std::random_device{}());
+
+  // piecewise encryption/ decryption, with export/ import in between
+  for (size_t it = 0; it < 256; it++) {
+    const size_t dlen = gen() % 70;
+    const size_t ctlen = gen() % 300;
+
+    uint8_t key[16], nonce[12], tag[8], stag[8];
+    std::vector<uint8_t> data(dlen), txt(ctlen), enc(ctlen), senc(ctlen);
+    std::vector<uint8_t> dec(ctlen);
+
+    random_data(key, sizeof(key));
+    random_data(nonce, sizeof(nonce));
+    random_data(data.data(), dlen);
+    random_data(txt.data(), ctlen);
+
+    grain_128aead::encrypt(
+      key, nonce, data.data(), dlen, txt.data(), enc.data(), ctlen, tag);
+
+    stream::ctx_t ctx;
+    stream::init(ctx, stream::dir_t::ENCRYPT, key, nonce, dlen, ctlen);
+
+    for (size_t off = 0; off < dlen;) {
+      const size_t len = std::min<size_t>(gen() % 9, dlen - off);
+      assert(stream::absorb(ctx, data.data() + off, len));
+      off += len;
+
+      if (gen() % 4 == 0) {
+        assert(round_trip(ctx, it % 3 == 0));
+      }
+    }
+
+    // associated data past declared length
+    assert(!stream::absorb(ctx, data.data(), 1));
+
+    for (size_t off = 0; off < ctlen;) {
+      const size_t len = std::min<size_t>(gen() % 13, ctlen - off);
+      assert(stream::update(ctx, txt.data() + off, senc.data() + off, len));
+      off += len;
+
+      if (gen() % 4 == 0) {
+        assert(round_trip(ctx, it % 3 == 0));
+      }
+    }
+
+    // text past declared length, or associated data after text
+    uint8_t in[1]{}, out[1];
+    assert(!stream::update(ctx, in, out, 1));
+    assert(!stream::absorb(ctx, data.data(), 0));
+
+    assert(stream::finish(ctx, stag));
+    assert(senc == enc);
+    assert(std::memcmp(stag, tag, sizeof(tag)) == 0);
+
+    // finalized context can't be exported
+    uint8_t blob[stream::EXPORT_LEN];
+    assert(!stream::export_ctx(ctx, blob));
+
+    // decrypts in one go, verifying tag
+    stream::init(ctx, stream::dir_t::DECRYPT, key, nonce, dlen, ctlen);
+    assert(stream::absorb(ctx, data.data(), dlen));
+    assert(stream::update(ctx, enc.data(), dec.data(), ctlen));
+    assert(stream::finish(ctx, tag));
+    assert(dec == txt);
+
+    // tampered tag
+    stream::init(ctx, stream::dir_t::DECRYPT, key, nonce, dlen, ctlen);
+    assert(stream::absorb(ctx, data.data(), dlen));
+    assert(stream::update(ctx, enc.data(), dec.data(), ctlen));
+    tag[it & 7] ^= 1;
+    assert(!stream::finish(ctx, tag));
+
+    // not all declared text fed
+    if (ctlen > 0) {
+      stream::init(ctx, stream::dir_t::ENCRYPT, key, nonce, dlen, ctlen);
+      assert(stream::absorb(ctx, data.data(), dlen));
+      assert(stream::update(ctx, txt.data(), senc.data(), ctlen - 1));
+      assert(!stream::finish(ctx, stag));
+    }
+  }
+
+  uint8_t key[16], nonce[12], tag[8], stag[8];
+  std::vector<uint8_t> data(10), txt(100), enc(100), senc(100);
+
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+  random_data(data.data(), data.size());
+  random_data(txt.data(), txt.size());
+
+  grain_128aead::encrypt(key,
+                         nonce,
+                         data.data(),
+                         data.size(),
+                         txt.data(),
+                         enc.data(),
+                         enc.size(),
+                         tag);
+
+  // context started in child, exported into memfd & passed over socket, is
+  // finished in parent
+  {
+    int sv[2];
+    [[maybe_unused]] const int r = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert(r == 0);
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+      stream::ctx_t ctx;
+      stream::init(ctx, stream::dir_t::ENCRYPT, key, nonce, 10, 100);
+      stream::absorb(ctx, data.data(), 10);
+      stream::update(ctx, txt.data(), senc.data(), 37);
+
+      const int fd = stream::export_memfd(ctx);
+      _exit(fd >= 0 && stream::send_fd(sv[0], fd) ? 0 : 1);
+    }
+
+    const int fd = stream::recv_fd(sv[1]);
+    assert(fd >= 0);
+
+    stream::ctx_t ctx;
+    assert(stream::import_memfd(ctx, fd));
+    close(fd);
+
+    int st = 0;
+    waitpid(pid, &st, 0);
+    assert(WIFEXITED(st) && WEXITSTATUS(st) == 0);
+    close(sv[0]);
+    close(sv[1]);
+
+    assert(stream::update(ctx, txt.data() + 37, senc.data() + 37, 63));
+    assert(stream::finish(ctx, stag));
+    assert(std::equal(enc.begin() + 37, enc.end(), senc.begin() + 37));
+    assert(std::memcmp(stag, tag, sizeof(tag)) == 0);
+  }
+
+  // memfd must be sealed against writes & shrinking, and hold a whole blob
+  {
+    stream::ctx_t ctx;
+    stream::init(ctx, stream::dir_t::ENCRYPT, key, nonce, 10, 100);
+    stream::absorb(ctx, data.data(), 5);
+
+    uint8_t blob[stream::EXPORT_LEN];
+    assert(stream::export_ctx(ctx, blob));
+
+    const int all = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+
+    int fd = make_memfd(blob, sizeof(blob), 0);
+    assert(!stream::import_memfd(ctx, fd));
+    close(fd);
+
+    fd = make_memfd(blob, sizeof(blob), F_SEAL_WRITE);
+    assert(!stream::import_memfd(ctx, fd));
+    close(fd);
+
+    fd = make_memfd(blob, sizeof(blob), F_SEAL_SHRINK);
+    assert(!stream::import_memfd(ctx, fd));
+    close(fd);
+
+    fd = make_memfd(blob, sizeof(blob) - 1, all);
+    assert(!stream::import_memfd(ctx, fd));
+    close(fd);
+
+    fd = make_memfd(blob, sizeof(blob), all);
+    assert(stream::import_memfd(ctx, fd));
+    close(fd);
+
+    // imported context carries on from where it was exported
+    assert(stream::absorb(ctx, data.data() + 5, 5));
+    assert(stream::update(ctx, txt.data(), senc.data(), 100));
+    assert(stream::finish(ctx, stag));
+    assert(senc == enc);
+    assert(std::memcmp(stag, tag, sizeof(tag)) == 0);
+  }
+
+  // exported memfd carries all seals, and context is moved out only then
+  {
+    stream::ctx_t ctx;
+    stream::init(ctx, stream::dir_t::ENCRYPT, key, nonce, 10, 100);
+
+    const int fd = stream::export_memfd(ctx);
+    assert(fd >= 0);
+
+    const int all = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+    assert(fcntl(fd, F_GET_SEALS) == all);
+    close(fd);
+
+    assert(!stream::absorb(ctx, data.data(), 0));
+    assert(stream::export_memfd(ctx) < 0);
+  }
+
+  std::cout << "[test] stream : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+#include "stream_view.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Tests range adaptors for lazy encryption/ decryption ( see stream_view.hpp ),
+// over both sized & unsized underlying ranges, spanning partial, whole &
+// multiple `VIEW_CHUNK` -bytes chunks, checking that output & tag match
+// one-shot encryption and that tampered tag/ cipher text isn't verified.
+
+using enc_view = decltype(std::declval<std::vector<uint8_t>&>() |
+                          stream::encrypt(nullptr, nullptr));
+static_assert(std::ranges::input_range<enc_view>);
+static_assert(std::ranges::view<enc_view>);
+static_assert(std::ranges::sized_range<enc_view>);
+
+// Pass-through filter, hiding size of underlying range
+constexpr auto unsized = std::views::filter([](uint8_t) { return true; });
+
+using unsized_view =
+  decltype(std::declval<std::vector<uint8_t>&>() | unsized |
+           stream::decrypt(nullptr, nullptr, nullptr));
+static_assert(std::ranges::input_range<unsized_view>);
+static_assert(!std::ranges::sized_range<unsized_view>);
+
+template<class V>
+static std::vector<uint8_t>
+drain(V&& v)
+{
+  std::vector<uint8_t> out;
+  for (const uint8_t b : v) {
+    out.push_back(b);
+  }
+  return out;
+}
+
+int
+main()
+{
+  constexpr size_t C = stream::VIEW_CHUNK;
+
+  for (const size_t dlen : { 0ul, 1ul, 4ul, 37ul }) {
+    for (const size_t ctlen :
+         { 0ul, 1ul, 3ul, 4ul, C - 1, C, C + 1, 3 * C + 7, 1000ul }) {
+      uint8_t key[16], nonce[12], tag[8];
+      std::vector<uint8_t> data(dlen), txt(ctlen), enc(ctlen);
+
+      random_data(key, sizeof(key));
+      random_data(nonce, sizeof(nonce));
+      random_data(data.data(), dlen);
+      random_data(txt.data(), ctlen);
+
+      grain_128aead::encrypt(
+        key, nonce, data.data(), dlen, txt.data(), enc.data(), ctlen, tag);
+
+      // sized view, declaring text length upfront
+      {
+        auto ev = txt | stream::encrypt(key, nonce, data);
+        assert(ev.size() == ctlen);
+        assert(!ev.done() && ev.tag() == nullptr);
+
+        assert(drain(ev) == enc);
+        assert(ev.done() && ev.tag() != nullptr);
+        assert(std::memcmp(ev.tag(), tag, sizeof(tag)) == 0);
+
+        auto dv = enc | stream::decrypt(key, nonce, tag, data);
+        assert(dv.size() == ctlen);
+        assert(drain(dv) == txt && dv.verified());
+      }
+
+      // unsized view, with unbounded text length
+      {
+        auto ev = txt | unsized | stream::encrypt(key, nonce, data);
+        assert(drain(ev) == enc);
+        assert(ev.tag() != nullptr);
+        assert(std::memcmp(ev.tag(), tag, sizeof(tag)) == 0);
+
+        auto dv = enc | unsized | stream::decrypt(key, nonce, tag, data);
+        assert(drain(dv) == txt && dv.verified());
+      }
+
+      // tampered tag, cipher text & associated data
+      {
+        tag[ctlen & 7] ^= 1;
+        auto dv = enc | stream::decrypt(key, nonce, tag, data);
+        drain(dv);
+        assert(dv.done() && !dv.verified());
+        tag[ctlen & 7] ^= 1;
+      }
+
+      if (ctlen > 0) {
+        enc[ctlen / 2] ^= 0x40;
+        auto dv = enc | unsized | stream::decrypt(key, nonce, tag, data);
+        drain(dv);
+        assert(dv.done() && !dv.verified());
+        enc[ctlen / 2] ^= 0x40;
+      }
+
+      if (dlen > 0) {
+        data[dlen - 1] ^= 1;
+        auto dv = enc | stream::decrypt(key, nonce, tag, data);
+        drain(dv);
+        assert(dv.done() && !dv.verified());
+        data[dlen - 1] ^= 1;
+      }
+    }
+  }
+
+  std::cout << "[test] stream_view : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
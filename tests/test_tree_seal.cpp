@@ -0,0 +1,181 @@
+#include "tree_seal.hpp"
+#include "utils.hpp"
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+
+// Tests directory tree sealing ( see tree_seal.hpp ), sealing a small tree of
+// empty, small, chunk-sized & multi-chunk files and opening each sealed file
+// back using its manifest entry, while checking that renamed/ truncated/
+// tampered files are rejected, that uncreatable output directories are counted
+// as errors, and that no two files share a nonce counter.
+
+namespace fs = std::filesystem;
+
+constexpr size_t CHUNK = 4096;
+
+static std::vector<uint8_t>
+read_file(const fs::path& path)
+{
+  std::ifstream f(path, std::ios::binary);
+  return { std::istreambuf_iterator<char>(f), {} };
+}
+
+static void
+write_file(const fs::path& path, const std::vector<uint8_t>& data)
+{
+  std::ofstream f(path, std::ios::binary);
+  f.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+int
+main()
+{
+  uint8_t key[16], nonce[12];
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+
+  char tmpl[] = "/tmp/test_tree_seal.XXXXXX";
+  const fs::path root = mkdtemp(tmpl);
+  const fs::path in = root / "in";
+  const fs::path out = root / "out";
+
+  // plain text tree, spanning small file batches & chunked large files
+  std::map<std::string, std::vector<uint8_t>> files;
+  const size_t sizes[]{ 0,         1,         100,       1023,     1024,
+                        CHUNK - 1, CHUNK,     CHUNK + 1, 3 * CHUNK + 5 };
+
+  for (const char* dir : { "", "a", "a/b", "c" }) {
+    fs::create_directories(in / dir);
+    for (size_t i = 0; i < std::size(sizes); i++) {
+      const std::string rel =
+        (std::strlen(dir) ? std::string(dir) + "/" : "") + "f" +
+        std::to_string(i);
+
+      std::vector<uint8_t> data(sizes[i]);
+      random_data(data.data(), data.size());
+      write_file(in / rel, data);
+      files[rel] = std::move(data);
+    }
+  }
+
+  tree_seal::options_t opts;
+  opts.threads = 4;
+  opts.inflight = 3;
+  opts.chunk = CHUNK;
+  opts.small = 1024;
+  opts.batch = 2;
+
+  // sealed tree opens back, file by file, using manifest
+  {
+    std::vector<tree_seal::entry_t> manifest;
+    const auto rep = tree_seal::seal_tree(key, nonce, in, out, manifest, opts);
+
+    assert(rep.errors == 0);
+    assert(rep.dirs == 4);
+    assert(rep.files == files.size());
+    assert(manifest.size() == files.size());
+
+    std::set<std::array<uint8_t, 12>> nonces;
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+
+    for (size_t i = 0; i < manifest.size(); i++) {
+      const auto& e = manifest[i];
+      assert(i == 0 || manifest[i - 1].path < e.path);
+      std::array<uint8_t, 12> n;
+      std::memcpy(n.data(), e.nonce, n.size());
+      nonces.insert(n);
+      ranges.emplace_back(e.id, tree_seal::chunk_count(e.size, CHUNK));
+
+      const auto& exp = files.at(e.path);
+      const auto sealed = read_file(out / e.path);
+      assert(e.size == exp.size());
+      assert(sealed.size() == tree_seal::sealed_len(exp.size(), CHUNK));
+
+      std::vector<uint8_t> txt(exp.size() + 1);
+      assert(tree_seal::open_buffer(key,
+                                    e.nonce,
+                                    e.path,
+                                    sealed.data(),
+                                    sealed.size(),
+                                    CHUNK,
+                                    txt.data(),
+                                    exp.size()));
+      assert(std::memcmp(txt.data(), exp.data(), exp.size()) == 0);
+
+      // renamed file
+      assert(!tree_seal::open_buffer(key,
+                                     e.nonce,
+                                     e.path + "x",
+                                     sealed.data(),
+                                     sealed.size(),
+                                     CHUNK,
+                                     txt.data(),
+                                     exp.size()));
+
+      // truncated file, dropping its last chunk
+      if (exp.size() > CHUNK) {
+        const size_t last = exp.size() % CHUNK ? exp.size() % CHUNK : CHUNK;
+        const size_t slen = sealed.size() - last - tree_seal::TAG_LEN;
+        assert(!tree_seal::open_buffer(key,
+                                       e.nonce,
+                                       e.path,
+                                       sealed.data(),
+                                       slen,
+                                       CHUNK,
+                                       txt.data(),
+                                       exp.size() - last));
+      }
+
+      // tampered last byte ( i.e. tag of last chunk )
+      auto bad = sealed;
+      bad.back() ^= 1;
+      assert(!tree_seal::open_buffer(key,
+                                     e.nonce,
+                                     e.path,
+                                     bad.data(),
+                                     bad.size(),
+                                     CHUNK,
+                                     txt.data(),
+                                     exp.size()));
+    }
+
+    // no two files share a nonce, nor any nonce counter
+    assert(nonces.size() == manifest.size());
+    std::sort(ranges.begin(), ranges.end());
+    for (size_t i = 1; i < ranges.size(); i++) {
+      assert(ranges[i - 1].first + ranges[i - 1].second <= ranges[i].first);
+    }
+  }
+
+  // output root which can't be created
+  {
+    const fs::path out1 = root / "no/such/dir";
+
+    std::vector<tree_seal::entry_t> manifest;
+    const auto rep = tree_seal::seal_tree(key, nonce, in, out1, manifest, opts);
+    assert(rep.errors == 1 && rep.files == 0 && manifest.empty());
+  }
+
+  // output directory which can't be created, as a file is in its way
+  {
+    const fs::path out2 = root / "out2";
+    fs::create_directories(out2);
+    write_file(out2 / "a", { 1 });
+
+    std::vector<tree_seal::entry_t> manifest;
+    const auto rep = tree_seal::seal_tree(key, nonce, in, out2, manifest, opts);
+    assert(rep.errors == 1);
+    assert(rep.files == files.size() - 2 * std::size(sizes));
+  }
+
+  fs::remove_all(root);
+
+  std::cout << "[test] tree_seal : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+#include "trial_open.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+// Tests trial decryption ( see trial_open.hpp ), for K = 1..9 candidate keys
+// ( i.e. full & partial groups of `MAX_LANES` ), with sealing key in every
+// slot, checking that its index is found and message decrypted, while tampered
+// messages & messages sealed under none of candidates are rejected, zeroing
+// plain text.
+
+using secret_t = std::array<uint8_t, 16>;
+
+int
+main()
+{
+  for (size_t nkeys = 1; nkeys <= 9; nkeys++) {
+    for (const size_t dlen : { 0ul, 3ul, 4ul, 129ul }) {
+      for (const size_t ctlen : { 0ul, 1ul, 5ul, 64ul, 333ul }) {
+        std::vector<secret_t> keys(nkeys);
+        std::vector<const uint8_t*> kptrs;
+        for (auto& k : keys) {
+          random_data(k.data(), k.size());
+          kptrs.push_back(k.data());
+        }
+
+        uint8_t nonce[12];
+        random_data(nonce, sizeof(nonce));
+
+        std::vector<uint8_t> data(dlen), txt(ctlen), enc(ctlen), dec(ctlen);
+        random_data(data.data(), dlen);
+        random_data(txt.data(), ctlen);
+
+        auto open = [&](const uint8_t* const tag) {
+          std::fill(dec.begin(), dec.end(), 0xaa);
+          return trial_open::open(kptrs.data(),
+                                  nkeys,
+                                  nonce,
+                                  tag,
+                                  data.data(),
+                                  dlen,
+                                  enc.data(),
+                                  dec.data(),
+                                  ctlen);
+        };
+
+        auto zeroed = [&] {
+          return std::all_of(
+            dec.begin(), dec.end(), [](const uint8_t b) { return b == 0; });
+        };
+
+        for (size_t slot = 0; slot < nkeys; slot++) {
+          uint8_t tag[8];
+          grain_128aead::encrypt(kptrs[slot],
+                                 nonce,
+                                 data.data(),
+                                 dlen,
+                                 txt.data(),
+                                 enc.data(),
+                                 ctlen,
+                                 tag);
+
+          const auto idx = static_cast<ptrdiff_t>(slot);
+          assert(trial_open::verify(kptrs.data(),
+                                    nkeys,
+                                    nonce,
+                                    tag,
+                                    data.data(),
+                                    dlen,
+                                    enc.data(),
+                                    ctlen) == idx);
+          assert(open(tag) == idx);
+          assert(dec == txt);
+
+          // tampered tag, cipher text & associated data
+          tag[slot & 7] ^= 1;
+          assert(open(tag) == -1 && zeroed());
+          tag[slot & 7] ^= 1;
+
+          if (ctlen > 0) {
+            enc[ctlen - 1] ^= 0x80;
+            assert(open(tag) == -1 && zeroed());
+            enc[ctlen - 1] ^= 0x80;
+          }
+
+          if (dlen > 0) {
+            data[0] ^= 1;
+            assert(open(tag) == -1 && zeroed());
+            data[0] ^= 1;
+          }
+
+          // sealing key missing from candidates
+          const uint8_t* const kept = kptrs[slot];
+          secret_t other = keys[slot];
+          other[15] ^= 1;
+          kptrs[slot] = other.data();
+          assert(open(tag) == -1 && zeroed());
+          kptrs[slot] = kept;
+
+          // same key in a later slot too, first one wins
+          if (slot + 1 < nkeys) {
+            const uint8_t* const next = kptrs[nkeys - 1];
+            kptrs[nkeys - 1] = kept;
+            assert(open(tag) == idx);
+            kptrs[nkeys - 1] = next;
+          }
+        }
+      }
+    }
+  }
+
+  // no candidates at all
+  {
+    uint8_t nonce[12]{}, tag[8]{}, enc[4]{}, dec[4]{ 1, 2, 3, 4 };
+    [[maybe_unused]] const auto idx =
+      trial_open::open(nullptr, 0, nonce, tag, nullptr, 0, enc, dec, 4);
+    assert(idx == -1);
+    for (const uint8_t b : dec) {
+      assert(b == 0);
+    }
+  }
+
+  std::cout << "[test] trial_open : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
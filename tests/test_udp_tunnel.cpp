@@ -0,0 +1,305 @@
+#include "udp_tunnel.hpp"
+#include "utils.hpp"
+#include <arpa/inet.h>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Tests datagram tunnel ( see udp_tunnel.hpp ), sealing bursts of datagrams &
+// opening them back, across 2^32 boundary of sequence numbers, checking that
+// tampered, foreign session, out of range & short datagrams are rejected, that
+// sealing stops short of `SEQ_END`, and that engine counts datagrams left
+// unsealed for want of sequence numbers apart from dropped ones.
+
+using udp_tunnel::HDR_LEN;
+using udp_tunnel::SEQ_END;
+using udp_tunnel::TAG_LEN;
+
+constexpr size_t N = 40;
+
+// Burst of `N` datagrams, along with room for sealing/ opening them
+struct dgrams_t
+{
+  uint8_t buf[N][udp_tunnel::MAX_DGRAM];
+  uint8_t* ptr[N];
+  size_t len[N];
+  bool ok[N];
+
+  dgrams_t()
+  {
+    for (size_t i = 0; i < N; i++) {
+      ptr[i] = buf[i];
+      len[i] = 0;
+    }
+  }
+
+  const uint8_t* const* in() const
+  {
+    return const_cast<const uint8_t* const*>(ptr);
+  }
+};
+
+// Loopback address, with given port
+static sockaddr_in
+loopback(const uint16_t port)
+{
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  return addr;
+}
+
+// UDP socket bound to some free loopback port, written to `addr`
+static int
+bound_socket(sockaddr_in& addr)
+{
+  const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  assert(fd >= 0);
+
+  addr = loopback(0);
+  socklen_t alen = sizeof(addr);
+  [[maybe_unused]] int r =
+    bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+  assert(r == 0);
+  r = getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &alen);
+  assert(r == 0);
+
+  const timeval tv{ 2, 0 };
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  return fd;
+}
+
+int
+main()
+{
+  uint8_t key[16], nonce[12];
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+
+  constexpr uint32_t session = 0xdeadbeef;
+
+  dgrams_t txt, sealed, opened;
+  for (size_t i = 0; i < N; i++) {
+    txt.len[i] = (i * 97) % (udp_tunnel::MAX_PAYLOAD + 1);
+    random_data(txt.buf[i], txt.len[i]);
+  }
+
+  // burst crossing 2^32 boundary of sequence numbers round trips
+  {
+    const uint64_t seq0 = (1ul << 32) - N / 2;
+
+    [[maybe_unused]] const size_t s = udp_tunnel::seal_burst(key,
+                                                            nonce,
+                                                            session,
+                                                            seq0,
+                                                            txt.in(),
+                                                            txt.len,
+                                                            sealed.ptr,
+                                                            sealed.len,
+                                                            N);
+    assert(s == N);
+
+    for (size_t i = 0; i < N; i++) {
+      assert(sealed.len[i] == txt.len[i] + HDR_LEN + TAG_LEN);
+
+      uint32_t dsession = 0;
+      uint64_t seq = 0;
+      udp_tunnel::decode_header(sealed.buf[i], dsession, seq);
+      assert(dsession == session && seq == seq0 + i);
+    }
+
+    [[maybe_unused]] const size_t good = udp_tunnel::open_burst(key,
+                                                               nonce,
+                                                               session,
+                                                               sealed.in(),
+                                                               sealed.len,
+                                                               opened.ptr,
+                                                               opened.len,
+                                                               opened.ok,
+                                                               N);
+    assert(good == N);
+
+    for (size_t i = 0; i < N; i++) {
+      assert(opened.ok[i] && opened.len[i] == txt.len[i]);
+      assert(std::memcmp(opened.buf[i], txt.buf[i], txt.len[i]) == 0);
+    }
+  }
+
+  // tampered payload & tag, out of range sequence number and short datagram
+  // are rejected, leaving others in burst intact
+  {
+    dgrams_t bad = sealed;
+    for (size_t i = 0; i < N; i++) {
+      bad.ptr[i] = bad.buf[i];
+    }
+
+    bad.buf[3][HDR_LEN + 1] ^= 1;
+    bad.buf[5][bad.len[5] - 1] ^= 0x80;
+    udp_tunnel::encode_header(session, SEQ_END, bad.buf[7]);
+    bad.len[9] = HDR_LEN + TAG_LEN - 1;
+
+    [[maybe_unused]] const size_t good = udp_tunnel::open_burst(key,
+                                                               nonce,
+                                                               session,
+                                                               bad.in(),
+                                                               bad.len,
+                                                               opened.ptr,
+                                                               opened.len,
+                                                               opened.ok,
+                                                               N);
+    assert(good == N - 4);
+
+    for (size_t i = 0; i < N; i++) {
+      const bool rejected = i == 3 || i == 5 || i == 7 || i == 9;
+      assert(opened.ok[i] == !rejected);
+      assert(opened.len[i] == (rejected ? 0 : txt.len[i]));
+    }
+  }
+
+  // datagrams of some other session are rejected
+  {
+    [[maybe_unused]] const size_t good = udp_tunnel::open_burst(key,
+                                                               nonce,
+                                                               session + 1,
+                                                               sealed.in(),
+                                                               sealed.len,
+                                                               opened.ptr,
+                                                               opened.len,
+                                                               opened.ok,
+                                                               N);
+    assert(good == 0);
+
+    for (size_t i = 0; i < N; i++) {
+      assert(!opened.ok[i] && opened.len[i] == 0);
+    }
+  }
+
+  // sealing stops short of `SEQ_END`, leaving rest of burst unsealed
+  {
+    constexpr size_t left = 5;
+
+    [[maybe_unused]] size_t s = udp_tunnel::seal_burst(key,
+                                                      nonce,
+                                                      session,
+                                                      SEQ_END - left,
+                                                      txt.in(),
+                                                      txt.len,
+                                                      sealed.ptr,
+                                                      sealed.len,
+                                                      N);
+    assert(s == left);
+
+    for (size_t i = 0; i < N; i++) {
+      assert(sealed.len[i] == (i < left ? txt.len[i] + HDR_LEN + TAG_LEN : 0));
+    }
+
+    [[maybe_unused]] const size_t good = udp_tunnel::open_burst(key,
+                                                               nonce,
+                                                               session,
+                                                               sealed.in(),
+                                                               sealed.len,
+                                                               opened.ptr,
+                                                               opened.len,
+                                                               opened.ok,
+                                                               left);
+    assert(good == left);
+
+    s = udp_tunnel::seal_burst(key,
+                               nonce,
+                               session,
+                               SEQ_END,
+                               txt.in(),
+                               txt.len,
+                               sealed.ptr,
+                               sealed.len,
+                               N);
+    assert(s == 0);
+  }
+
+  // engine seals only as many datagrams as there are sequence numbers left,
+  // counting rest as exhausted, while oversized ones are counted as dropped
+  {
+    constexpr size_t left = 3;
+    constexpr size_t sent = 6;
+
+    sockaddr_in peer{}, listen{};
+    const int rx = bound_socket(peer);
+
+    // engine binds its own socket to this port, after probe is closed
+    ::close(bound_socket(listen));
+
+    udp_tunnel::config_t cfg{};
+    std::memcpy(cfg.key, key, sizeof(key));
+    std::memcpy(cfg.nonce, nonce, sizeof(nonce));
+    cfg.session = session;
+    cfg.seq = SEQ_END - left;
+    cfg.dir = udp_tunnel::direction_t::SEAL;
+    cfg.listen = listen;
+    cfg.peer = peer;
+    cfg.workers = 1;
+    cfg.pin = false;
+
+    udp_tunnel::engine_t engine;
+    [[maybe_unused]] const bool ok = engine.start(cfg);
+    assert(ok);
+
+    const int tx = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    assert(tx >= 0);
+
+    const sockaddr* dst = reinterpret_cast<const sockaddr*>(&listen);
+    for (size_t i = 0; i < sent; i++) {
+      const size_t l = i == 1 ? udp_tunnel::MAX_PAYLOAD + 1 : txt.len[i];
+      [[maybe_unused]] const ssize_t n =
+        sendto(tx, txt.buf[i], l, 0, dst, sizeof(listen));
+      assert(n == static_cast<ssize_t>(l));
+    }
+
+    for (size_t i = 0; i < left; i++) {
+      const ssize_t n = recv(rx, sealed.buf[i], udp_tunnel::MAX_DGRAM, 0);
+      assert(n > 0);
+      sealed.len[i] = static_cast<size_t>(n);
+    }
+
+    for (size_t i = 0; i < 200 && engine.rx_packets() < sent; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    engine.stop();
+
+    assert(engine.rx_packets() == sent);
+    assert(engine.tx_packets() == left);
+    assert(engine.dropped() == 1);
+    assert(engine.exhausted() == sent - 1 - left);
+    assert(engine.exhausted(0) == engine.exhausted());
+    assert(engine.next_seq() == SEQ_END);
+
+    // last sequence numbers went to first datagrams which fit
+    [[maybe_unused]] const size_t good = udp_tunnel::open_burst(key,
+                                                               nonce,
+                                                               session,
+                                                               sealed.in(),
+                                                               sealed.len,
+                                                               opened.ptr,
+                                                               opened.len,
+                                                               opened.ok,
+                                                               left);
+    assert(good == left);
+
+    for (size_t i = 0, j = 0; i < left; i++, j += 1 + (j == 0)) {
+      uint32_t dsession = 0;
+      uint64_t seq = 0;
+      udp_tunnel::decode_header(sealed.buf[i], dsession, seq);
+      assert(seq == SEQ_END - left + i);
+
+      assert(opened.len[i] == txt.len[j]);
+      assert(std::memcmp(opened.buf[i], txt.buf[j], txt.len[j]) == 0);
+    }
+
+    ::close(tx);
+    ::close(rx);
+  }
+
+  std::cout << "[test] udp_tunnel : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,124 @@
+#include "grain_128aead.hpp"
+#include "utils.hpp"
+#include "width_policy.hpp"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+// Tests per-thread width selection of decoupled Grain-128 AEAD ( see
+// width_policy.hpp ), running back-to-back calls ( i.e. at high duty cycle ),
+// checking that short messages stay on scalar kernels, that long ones switch to
+// a wider width, bounded by `max_width`, and stay there, that a large enough
+// hysteresis keeps width from switching at all, and that call/ byte/ switch
+// counters match calls made. Output of every width must decrypt back.
+
+using width_policy::width_t;
+
+// Runs `n` back-to-back encryptions of `len` -bytes messages, checking that
+// each decrypts back, and returns width selected by then
+static width_t
+run(width_policy::selector_t& sel, const size_t len, const size_t n)
+{
+  uint8_t key[16], nonce[12], data[16], tag[8];
+  std::vector<uint8_t> txt(len), enc(len), dec(len);
+
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+  random_data(data, sizeof(data));
+  random_data(txt.data(), len);
+
+  for (size_t i = 0; i < n; i++) {
+    sel.encrypt(
+      key, nonce, data, sizeof(data), txt.data(), enc.data(), len, tag);
+  }
+
+  [[maybe_unused]] const bool ok = grain_128aead::decrypt(
+    key, nonce, tag, data, sizeof(data), enc.data(), dec.data(), len);
+  assert(ok && dec == txt);
+
+  return sel.observed().width;
+}
+
+// Config converging in a few dozen calls, whose duty cycle isn't reset by
+// occasional preemption of test process
+static width_policy::config_t
+fast_config(const width_t max_width)
+{
+  width_policy::config_t cfg;
+  cfg.min_wide_bytes = 4096;
+  cfg.alpha = 0.25;
+  cfg.idle_reset_ns = 1'000'000'000;
+  cfg.max_width = max_width;
+  return cfg;
+}
+
+int
+main()
+{
+  constexpr size_t LONG = 1ul << 14;
+  constexpr size_t CALLS = 256;
+
+  // messages shorter than `min_wide_bytes` stay on scalar kernels, however
+  // busy thread is
+  {
+    width_policy::selector_t sel(fast_config(width_t::V512));
+
+    [[maybe_unused]] const width_t w = run(sel, 1024, CALLS);
+    assert(w == width_t::SCALAR);
+    assert(sel.observed().duty > 0.);
+
+    [[maybe_unused]] const auto s = sel.stats();
+    assert(s.scalar_calls == CALLS && s.scalar_bytes == CALLS * 1024);
+    assert(s.v256_calls == 0 && s.v256_bytes == 0);
+    assert(s.v512_calls == 0 && s.v512_bytes == 0);
+    assert(s.switches == 0);
+  }
+
+  // long messages at high duty cycle switch to widest allowed width, and stay
+  // there
+  for (const width_t max : { width_t::V256, width_t::V512 }) {
+    width_policy::selector_t sel(fast_config(max));
+
+    [[maybe_unused]] width_t w = run(sel, LONG, CALLS);
+    assert(w == max);
+
+    const auto s0 = sel.stats();
+    assert(s0.switches >= 1 && s0.switches <= 2);
+
+    w = run(sel, LONG, CALLS);
+    assert(w == max);
+
+    [[maybe_unused]] const auto s1 = sel.stats();
+    assert(s1.switches == s0.switches);
+    assert(s1.scalar_calls + s1.v256_calls + s1.v512_calls == 2 * CALLS);
+    assert(s1.scalar_bytes == s1.scalar_calls * LONG);
+    assert(s1.v256_bytes == s1.v256_calls * LONG);
+    assert(s1.v512_bytes == s1.v512_calls * LONG);
+
+    // all calls of second round went to selected width
+    [[maybe_unused]] const uint64_t wide =
+      max == width_t::V512 ? s1.v512_calls - s0.v512_calls
+                           : s1.v256_calls - s0.v256_calls;
+    assert(wide == CALLS);
+    assert(max == width_t::V512 || s1.v512_calls == 0);
+  }
+
+  // gain of wider width never makes up for hysteresis this large
+  {
+    auto cfg = fast_config(width_t::V512);
+    cfg.hysteresis = 1.;
+
+    width_policy::selector_t sel(cfg);
+
+    [[maybe_unused]] const width_t w = run(sel, LONG, CALLS);
+    assert(w == width_t::SCALAR);
+    assert(sel.observed().duty > 0.5);
+
+    [[maybe_unused]] const auto s = sel.stats();
+    assert(s.scalar_calls == CALLS && s.scalar_bytes == CALLS * LONG);
+    assert(s.switches == 0);
+  }
+
+  std::cout << "[test] width_policy : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
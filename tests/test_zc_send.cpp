@@ -0,0 +1,236 @@
+#include "utils.hpp"
+#include "zc_send.hpp"
+#include <arpa/inet.h>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Tests sealed file streaming ( see zc_send.hpp ) over loopback TCP & Unix
+// domain sockets, with zero-copy on & off and through plain copying sender,
+// for empty, single & multi record files, checking that receiver gets file
+// back, while files shorter than declared, oversized, tampered, reordered &
+// truncated streams are rejected.
+
+constexpr size_t CHUNK = 10000;
+
+// Connected pair of loopback TCP sockets
+static void
+tcp_pair(int& a, int& b)
+{
+  const int l = socket(AF_INET, SOCK_STREAM, 0);
+  assert(l >= 0);
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  socklen_t alen = sizeof(addr);
+  [[maybe_unused]] int r =
+    bind(l, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+  assert(r == 0);
+  r = listen(l, 1);
+  assert(r == 0);
+  r = getsockname(l, reinterpret_cast<sockaddr*>(&addr), &alen);
+  assert(r == 0);
+
+  a = socket(AF_INET, SOCK_STREAM, 0);
+  r = connect(a, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+  assert(r == 0);
+  b = accept(l, nullptr, nullptr);
+  assert(b >= 0);
+
+  close(l);
+}
+
+// Anonymous temporary file, holding given bytes
+static int
+temp_file(const std::vector<uint8_t>& data)
+{
+  char path[] = "/tmp/test_zc_send.XXXXXX";
+  const int fd = mkstemp(path);
+  assert(fd >= 0);
+  unlink(path);
+
+  [[maybe_unused]] const ssize_t n = write(fd, data.data(), data.size());
+  assert(n == static_cast<ssize_t>(data.size()));
+  return fd;
+}
+
+// Writes records sealed by `seal_record` into `buf`, for building streams by
+// hand
+static void
+append_record(std::vector<uint8_t>& buf,
+              const uint8_t* const key,
+              const uint8_t* const nonce,
+              const uint64_t idx,
+              const bool last,
+              const std::vector<uint8_t>& txt)
+{
+  const size_t off = buf.size();
+  buf.resize(off + zc_send::HDR_LEN + txt.size() + zc_send::TAG_LEN);
+
+  zc_send::seal_record(
+    key, nonce, idx, last, txt.data(), txt.size(), buf.data() + off);
+}
+
+// Sends hand built stream over Unix domain socket pair, returning whether
+// receiver accepts it
+static bool
+receive(const uint8_t* const key,
+        const uint8_t* const nonce,
+        const std::vector<uint8_t>& stream,
+        const size_t max_chunk = 1ul << 16)
+{
+  int sv[2];
+  [[maybe_unused]] const int r = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+  assert(r == 0);
+
+  zc_send::stats_t st;
+  std::thread tx([&] {
+    zc_send::send_all(sv[0], stream.data(), stream.size(), st);
+    shutdown(sv[0], SHUT_WR);
+  });
+
+  std::vector<uint8_t> out;
+  const bool ok = zc_send::recv_file(key, nonce, sv[1], out, max_chunk);
+  tx.join();
+
+  close(sv[0]);
+  close(sv[1]);
+  return ok;
+}
+
+int
+main()
+{
+  uint8_t key[16], nonce[12];
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+
+  // 0 - TCP, zero-copy; 1 - TCP, without zero-copy; 2 - Unix domain socket,
+  // which rejects SO_ZEROCOPY; 3 - TCP, plain copying sender
+  for (size_t mode = 0; mode < 4; mode++) {
+    for (const size_t flen :
+         { 0ul, 1ul, CHUNK - 1, CHUNK, CHUNK + 1, 37 * CHUNK + 5 }) {
+      std::vector<uint8_t> txt(flen);
+      random_data(txt.data(), flen);
+      const int fd = temp_file(txt);
+
+      int a, b;
+      if (mode == 2) {
+        int sv[2];
+        [[maybe_unused]] const int r = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+        assert(r == 0);
+        a = sv[0];
+        b = sv[1];
+      } else {
+        tcp_pair(a, b);
+      }
+
+      std::vector<uint8_t> out;
+      bool rok = false;
+      std::thread rx(
+        [&] { rok = zc_send::recv_file(key, nonce, b, out, CHUNK); });
+
+      zc_send::config_t cfg;
+      cfg.chunk = CHUNK;
+      cfg.ring = 4;
+      cfg.zerocopy = mode != 1;
+
+      zc_send::sender_t snd(a, cfg);
+      assert(snd.ok());
+
+      bool ok = false;
+      if (mode == 3) {
+        ok = zc_send::send_file_copy(key, nonce, fd, flen, a, CHUNK);
+      } else {
+        ok = snd.send_file(key, nonce, fd, flen);
+        ok = snd.drain() && ok;
+      }
+      rx.join();
+
+      assert(ok && rok);
+      assert(out == txt);
+
+      if (mode < 3) {
+        const auto st = snd.stats();
+        assert(st.records == (flen == 0 ? 1 : (flen + CHUNK - 1) / CHUNK));
+        assert(mode == 0 || (st.zc_sends == 0 && !st.zerocopy));
+      }
+
+      close(a);
+      close(b);
+      close(fd);
+    }
+  }
+
+  // file shorter than declared length is rejected, before anything is sent
+  {
+    std::vector<uint8_t> txt(CHUNK + 1);
+    random_data(txt.data(), txt.size());
+    const int fd = temp_file(txt);
+
+    int a, b;
+    tcp_pair(a, b);
+
+    zc_send::sender_t snd(a);
+    assert(!snd.send_file(key, nonce, fd, txt.size() + 1));
+    assert(snd.stats().records == 0);
+
+    close(a);
+    close(b);
+    close(fd);
+  }
+
+  // hand built streams
+  {
+    std::vector<uint8_t> t0(100), t1(CHUNK), t2(0);
+    random_data(t0.data(), t0.size());
+    random_data(t1.data(), t1.size());
+
+    std::vector<uint8_t> good;
+    append_record(good, key, nonce, 0, false, t0);
+    append_record(good, key, nonce, 1, false, t1);
+    append_record(good, key, nonce, 2, true, t2);
+    assert(receive(key, nonce, good));
+
+    // record larger than receiver accepts
+    assert(!receive(key, nonce, good, CHUNK - 1));
+
+    // tampered header, cipher text & tag
+    for (const size_t off : { 0ul, 9ul, 20ul, 100ul + zc_send::HDR_LEN }) {
+      auto bad = good;
+      bad[off] ^= 1;
+      assert(!receive(key, nonce, bad));
+    }
+
+    // under another key or base nonce
+    uint8_t other[16];
+    std::memcpy(other, key, sizeof(key));
+    other[0] ^= 1;
+    assert(!receive(other, nonce, good));
+    assert(!receive(key, other, good));
+
+    // truncated, missing last record
+    std::vector<uint8_t> trunc;
+    append_record(trunc, key, nonce, 0, false, t0);
+    append_record(trunc, key, nonce, 1, false, t1);
+    assert(!receive(key, nonce, trunc));
+
+    // truncated within a record
+    trunc = good;
+    trunc.pop_back();
+    assert(!receive(key, nonce, trunc));
+
+    // records out of order
+    std::vector<uint8_t> swapped;
+    append_record(swapped, key, nonce, 1, false, t1);
+    append_record(swapped, key, nonce, 0, false, t0);
+    append_record(swapped, key, nonce, 2, true, t2);
+    assert(!receive(key, nonce, swapped));
+  }
+
+  std::cout << "[test] zc_send : passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#!/usr/bin/python3
+
+"""
+Measures what calling Grain-128 AEAD encrypt/ decrypt costs through each of
+
+- inline : header-only C++ implementation, inlined into call site
+- c_abi  : `extern "C"` layer of dlopen'd `libgrain_128aead.so`
+- python : ctypes based Python wrapper, on top of same shared library
+
+for a range of message sizes, fitting time = fixed + per_byte * size for each
+path ( least squares ), and reporting fixed per-call overhead of each path over
+inline one, along with break-even size i.e. message size at which crypto work
+itself costs as much as that overhead; below it, calls across FFI boundary are
+dominated by overhead and should be batched.
+
+Native timings come from `ffi_{encrypt,decrypt}` benchmarks of `bench/a.out`,
+Python ones are taken here, using `timeit`, for same sizes.
+
+Usage: make ffi_overhead ( or python3 tools/ffi_overhead.py, after running
+`make lib bench/a.out` )
+
+Author: Anjan Roy <hello@itzmeanjan.in>
+
+Project: https://github.com/itzmeanjan/grain-128aead
+"""
+
+import json
+import os
+import subprocess
+import sys
+import timeit
+from typing import Dict, List, Tuple
+
+import numpy as np
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+# Python wrapper loads shared library relative to working directory
+os.chdir(os.path.join(ROOT, "wrapper", "python"))
+sys.path.insert(0, os.getcwd())
+import grain_128aead  # noqa: E402
+
+# ( operation, path ) -> [( message size, nanoseconds per call )]
+Samples = Dict[Tuple[str, str], List[Tuple[int, float]]]
+
+
+def native(samples: Samples):
+    """
+    Runs native benchmarks, collecting timings of inline & C ABI paths
+    """
+    out = subprocess.run(
+        [
+            os.path.join(ROOT, "bench", "a.out"),
+            "--benchmark_filter=ffi_",
+            "--benchmark_format=json",
+            "--benchmark_min_time=0.2",
+        ],
+        cwd=ROOT,
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+
+    scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+    for bench in json.loads(out)["benchmarks"]:
+        name, _, size = bench["name"].split("/")
+        op = "encrypt" if "ffi_encrypt" in name else "decrypt"
+        path = "c_abi" if "<true>" in name else "inline"
+
+        t = bench["real_time"] * scale[bench["time_unit"]]
+        samples.setdefault((op, path), []).append((int(size), t))
+
+
+def python(samples: Samples, sizes: List[int]):
+    """
+    Times Python wrapper, for same message sizes as native benchmarks
+    """
+    key, nonce = os.urandom(16), os.urandom(12)
+
+    for size in sizes:
+        text = os.urandom(size)
+        enc, tag = grain_128aead.encrypt(key, nonce, b"", text)
+
+        for op, fn in [
+            ("encrypt", lambda: grain_128aead.encrypt(key, nonce, b"", text)),
+            ("decrypt", lambda: grain_128aead.decrypt(key, nonce, tag, b"", enc)),
+        ]:
+            timer = timeit.Timer(fn)
+            n, _ = timer.autorange()
+            best = min(timer.repeat(repeat=5, number=n)) / n
+
+            samples.setdefault((op, "python"), []).append((size, best * 1e9))
+
+
+def fit(points: List[Tuple[int, float]]) -> Tuple[float, float]:
+    """
+    Least squares fit of time = fixed + per_byte * size, returning ( fixed,
+    per_byte ), in nanoseconds
+    """
+    x = np.array([p[0] for p in points], dtype=np.float64)
+    y = np.array([p[1] for p in points], dtype=np.float64)
+
+    per_byte, fixed = np.polyfit(x, y, 1)
+    return max(fixed, 0.0), per_byte
+
+
+def main():
+    samples: Samples = {}
+
+    native(samples)
+    sizes = sorted({s for s, _ in samples[("encrypt", "inline")]})
+    python(samples, sizes)
+
+    print(
+        f"{'op':<8} {'path':<7} {'fixed ns':>10} {'ns/byte':>9} "
+        f"{'overhead ns':>12} {'break-even B':>13}"
+    )
+
+    for op in ["encrypt", "decrypt"]:
+        base_fixed, base_per_byte = fit(samples[(op, "inline")])
+
+        for path in ["inline", "c_abi", "python"]:
+            fixed, per_byte = fit(samples[(op, path)])
+            overhead = max(fixed - base_fixed, 0.0)
+            even = overhead / base_per_byte if base_per_byte > 0 else 0.0
+
+            print(
+                f"{op:<8} {path:<7} {fixed:>10.1f} {per_byte:>9.3f} "
+                f"{overhead:>12.1f} {even:>13.0f}"
+            )
+
+
+if __name__ == "__main__":
+    main()
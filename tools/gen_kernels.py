@@ -0,0 +1,449 @@
+#!/usr/bin/python3
+
+"""
+Offline generator of Grain-128 AEAD bit-parallel kernels, which takes tap
+specifications of boolean functions `l`, `f` ( without s0 ), `h` & pre-output
+function `ksb`, and emits C++ kernels computing W consecutive clocks in
+parallel, for W ∈ {8, 16, 32}, working on arrays of W -bit words ( or on
+SIMD vectors of such words, as kernels are templated on word type ).
+
+Expressions are minimised before being emitted
+
+- each register word is loaded only once
+- linear taps sharing same in-word shift are XOR-ed before shifting, as
+  (a >> s) ^ (b >> s) = (a ^ b) >> s
+- factors of a product term sharing same in-word shift are AND-ed before
+  shifting, as (a >> s) & (b >> s) = (a & b) >> s, when that's cheaper ( see
+  below )
+- product terms sharing a variable are factored out, reducing AND count
+- common subexpressions are computed only once
+
+Grouping factors by shift saves 2 shifts & 1 XOR per grouped factor, but costs
+1 extra AND, as both low & high words need to be AND-ed. So each kernel is built
+both with & without such grouping and the form with lower cost ( as weighted
+by `COST` ) is emitted; op counts of both forms are stated above each kernel.
+
+Each emitted kernel is verified against bit-by-bit reference evaluation of tap
+specification, on random register states, before generated header is written.
+
+Usage: python3 tools/gen_kernels.py include/kernels.hpp
+
+Author: Anjan Roy <hello@itzmeanjan.in>
+
+Project: https://github.com/itzmeanjan/grain-128aead
+"""
+
+import random
+import sys
+from typing import Dict, List, Tuple
+
+# A tap is ( register, bit index ), where register is "s" ( LFSR ) or "b" ( NFSR )
+Tap = Tuple[str, int]
+
+# Tap specifications, following page 7 of Grain-128 AEAD specification
+# https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/grain-128aead-spec-final.pdf
+#
+# Each function is sum ( XOR ) of linear taps & product ( AND ) terms.
+SPECS: Dict[str, Dict[str, list]] = {
+    # L(St) = s0 + s7 + s38 + s70 + s81 + s96
+    "l": {
+        "lin": [("s", 0), ("s", 7), ("s", 38), ("s", 70), ("s", 81), ("s", 96)],
+        "prod": [],
+    },
+    # F(Bt), NFSR feedback, which must be XOR-ed with s0 for getting f
+    "fb": {
+        "lin": [("b", 0), ("b", 26), ("b", 56), ("b", 91), ("b", 96)],
+        "prod": [
+            [("b", 3), ("b", 67)],
+            [("b", 11), ("b", 13)],
+            [("b", 17), ("b", 18)],
+            [("b", 27), ("b", 59)],
+            [("b", 40), ("b", 48)],
+            [("b", 61), ("b", 65)],
+            [("b", 68), ("b", 84)],
+            [("b", 22), ("b", 24), ("b", 25)],
+            [("b", 70), ("b", 78), ("b", 82)],
+            [("b", 88), ("b", 92), ("b", 93), ("b", 95)],
+        ],
+    },
+    # h(x) = x0x1 + x2x3 + x4x5 + x6x7 + x0x4x8
+    "h": {
+        "lin": [],
+        "prod": [
+            [("b", 12), ("s", 8)],
+            [("s", 13), ("s", 20)],
+            [("b", 95), ("s", 42)],
+            [("s", 60), ("s", 79)],
+            [("b", 12), ("b", 95), ("s", 94)],
+        ],
+    },
+}
+
+# yt = h(x) + s93 + b2 + b15 + b36 + b45 + b64 + b73 + b89
+SPECS["ksb"] = {
+    "lin": [("s", 93)] + [("b", i) for i in (2, 15, 36, 45, 64, 73, 89)],
+    "prod": SPECS["h"]["prod"],
+}
+
+# Registers consumed by each kernel, in order of kernel parameters
+PARAMS = {"l": ["s"], "fb": ["b"], "h": ["b", "s"], "ksb": ["b", "s"]}
+ARRAY = {"s": "lfsr", "b": "nfsr"}
+
+DOCS = {
+    "l": "L(St) --- update function of LFSR",
+    "fb": "F(Bt) --- NFSR feedback, excluding s0 term of f",
+    "h": "h(x) --- boolean function of pre-output generator",
+    "ksb": "yt --- pre-output generator function",
+}
+WORD = {"s": "lw", "b": "nw"}
+
+WIDTHS = [8, 16, 32, 64]
+
+# Relative cost of each op kind, used for picking between grouped & ungrouped
+# forms of a kernel; loads aren't counted as each register word is loaded once
+COST = {"shift": 1, "xor": 1, "and": 1}
+
+
+class Builder:
+    """
+    Builds expression DAG, hash-consing nodes so that common subexpressions
+    are shared; node is a tuple ( op, operand... )
+    """
+
+    def __init__(self, width: int, group: bool = True):
+        self.width = width
+        self.group = group
+        self.nodes: Dict[tuple, int] = {}
+        self.order: List[tuple] = []
+
+    def node(self, *key) -> int:
+        # XOR/ AND are commutative, so normalise operand order
+        if key[0] in ("xor", "and"):
+            key = (key[0],) + tuple(sorted(key[1:]))
+        if key not in self.nodes:
+            self.nodes[key] = len(self.order)
+            self.order.append(key)
+        return self.nodes[key]
+
+    def load(self, reg: str, idx: int) -> int:
+        return self.node("load", reg, idx)
+
+    def window(self, tap: Tap) -> int:
+        """
+        W consecutive bits of register, starting at tap index
+        """
+        reg, t = tap
+        w, s = divmod(t, self.width)
+        lo = self.load(reg, w)
+        if s == 0:
+            return lo
+        hi = self.load(reg, w + 1)
+        return self.node(
+            "xor", self.node("shr", lo, s), self.node("shl", hi, self.width - s)
+        )
+
+    def xor_all(self, ids: List[int]) -> int:
+        ids = sorted(ids)
+        acc = ids[0]
+        for i in ids[1:]:
+            acc = self.node("xor", acc, i)
+        return acc
+
+    def and_all(self, ids: List[int]) -> int:
+        ids = sorted(ids)
+        acc = ids[0]
+        for i in ids[1:]:
+            acc = self.node("and", acc, i)
+        return acc
+
+    def linear(self, taps: List[Tap]) -> List[int]:
+        """
+        Sum of linear taps, XOR-ing words sharing same shift before shifting
+        """
+        groups: Dict[Tuple[str, int], List[int]] = {}
+        for reg, t in taps:
+            w, s = divmod(t, self.width)
+            groups.setdefault(("lo", s), []).append(self.load(reg, w))
+            if s != 0:
+                groups.setdefault(("hi", s), []).append(self.load(reg, w + 1))
+
+        terms = []
+        for (part, s), words in sorted(groups.items()):
+            acc = self.xor_all(words)
+            if s == 0:
+                terms.append(acc)
+            elif part == "lo":
+                terms.append(self.node("shr", acc, s))
+            else:
+                terms.append(self.node("shl", acc, self.width - s))
+        return terms
+
+    def product(self, taps: List[Tap]) -> int:
+        """
+        Product of taps, AND-ing words sharing same shift before shifting, as
+        (a >> s) & (b >> s) = (a & b) >> s
+        """
+        groups: Dict[int, List[Tap]] = {}
+        for reg, t in taps:
+            groups.setdefault(t % self.width, []).append((reg, t))
+
+        factors = []
+        for s, grp in sorted(groups.items()):
+            if s == 0 or len(grp) == 1 or not self.group:
+                factors.extend(self.window(v) for v in grp)
+                continue
+
+            lo = [self.load(r, t // self.width) for r, t in grp]
+            hi = [self.load(r, t // self.width + 1) for r, t in grp]
+            factors.append(
+                self.node(
+                    "xor",
+                    self.node("shr", self.and_all(lo), s),
+                    self.node("shl", self.and_all(hi), self.width - s),
+                )
+            )
+
+        return self.and_all(factors)
+
+    def products(self, prods: List[List[Tap]]) -> List[int]:
+        """
+        Sum of product terms, greedily factoring out variable shared by most
+        terms, as ab + ac = a(b + c)
+        """
+        if not prods:
+            return []
+
+        cnt: Dict[Tap, int] = {}
+        for p in prods:
+            for v in p:
+                cnt[v] = cnt.get(v, 0) + 1
+        var, c = max(sorted(cnt.items()), key=lambda kv: kv[1])
+
+        if c < 2:
+            return [self.product(p) for p in prods]
+
+        with_var = [[v for v in p if v != var] for p in prods if var in p]
+        rest = [p for p in prods if var not in p]
+
+        # a term consisting of only `var` contributes `var` itself, i.e. 1 inside
+        # factored sum, which can't be represented; keep such terms as they are
+        inner_terms = []
+        for p in with_var:
+            if not p:
+                rest.append([var])
+        with_var = [p for p in with_var if p]
+        inner_terms = self.products(with_var)
+
+        factored = self.node("and", self.window(var), self.xor_all(inner_terms))
+        return [factored] + self.products(rest)
+
+
+def build(name: str, width: int, group: bool = True) -> Tuple[Builder, int]:
+    b = Builder(width, group)
+    spec = SPECS[name]
+    terms = b.products(spec["prod"]) + b.linear(spec["lin"])
+    return b, b.xor_all(terms)
+
+
+def naive_ops(name: str, width: int) -> Dict[str, int]:
+    """
+    Operation count of straight-forward, one extraction per tap, implementation
+    ( as found in hand-written `grain_128.hpp` kernels )
+    """
+    spec = SPECS[name]
+    taps = list(spec["lin"]) + [v for p in spec["prod"] for v in p]
+    ops = {"shift": 0, "xor": 0, "and": 0}
+    for _, t in taps:
+        if t % width != 0:
+            ops["shift"] += 2
+            ops["xor"] += 1
+    ops["and"] = sum(len(p) - 1 for p in spec["prod"])
+    ops["xor"] += len(spec["lin"]) + len(spec["prod"]) - 1
+    return ops
+
+
+def emitted_ops(b: Builder) -> Dict[str, int]:
+    ops = {"shift": 0, "xor": 0, "and": 0}
+    for key in b.order:
+        if key[0] in ("shr", "shl"):
+            ops["shift"] += 1
+        elif key[0] in ops:
+            ops[key[0]] += 1
+    return ops
+
+
+def cost(ops: Dict[str, int]) -> int:
+    return sum(COST[k] * v for k, v in ops.items())
+
+
+def cheapest(name: str, width: int) -> Tuple[Builder, int, Dict[str, dict]]:
+    """
+    Builds kernel with & without grouping of product factors by shift, returning
+    the one with lower cost ( fewer ANDs on tie ), along with op counts of both
+    """
+    forms = {}
+    for form, group in (("ungrouped", False), ("grouped", True)):
+        b, root = build(name, width, group)
+        forms[form] = (b, root, emitted_ops(b))
+
+    pick = min(forms, key=lambda f: (cost(forms[f][2]), forms[f][2]["and"]))
+    b, root, _ = forms[pick]
+    counts = {f: forms[f][2] for f in forms}
+    counts["pick"] = pick
+    return b, root, counts
+
+
+def feasible(name: str, width: int) -> bool:
+    """
+    W consecutive clocks can be computed in parallel, from 128 -bit registers,
+    only if all W bits of each tap window live inside the register
+    """
+    spec = SPECS[name]
+    taps = list(spec["lin"]) + [v for p in spec["prod"] for v in p]
+    return all(t + width <= 128 for _, t in taps)
+
+
+def evaluate(b: Builder, root: int, regs: Dict[str, int]) -> int:
+    """
+    Evaluates expression DAG on 128 -bit register values
+    """
+    w = b.width
+    msk = (1 << w) - 1
+    vals: List[int] = []
+    for key in b.order:
+        op = key[0]
+        if op == "load":
+            vals.append((regs[key[1]] >> (key[2] * w)) & msk)
+        elif op == "shr":
+            vals.append(vals[key[1]] >> key[2])
+        elif op == "shl":
+            vals.append((vals[key[1]] << key[2]) & msk)
+        elif op == "xor":
+            vals.append(vals[key[1]] ^ vals[key[2]])
+        elif op == "and":
+            vals.append(vals[key[1]] & vals[key[2]])
+    return vals[root]
+
+
+def reference(name: str, width: int, regs: Dict[str, int]) -> int:
+    """
+    Bit-by-bit evaluation of tap specification, for W consecutive clocks
+    """
+    spec = SPECS[name]
+    res = 0
+    for c in range(width):
+        bit = 0
+        for reg, t in spec["lin"]:
+            bit ^= (regs[reg] >> (t + c)) & 1
+        for p in spec["prod"]:
+            prod = 1
+            for reg, t in p:
+                prod &= (regs[reg] >> (t + c)) & 1
+            bit ^= prod
+        res |= bit << c
+    return res
+
+
+def verify(name: str, width: int, b: Builder, root: int, trials: int = 2000):
+    rng = random.Random(0x6A41)
+    for _ in range(trials):
+        regs = {"s": rng.getrandbits(128), "b": rng.getrandbits(128)}
+        exp = reference(name, width, regs)
+        got = evaluate(b, root, regs)
+        assert exp == got, f"kernel {name}x{width} mismatch on {regs} !"
+
+
+def emit(name: str, width: int, b: Builder, root: int, counts: dict) -> str:
+    """
+    Emits C++ kernel, templated on word type, so that it can work on scalar W
+    -bit words as well as on GCC/ Clang SIMD vectors of W -bit words
+    """
+    naive = naive_ops(name, width)
+    fmt = lambda o: f"{o['shift']} shift, {o['xor']} xor, {o['and']} and"
+    ung, grp = counts["ungrouped"], counts["grouped"]
+
+    params = ",\n".join(
+        f"{' ' * (len(name) + 3 + len(str(width)))}const T* const {ARRAY[r]}"
+        for r in PARAMS[name]
+    ).lstrip()
+    lines = [
+        f"// {DOCS[name]}, for {width} consecutive clocks",
+        "//",
+        f"// naive: {fmt(naive)}",
+        f"// ungrouped: {fmt(ung)} ( cost {cost(ung)} )",
+        f"// grouped: {fmt(grp)} ( cost {cost(grp)} )",
+        f"// emitted: {counts['pick']}",
+        f"template<typename T = uint{width}_t>",
+        "inline static T",
+        f"{name}x{width}({params})",
+        "{",
+    ]
+
+    names: List[str] = []
+    tmp = 0
+    for key in b.order:
+        op = key[0]
+        if op == "load":
+            names.append(f"{WORD[key[1]]}{key[2]}")
+            expr = f"{ARRAY[key[1]]}[{key[2]}]"
+        else:
+            names.append(f"t{tmp}")
+            tmp += 1
+            if op == "shr":
+                expr = f"static_cast<T>({names[key[1]]} >> {key[2]})"
+            elif op == "shl":
+                expr = f"static_cast<T>({names[key[1]]} << {key[2]})"
+            elif op == "xor":
+                expr = f"static_cast<T>({names[key[1]]} ^ {names[key[2]]})"
+            else:
+                expr = f"static_cast<T>({names[key[1]]} & {names[key[2]]})"
+        lines.append(f"  const T {names[-1]} = {expr};")
+
+    lines.append(f"  return {names[root]};")
+    lines.append("}")
+    return "\n".join(lines)
+
+
+HEADER = """#pragma once
+#include <cstdint>
+
+// Bit-parallel Grain-128 AEAD kernels, generated by `tools/gen_kernels.py`
+// from tap specifications; don't edit by hand, regenerate using `make kernels`
+//
+// Kernels computing W consecutive clocks take 128 -bit registers as arrays of
+// W -bit words ( little endian word order i.e. bit i of register is bit
+// (i mod W) of word (i / W) ) and are templated on word type, so that they can
+// also work on SIMD vectors of W -bit words.
+//
+// Note, W = 64 can't be supported on 128 -bit registers, as some taps ( say
+// s96 of L ) would need bits beyond end of register.
+namespace kernels {
+"""
+
+
+def main():
+    out = sys.argv[1] if len(sys.argv) > 1 else "include/kernels.hpp"
+    chunks = [HEADER]
+
+    for width in WIDTHS:
+        for name in ("l", "fb", "h", "ksb"):
+            if not feasible(name, width):
+                print(f"skipping {name}x{width}: taps exceed 128 -bit register")
+                continue
+
+            b, root, counts = cheapest(name, width)
+            verify(name, width, b, root)
+            chunks.append(emit(name, width, b, root, counts) + "\n")
+            print(
+                f"{name}x{width}: naive {naive_ops(name, width)}, "
+                f"ungrouped {counts['ungrouped']}, grouped {counts['grouped']}, "
+                f"emitting {counts['pick']}"
+            )
+
+    chunks.append("}\n")
+    with open(out, "w") as fd:
+        fd.write("\n".join(chunks))
+
+
+if __name__ == "__main__":
+    main()
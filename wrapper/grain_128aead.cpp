@@ -1,4 +1,9 @@
 #include "grain_128aead.hpp"
+#include "worker_pool.hpp"
+#include <atomic>
+#include <memory>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 // Thin C wrapper on top of underlying C++ implementation of Grain-128
 // authenticated encryption with associated data, which can be used for
@@ -29,8 +34,171 @@ extern "C"
     uint8_t* const __restrict,       // M -bytes decrypted text
     const size_t // byte length of encrypted/ decrypted text = M | >= 0
   );
+
+  void grain_128aead_retag(
+    const uint8_t* const __restrict, // 128 -bit secret key
+    const uint8_t* const __restrict, // 96 -bit nonce
+    const uint8_t* const __restrict, // N -bytes old associated data
+    const uint8_t* const __restrict, // N -bytes new associated data
+    const size_t, // byte length of associated data = N | >= 0
+    const uint8_t* const, // 64 -bit old authentication tag
+    uint8_t* const        // 64 -bit new authentication tag, may alias old one
+  );
+
+  bool grain_128aead_reseal(
+    const uint8_t* const __restrict, // 128 -bit old secret key
+    const uint8_t* const __restrict, // 96 -bit old nonce
+    const uint8_t* const __restrict, // 64 -bit old authentication tag
+    const uint8_t* const __restrict, // N -bytes old associated data
+    const size_t, // byte length of old associated data = N | >= 0
+    const uint8_t* const __restrict, // 128 -bit new secret key
+    const uint8_t* const __restrict, // 96 -bit new nonce
+    const uint8_t* const __restrict, // K -bytes new associated data
+    const size_t, // byte length of new associated data = K | >= 0
+    const uint8_t* const __restrict, // M -bytes old encrypted text
+    uint8_t* const __restrict,       // M -bytes new encrypted text
+    const size_t,             // byte length of encrypted texts = M | >= 0
+    uint8_t* const __restrict // 64 -bit new authentication tag
+  );
+
+  void grain_128aead_warm_up(
+    const size_t,              // number of warm-up passes | > 0
+    uint8_t* const __restrict, // B -bytes buffer to pre-fault, may be null
+    const size_t               // byte length of buffer = B | >= 0
+  );
+
+  void* grain_128aead_pool_create(
+    const size_t // number of worker threads | = 0 means one per CPU
+  );
+
+  void grain_128aead_pool_destroy(void* const // handle to native worker pool
+  );
+
+  int grain_128aead_pool_eventfd(void* const // handle to native worker pool
+  );
+
+  size_t grain_128aead_pool_reap(
+    void* const,    // handle to native worker pool
+    uint64_t* const, // completed job ids are written here
+    const size_t     // capacity of job id buffer
+  );
+
+  void grain_128aead_pool_encrypt(
+    void* const,                // handle to native worker pool
+    const uint64_t,             // job id, reported back on completion
+    const size_t,               // number of messages in this batch = B
+    const uint8_t* const* const, // B -many 128 -bit secret keys
+    const uint8_t* const* const, // B -many 96 -bit nonces
+    const uint8_t* const* const, // B -many associated data
+    const size_t* const,         // B -many associated data lengths
+    const uint8_t* const* const, // B -many plain texts
+    uint8_t* const* const,       // B -many encrypted texts
+    const size_t* const,         // B -many plain/ encrypted text lengths
+    uint8_t* const* const        // B -many 64 -bit authentication tags
+  );
+
+  void grain_128aead_pool_decrypt(
+    void* const,                // handle to native worker pool
+    const uint64_t,             // job id, reported back on completion
+    const size_t,               // number of messages in this batch = B
+    const uint8_t* const* const, // B -many 128 -bit secret keys
+    const uint8_t* const* const, // B -many 96 -bit nonces
+    const uint8_t* const* const, // B -many 64 -bit authentication tags
+    const uint8_t* const* const, // B -many associated data
+    const size_t* const,         // B -many associated data lengths
+    const uint8_t* const* const, // B -many encrypted texts
+    uint8_t* const* const,       // B -many decrypted texts
+    const size_t* const,         // B -many encrypted/ decrypted lengths
+    bool* const                  // B -many verification flags
+  );
 }
 
+// Native worker pool, backing asynchronous API of Python wrapper. Completed job
+// ids are queued up and an eventfd is signaled, which can be registered with an
+// event loop ( say Python asyncio ) for getting notified about completions,
+// without dedicating a waiting thread per call.
+struct grain_128aead_pool_t
+{
+  explicit grain_128aead_pool_t(const size_t n)
+    : efd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , pool(std::make_unique<worker_pool::pool_t>(n))
+  {}
+
+  // Joins workers ( after draining queued jobs ) before closing eventfd, which
+  // workers signal on job completion
+  ~grain_128aead_pool_t()
+  {
+    pool.reset();
+    if (efd >= 0) {
+      close(efd);
+    }
+  }
+
+  // Splits a batch of B messages into per-message jobs, executed on worker
+  // threads; once last message of the batch is processed, job id is marked
+  // completed and eventfd is signaled, only once for whole batch.
+  void run_batch(const uint64_t id,
+                 const size_t cnt,
+                 std::function<void(const size_t)> fn)
+  {
+    if (cnt == 0) {
+      complete(id);
+      return;
+    }
+
+    auto remaining = std::make_shared<std::atomic<size_t>>(cnt);
+    auto work = std::make_shared<std::function<void(const size_t)>>(fn);
+
+    std::vector<worker_pool::job_t> jobs;
+    jobs.reserve(cnt);
+
+    for (size_t i = 0; i < cnt; i++) {
+      jobs.emplace_back([this, id, i, remaining, work] {
+        (*work)(i);
+
+        if (remaining->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          complete(id);
+        }
+      });
+    }
+
+    pool->submit_batch(std::move(jobs));
+  }
+
+  // Moves at max `cap` -many completed job ids to `ids`, returning how many
+  // were written
+  size_t reap(uint64_t* const ids, const size_t cap)
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    const size_t cnt = std::min(cap, done.size());
+    for (size_t i = 0; i < cnt; i++) {
+      ids[i] = done.front();
+      done.pop_front();
+    }
+
+    return cnt;
+  }
+
+  const int efd;
+
+private:
+  void complete(const uint64_t id)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      done.push_back(id);
+    }
+
+    const uint64_t one = 1;
+    [[maybe_unused]] const ssize_t _ = write(efd, &one, sizeof(one));
+  }
+
+  std::mutex mtx;
+  std::deque<uint64_t> done;
+  std::unique_ptr<worker_pool::pool_t> pool;
+};
+
 // Function implementation
 extern "C"
 {
@@ -62,4 +230,147 @@ extern "C"
     using namespace grain_128aead;
     return decrypt(key, nonce, tag, data, dlen, enc, txt, ctlen);
   }
+
+  void grain_128aead_retag(
+    const uint8_t* const __restrict key,      // 128 -bit secret key
+    const uint8_t* const __restrict nonce,    // 96 -bit nonce
+    const uint8_t* const __restrict old_data, // N -bytes old associated data
+    const uint8_t* const __restrict new_data, // N -bytes new associated data
+    const size_t dlen, // byte length of associated data = N | >= 0
+    const uint8_t* const old_tag, // 64 -bit old authentication tag
+    uint8_t* const new_tag        // 64 -bit new authentication tag
+  )
+  {
+    using namespace grain_128aead;
+    retag(key, nonce, old_data, new_data, dlen, old_tag, new_tag);
+  }
+
+  bool grain_128aead_reseal(
+    const uint8_t* const __restrict old_key,   // 128 -bit old secret key
+    const uint8_t* const __restrict old_nonce, // 96 -bit old nonce
+    const uint8_t* const __restrict old_tag,   // 64 -bit old tag
+    const uint8_t* const __restrict old_data,  // N -bytes old associated data
+    const size_t old_dlen, // byte length of old associated data = N | >= 0
+    const uint8_t* const __restrict new_key,   // 128 -bit new secret key
+    const uint8_t* const __restrict new_nonce, // 96 -bit new nonce
+    const uint8_t* const __restrict new_data,  // K -bytes new associated data
+    const size_t new_dlen, // byte length of new associated data = K | >= 0
+    const uint8_t* const __restrict enc, // M -bytes old encrypted text
+    uint8_t* const __restrict out,       // M -bytes new encrypted text
+    const size_t ctlen, // byte length of encrypted texts = M | >= 0
+    uint8_t* const __restrict new_tag // 64 -bit new tag
+  )
+  {
+    using namespace grain_128aead;
+    return reseal(old_key,
+                  old_nonce,
+                  old_tag,
+                  old_data,
+                  old_dlen,
+                  new_key,
+                  new_nonce,
+                  new_data,
+                  new_dlen,
+                  enc,
+                  out,
+                  ctlen,
+                  new_tag);
+  }
+
+  void grain_128aead_warm_up(
+    const size_t rounds,           // number of warm-up passes | > 0
+    uint8_t* const __restrict buf, // B -bytes buffer to pre-fault, may be null
+    const size_t blen              // byte length of buffer = B | >= 0
+  )
+  {
+    grain_128aead::warm_up(rounds, buf, blen);
+  }
+
+  void* grain_128aead_pool_create(
+    const size_t threads // number of worker threads | = 0 means one per CPU
+  )
+  {
+    auto pool = new grain_128aead_pool_t(threads);
+
+    // completions can't be signaled without an eventfd
+    if (pool->efd < 0) {
+      delete pool;
+      return nullptr;
+    }
+    return pool;
+  }
+
+  void grain_128aead_pool_destroy(void* const pool // handle to worker pool
+  )
+  {
+    delete static_cast<grain_128aead_pool_t*>(pool);
+  }
+
+  int grain_128aead_pool_eventfd(void* const pool // handle to worker pool
+  )
+  {
+    return static_cast<grain_128aead_pool_t*>(pool)->efd;
+  }
+
+  size_t grain_128aead_pool_reap(
+    void* const pool,     // handle to native worker pool
+    uint64_t* const ids,  // completed job ids are written here
+    const size_t cap      // capacity of job id buffer
+  )
+  {
+    return static_cast<grain_128aead_pool_t*>(pool)->reap(ids, cap);
+  }
+
+  void grain_128aead_pool_encrypt(
+    void* const pool,                  // handle to native worker pool
+    const uint64_t id,                 // job id, reported back on completion
+    const size_t cnt,                  // number of messages in this batch = B
+    const uint8_t* const* const keys,  // B -many 128 -bit secret keys
+    const uint8_t* const* const nonces, // B -many 96 -bit nonces
+    const uint8_t* const* const data,  // B -many associated data
+    const size_t* const dlens,         // B -many associated data lengths
+    const uint8_t* const* const txts,  // B -many plain texts
+    uint8_t* const* const encs,        // B -many encrypted texts
+    const size_t* const ctlens,        // B -many plain/ encrypted text lengths
+    uint8_t* const* const tags         // B -many 64 -bit authentication tags
+  )
+  {
+    auto p = static_cast<grain_128aead_pool_t*>(pool);
+
+    p->run_batch(id, cnt, [=](const size_t i) {
+      const auto key = keys[i];
+      const auto nonce = nonces[i];
+
+      grain_128aead::encrypt(
+        key, nonce, data[i], dlens[i], txts[i], encs[i], ctlens[i], tags[i]);
+    });
+  }
+
+  void grain_128aead_pool_decrypt(
+    void* const pool,                  // handle to native worker pool
+    const uint64_t id,                 // job id, reported back on completion
+    const size_t cnt,                  // number of messages in this batch = B
+    const uint8_t* const* const keys,  // B -many 128 -bit secret keys
+    const uint8_t* const* const nonces, // B -many 96 -bit nonces
+    const uint8_t* const* const tags,  // B -many 64 -bit authentication tags
+    const uint8_t* const* const data,  // B -many associated data
+    const size_t* const dlens,         // B -many associated data lengths
+    const uint8_t* const* const encs,  // B -many encrypted texts
+    uint8_t* const* const txts,        // B -many decrypted texts
+    const size_t* const ctlens,        // B -many encrypted/ decrypted lengths
+    bool* const flags                  // B -many verification flags
+  )
+  {
+    auto p = static_cast<grain_128aead_pool_t*>(pool);
+
+    p->run_batch(id, cnt, [=](const size_t i) {
+      using namespace grain_128aead;
+
+      const auto key = keys[i];
+      const auto nonce = nonces[i];
+
+      flags[i] = decrypt(
+        key, nonce, tags[i], data[i], dlens[i], encs[i], txts[i], ctlens[i]);
+    });
+  }
 }
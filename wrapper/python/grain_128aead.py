@@ -11,8 +11,13 @@
   Project: https://github.com/itzmeanjan/grain-128aead
 """
 
-from typing import Tuple
-from ctypes import c_size_t, CDLL, c_bool
+from typing import Dict, List, Sequence, Tuple
+from ctypes import c_size_t, CDLL, c_bool, c_int, c_uint64, c_void_p, POINTER
+from concurrent.futures import Future
+import asyncio
+import os
+import threading
+import weakref
 import numpy as np
 from posixpath import exists, abspath
 
@@ -96,5 +101,466 @@ def decrypt(
     return f, dec_
 
 
+def retag(
+    key: bytes, nonce: bytes, old_data: bytes, new_data: bytes, old_tag: bytes
+) -> bytes:
+    """
+    Computes 8 -bytes authentication tag for replacing N ( >=0 ) -bytes
+    associated data of an already encrypted message with equal length new
+    associated data, given 16 -bytes secret key, 12 -bytes public message nonce
+    & 8 -bytes old authentication tag; cipher text stays unchanged & isn't
+    needed
+    """
+    assert len(key) == 16, "Grain-128 AEAD takes 16 -bytes secret key !"
+    assert len(nonce) == 12, "Grain-128 AEAD takes 12 -bytes nonce !"
+    assert len(old_tag) == 8, "Grain-128 AEAD takes 8 -bytes authentication tag !"
+    assert len(old_data) == len(new_data), "Associated data length can't change !"
+
+    ad_len = len(old_data)
+
+    key_ = np.frombuffer(key, dtype=u8)
+    nonce_ = np.frombuffer(nonce, dtype=u8)
+    old_data_ = np.frombuffer(old_data, dtype=u8)
+    new_data_ = np.frombuffer(new_data, dtype=u8)
+    old_tag_ = np.frombuffer(old_tag, dtype=u8)
+    new_tag = np.empty(8, dtype=u8)
+
+    args = [uint8_tp, uint8_tp, uint8_tp, uint8_tp, len_t, uint8_tp, uint8_tp]
+    SO_LIB.grain_128aead_retag.argtypes = args
+
+    SO_LIB.grain_128aead_retag(
+        key_, nonce_, old_data_, new_data_, ad_len, old_tag_, new_tag
+    )
+
+    return new_tag.tobytes()
+
+
+def reseal(
+    old_key: bytes,
+    old_nonce: bytes,
+    old_tag: bytes,
+    old_data: bytes,
+    new_key: bytes,
+    new_nonce: bytes,
+    new_data: bytes,
+    enc: bytes,
+) -> Tuple[bool, bytes, bytes]:
+    """
+    Re-encrypts M ( >=0 ) -bytes cipher text, sealed under old 16 -bytes secret
+    key, 12 -bytes nonce & associated data ( with 8 -bytes authentication tag ),
+    under new secret key, nonce & associated data, in a single pass, without
+    materializing plain text, while producing boolean flag denoting whether old
+    tag verified, M -bytes new cipher text & 8 -bytes new authentication tag (
+    in order ); cipher text & tag are zeroed, if old tag doesn't verify
+    """
+    assert len(old_key) == 16, "Grain-128 AEAD takes 16 -bytes secret key !"
+    assert len(new_key) == 16, "Grain-128 AEAD takes 16 -bytes secret key !"
+    assert len(old_nonce) == 12, "Grain-128 AEAD takes 12 -bytes nonce !"
+    assert len(new_nonce) == 12, "Grain-128 AEAD takes 12 -bytes nonce !"
+    assert len(old_tag) == 8, "Grain-128 AEAD takes 8 -bytes authentication tag !"
+
+    ct_len = len(enc)
+
+    old_key_ = np.frombuffer(old_key, dtype=u8)
+    old_nonce_ = np.frombuffer(old_nonce, dtype=u8)
+    old_tag_ = np.frombuffer(old_tag, dtype=u8)
+    old_data_ = np.frombuffer(old_data, dtype=u8)
+    new_key_ = np.frombuffer(new_key, dtype=u8)
+    new_nonce_ = np.frombuffer(new_nonce, dtype=u8)
+    new_data_ = np.frombuffer(new_data, dtype=u8)
+    enc_ = np.frombuffer(enc, dtype=u8)
+    out = np.empty(ct_len, dtype=u8)
+    new_tag = np.empty(8, dtype=u8)
+
+    args = [uint8_tp, uint8_tp, uint8_tp, uint8_tp, len_t]
+    args += [uint8_tp, uint8_tp, uint8_tp, len_t]
+    args += [uint8_tp, uint8_tp, len_t, uint8_tp]
+    SO_LIB.grain_128aead_reseal.argtypes = args
+    SO_LIB.grain_128aead_reseal.restype = bool_t
+
+    f = SO_LIB.grain_128aead_reseal(
+        old_key_,
+        old_nonce_,
+        old_tag_,
+        old_data_,
+        len(old_data),
+        new_key_,
+        new_nonce_,
+        new_data_,
+        len(new_data),
+        enc_,
+        out,
+        ct_len,
+        new_tag,
+    )
+
+    return f, out.tobytes(), new_tag.tobytes()
+
+
+def warm_up(rounds: int = 2):
+    """
+    Primes native encrypt/ decrypt code paths, by running them over a few short
+    messages `rounds` times, followed by one call through each of `encrypt` &
+    `decrypt` of this module, so that first real calls of a freshly started
+    process don't pay for cold caches & ctypes setup
+    """
+    assert rounds > 0, "Need at least one warm-up pass !"
+
+    SO_LIB.grain_128aead_warm_up.argtypes = [len_t, c_void_p, len_t]
+    SO_LIB.grain_128aead_warm_up(rounds, None, 0)
+
+    key, nonce = bytes(16), bytes(12)
+    enc, tag = encrypt(key, nonce, b"", bytes(4))
+    decrypt(key, nonce, tag, b"", enc)
+
+
+def _ptrs(arrs: Sequence[np.ndarray]):
+    """
+    Builds C array of pointers to first byte of each numpy array
+    """
+    return (c_void_p * len(arrs))(*[a.ctypes.data for a in arrs])
+
+
+def _lens(arrs: Sequence[np.ndarray]):
+    """
+    Builds C array of byte lengths of each numpy array
+    """
+    return (len_t * len(arrs))(*[len(a) for a in arrs])
+
+
+SO_LIB.grain_128aead_pool_create.argtypes = [len_t]
+SO_LIB.grain_128aead_pool_create.restype = c_void_p
+SO_LIB.grain_128aead_pool_destroy.argtypes = [c_void_p]
+SO_LIB.grain_128aead_pool_eventfd.argtypes = [c_void_p]
+SO_LIB.grain_128aead_pool_eventfd.restype = c_int
+SO_LIB.grain_128aead_pool_reap.argtypes = [c_void_p, POINTER(c_uint64), len_t]
+SO_LIB.grain_128aead_pool_reap.restype = len_t
+
+SO_LIB.grain_128aead_pool_encrypt.argtypes = [c_void_p, c_uint64, len_t] + [
+    c_void_p
+] * 8
+SO_LIB.grain_128aead_pool_decrypt.argtypes = [c_void_p, c_uint64, len_t] + [
+    c_void_p
+] * 9
+
+
+class _NativePool:
+    """
+    Native worker pool, executing batches of Grain-128 AEAD jobs off the
+    calling thread. On completion of a batch, its job id is queued up in
+    native pool & an eventfd is signaled; subclasses decide how that eventfd
+    is waited on.
+    """
+
+    def __init__(self, threads: int = 0):
+        self._pool = SO_LIB.grain_128aead_pool_create(threads)
+        if not self._pool:
+            raise OSError("failed to create native worker pool")
+
+        # native pool is released on `close` or, at latest, when this object is
+        # garbage collected
+        self._release = weakref.finalize(
+            self, SO_LIB.grain_128aead_pool_destroy, self._pool
+        )
+        self._efd = SO_LIB.grain_128aead_pool_eventfd(self._pool)
+        self._ids = (c_uint64 * 64)()
+        self._next_id = 0
+        self._lock = threading.Lock()
+        self._idle = threading.Condition(self._lock)
+        # job id -> ( buffers to keep alive, completion callback )
+        self._inflight: Dict[int, Tuple[tuple, object]] = {}
+
+    def close(self):
+        """
+        Releases native worker pool; all submitted jobs must be completed by
+        now
+        """
+        self._release()
+        self._pool = None
+
+    def _submit_encrypt(self, items, done):
+        keys, nonces, data, texts = [], [], [], []
+        for key, nonce, ad, text in items:
+            assert len(key) == 16, "Grain-128 AEAD takes 16 -bytes secret key !"
+            assert len(nonce) == 12, "Grain-128 AEAD takes 12 -bytes nonce !"
+
+            keys.append(np.frombuffer(key, dtype=u8))
+            nonces.append(np.frombuffer(nonce, dtype=u8))
+            data.append(np.frombuffer(ad, dtype=u8))
+            texts.append(np.frombuffer(text, dtype=u8))
+
+        encs = [np.empty(len(t), dtype=u8) for t in texts]
+        tags = [np.empty(8, dtype=u8) for _ in texts]
+
+        args = (
+            _ptrs(keys),
+            _ptrs(nonces),
+            _ptrs(data),
+            _lens(data),
+            _ptrs(texts),
+            _ptrs(encs),
+            _lens(texts),
+            _ptrs(tags),
+        )
+        keep = (keys, nonces, data, texts, encs, tags, args)
+
+        def finish():
+            done([(e.tobytes(), t.tobytes()) for e, t in zip(encs, tags)])
+
+        jid = self._register(keep, finish)
+        SO_LIB.grain_128aead_pool_encrypt(self._pool, jid, len(items), *args)
+
+    def _submit_decrypt(self, items, done):
+        keys, nonces, tags, data, encs = [], [], [], [], []
+        for key, nonce, tag, ad, enc in items:
+            assert len(key) == 16, "Grain-128 AEAD takes 16 -bytes secret key !"
+            assert len(nonce) == 12, "Grain-128 AEAD takes 12 -bytes nonce !"
+            assert len(tag) == 8, "Grain-128 AEAD takes 8 -bytes authentication tag !"
+
+            keys.append(np.frombuffer(key, dtype=u8))
+            nonces.append(np.frombuffer(nonce, dtype=u8))
+            tags.append(np.frombuffer(tag, dtype=u8))
+            data.append(np.frombuffer(ad, dtype=u8))
+            encs.append(np.frombuffer(enc, dtype=u8))
+
+        decs = [np.empty(len(e), dtype=u8) for e in encs]
+        flags = np.zeros(len(items), dtype=np.bool_)
+
+        args = (
+            _ptrs(keys),
+            _ptrs(nonces),
+            _ptrs(tags),
+            _ptrs(data),
+            _lens(data),
+            _ptrs(encs),
+            _ptrs(decs),
+            _lens(encs),
+            flags.ctypes.data,
+        )
+        keep = (keys, nonces, tags, data, encs, decs, flags, args)
+
+        def finish():
+            done([(bool(f), d.tobytes()) for f, d in zip(flags, decs)])
+
+        jid = self._register(keep, finish)
+        SO_LIB.grain_128aead_pool_decrypt(self._pool, jid, len(items), *args)
+
+    def _register(self, keep, finish) -> int:
+        with self._lock:
+            jid = self._next_id
+            self._next_id += 1
+            self._inflight[jid] = (keep, finish)
+
+        return jid
+
+    def _drain(self):
+        """
+        Consumes eventfd counter & runs completion callbacks of all completed
+        jobs
+        """
+        try:
+            os.read(self._efd, 8)
+        except BlockingIOError:
+            pass
+
+        while True:
+            cnt = SO_LIB.grain_128aead_pool_reap(self._pool, self._ids, len(self._ids))
+            if cnt == 0:
+                break
+
+            for i in range(cnt):
+                with self._lock:
+                    _, finish = self._inflight.pop(self._ids[i])
+                    if not self._inflight:
+                        self._idle.notify_all()
+                finish()
+
+    def _wait_idle(self):
+        """
+        Blocks until all submitted jobs are completed
+        """
+        with self._lock:
+            self._idle.wait_for(lambda: not self._inflight)
+
+
+class AsyncPool(_NativePool):
+    """
+    Native worker pool, whose completions are delivered to asyncio event loop,
+    by registering pool's eventfd as a reader with the loop; so no thread is
+    blocked per call & `run_in_executor` isn't needed.
+
+    Pool only weakly refers to its loop, so that a closed loop ( which drops
+    its readers ) can be garbage collected along with the pool.
+    """
+
+    def __init__(self, loop: asyncio.AbstractEventLoop, threads: int = 0):
+        super().__init__(threads)
+        self._loop = weakref.ref(loop)
+        loop.add_reader(self._efd, self._drain)
+
+    def close(self):
+        """
+        Unregisters pool from event loop ( unless it's already closed ) &
+        releases it; await all submitted jobs before closing
+        """
+        loop = self._loop()
+        if loop is not None and not loop.is_closed():
+            loop.remove_reader(self._efd)
+        super().close()
+
+    def _future(self):
+        fut = self._loop().create_future()
+
+        def done(res):
+            if not fut.cancelled():
+                fut.set_result(res)
+
+        return fut, done
+
+    async def encrypt_batch(
+        self, items: Sequence[Tuple[bytes, bytes, bytes, bytes]]
+    ) -> List[Tuple[bytes, bytes]]:
+        """
+        Encrypts a batch of ( key, nonce, data, text ) tuples, in parallel on
+        native workers, returning ( cipher text, tag ) for each of them
+        """
+        fut, done = self._future()
+        self._submit_encrypt(items, done)
+        return await fut
+
+    async def decrypt_batch(
+        self, items: Sequence[Tuple[bytes, bytes, bytes, bytes, bytes]]
+    ) -> List[Tuple[bool, bytes]]:
+        """
+        Decrypts a batch of ( key, nonce, tag, data, cipher text ) tuples, in
+        parallel on native workers, returning ( verification flag, plain text )
+        for each of them
+        """
+        fut, done = self._future()
+        self._submit_decrypt(items, done)
+        return await fut
+
+    async def encrypt(
+        self, key: bytes, nonce: bytes, data: bytes, text: bytes
+    ) -> Tuple[bytes, bytes]:
+        return (await self.encrypt_batch([(key, nonce, data, text)]))[0]
+
+    async def decrypt(
+        self, key: bytes, nonce: bytes, tag: bytes, data: bytes, enc: bytes
+    ) -> Tuple[bool, bytes]:
+        return (await self.decrypt_batch([(key, nonce, tag, data, enc)]))[0]
+
+
+class FuturesPool(_NativePool):
+    """
+    Native worker pool, handing out `concurrent.futures.Future`s; a single
+    daemon thread waits on pool's eventfd & completes futures.
+    """
+
+    def __init__(self, threads: int = 0):
+        super().__init__(threads)
+        os.set_blocking(self._efd, True)
+        self._closed = False
+        self._waiter = threading.Thread(target=self._wait, daemon=True)
+        self._waiter.start()
+
+    def _wait(self):
+        while not self._closed:
+            self._drain()
+
+    def close(self):
+        # deliver all pending completions, then wake up waiter thread
+        self._wait_idle()
+        self._closed = True
+        os.write(self._efd, (1).to_bytes(8, "little"))
+        self._waiter.join()
+        super().close()
+
+    def submit_encrypt_batch(
+        self, items: Sequence[Tuple[bytes, bytes, bytes, bytes]]
+    ) -> Future:
+        fut = Future()
+        self._submit_encrypt(items, fut.set_result)
+        return fut
+
+    def submit_decrypt_batch(
+        self, items: Sequence[Tuple[bytes, bytes, bytes, bytes, bytes]]
+    ) -> Future:
+        fut = Future()
+        self._submit_decrypt(items, fut.set_result)
+        return fut
+
+
+# Weakly keyed, so that entries of garbage collected loops go away on their own
+_ASYNC_POOLS: "weakref.WeakKeyDictionary[asyncio.AbstractEventLoop, AsyncPool]" = (
+    weakref.WeakKeyDictionary()
+)
+
+
+def _async_pool() -> AsyncPool:
+    """
+    Lazily creates one native worker pool per running asyncio event loop, while
+    releasing pools of already closed loops ( say, of earlier `asyncio.run` )
+    """
+    for stale in [lp for lp in list(_ASYNC_POOLS.keys()) if lp.is_closed()]:
+        _ASYNC_POOLS.pop(stale).close()
+
+    loop = asyncio.get_running_loop()
+    if loop not in _ASYNC_POOLS:
+        _ASYNC_POOLS[loop] = AsyncPool(loop)
+
+    return _ASYNC_POOLS[loop]
+
+
+async def aclose():
+    """
+    Releases native worker pool of running event loop, if any; await all
+    submitted jobs before calling it. A new pool is created on next use.
+    """
+    pool = _ASYNC_POOLS.pop(asyncio.get_running_loop(), None)
+    if pool is not None:
+        pool.close()
+
+
+async def aencrypt(
+    key: bytes, nonce: bytes, data: bytes, text: bytes
+) -> Tuple[bytes, bytes]:
+    """
+    Asynchronous variant of `encrypt`, executed on native worker pool, without
+    blocking running event loop
+    """
+    return await _async_pool().encrypt(key, nonce, data, text)
+
+
+async def adecrypt(
+    key: bytes, nonce: bytes, tag: bytes, data: bytes, enc: bytes
+) -> Tuple[bool, bytes]:
+    """
+    Asynchronous variant of `decrypt`, executed on native worker pool, without
+    blocking running event loop
+    """
+    return await _async_pool().decrypt(key, nonce, tag, data, enc)
+
+
+async def aencrypt_batch(
+    items: Sequence[Tuple[bytes, bytes, bytes, bytes]]
+) -> List[Tuple[bytes, bytes]]:
+    """
+    Asynchronously encrypts a batch of ( key, nonce, data, text ) tuples, with
+    single submission to native worker pool
+    """
+    return await _async_pool().encrypt_batch(items)
+
+
+async def adecrypt_batch(
+    items: Sequence[Tuple[bytes, bytes, bytes, bytes, bytes]]
+) -> List[Tuple[bool, bytes]]:
+    """
+    Asynchronously decrypts a batch of ( key, nonce, tag, data, cipher text )
+    tuples, with single submission to native worker pool
+    """
+    return await _async_pool().decrypt_batch(items)
+
+
 if __name__ == "__main__":
     print("Use `grain_128aead` as library module")
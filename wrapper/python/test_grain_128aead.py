@@ -1,5 +1,7 @@
 #!/usr/bin/python3
 
+import asyncio
+import os
 import grain_128aead
 import numpy as np
 
@@ -75,5 +77,145 @@ def test_grain_128aead_kat():
             fd.readline()
 
 
+def test_grain_128aead_async():
+    """
+    Tests that asyncio & concurrent.futures APIs, backed by native worker pool,
+    compute same cipher text, tag & plain text as synchronous API, for randomly
+    generated inputs
+    """
+    items = [
+        (os.urandom(16), os.urandom(12), os.urandom(i & 31), os.urandom(i))
+        for i in range(64)
+    ]
+    expected = [grain_128aead.encrypt(*item) for item in items]
+
+    async def run():
+        single = [await grain_128aead.aencrypt(*item) for item in items[:8]]
+        batch = await grain_128aead.aencrypt_batch(items)
+
+        dec_items = [
+            (k, n, tag, d, enc) for (k, n, d, _), (enc, tag) in zip(items, batch)
+        ]
+        decs = await asyncio.gather(
+            grain_128aead.adecrypt_batch(dec_items),
+            grain_128aead.adecrypt(*dec_items[-1]),
+        )
+        return single, batch, decs
+
+    single, batch, (decs, last) = asyncio.run(run())
+
+    assert single == expected[:8]
+    assert batch == expected
+    assert all(flag and text == item[3] for (flag, text), item in zip(decs, items))
+    assert last == (True, items[-1][3])
+
+    pool = grain_128aead.FuturesPool(2)
+    fut = pool.submit_encrypt_batch(items)
+    assert fut.result() == expected
+
+    # tampered tag must fail verification
+    k, n, d, _ = items[1]
+    enc, tag = expected[1]
+    bad = bytes([tag[0] ^ 1]) + tag[1:]
+    flag, text = pool.submit_decrypt_batch([(k, n, bad, d, enc)]).result()[0]
+    assert not flag and text == bytes(len(enc))
+    pool.close()
+
+
+def test_grain_128aead_async_pools_released():
+    """
+    Tests that native worker pools ( & their eventfds ) backing asyncio API
+    don't pile up across event loops, i.e. repeated `asyncio.run`
+    """
+    key, nonce = os.urandom(16), os.urandom(12)
+    expected = grain_128aead.encrypt(key, nonce, b"", b"text")
+
+    def open_fds():
+        return len(os.listdir("/proc/self/fd"))
+
+    async def run():
+        return await grain_128aead.aencrypt(key, nonce, b"", b"text")
+
+    assert asyncio.run(run()) == expected
+    fds = open_fds()
+
+    for _ in range(8):
+        assert asyncio.run(run()) == expected
+
+    assert open_fds() <= fds
+    assert len(grain_128aead._ASYNC_POOLS) <= 1
+
+    async def run_and_close():
+        res = await run()
+        await grain_128aead.aclose()
+        return res
+
+    assert asyncio.run(run_and_close()) == expected
+    assert len(grain_128aead._ASYNC_POOLS) == 0
+
+
+def test_grain_128aead_retag():
+    """
+    Tests that re-tagging for changed associated data ( of same length ) yields
+    same tag as encrypting plain text afresh under new associated data
+    """
+    for dlen in [0, 1, 3, 4, 31, 127, 128, 300]:
+        key = os.urandom(16)
+        nonce = os.urandom(12)
+        old_data = os.urandom(dlen)
+        new_data = os.urandom(dlen)
+        text = os.urandom(dlen + 17)
+
+        enc0, tag0 = grain_128aead.encrypt(key, nonce, old_data, text)
+        enc1, tag1 = grain_128aead.encrypt(key, nonce, new_data, text)
+        assert enc0 == enc1
+
+        tag = grain_128aead.retag(key, nonce, old_data, new_data, tag0)
+        assert tag == tag1
+
+        flag, dec = grain_128aead.decrypt(key, nonce, tag, new_data, enc0)
+        assert flag and dec == text
+
+
+def test_grain_128aead_reseal():
+    """
+    Tests that re-sealing under new key, nonce & associated data yields same
+    cipher text & tag as encrypting plain text afresh, and that nothing is
+    released when old tag doesn't verify
+    """
+    for ctlen in [0, 1, 3, 4, 5, 64, 333]:
+        old_key, new_key = os.urandom(16), os.urandom(16)
+        old_nonce, new_nonce = os.urandom(12), os.urandom(12)
+        old_data, new_data = os.urandom(ctlen % 7), os.urandom(ctlen % 5 + 130)
+        text = os.urandom(ctlen)
+
+        enc0, tag0 = grain_128aead.encrypt(old_key, old_nonce, old_data, text)
+        enc1, tag1 = grain_128aead.encrypt(new_key, new_nonce, new_data, text)
+
+        args = [old_key, old_nonce, tag0, old_data, new_key, new_nonce, new_data]
+        flag, enc, tag = grain_128aead.reseal(*args, enc0)
+        assert flag and enc == enc1 and tag == tag1
+
+        bad = bytes([tag0[0] ^ 1]) + tag0[1:]
+        args[2] = bad
+        flag, enc, tag = grain_128aead.reseal(*args, enc0)
+        assert not flag and enc == bytes(ctlen) and tag == bytes(8)
+
+
+def test_grain_128aead_warm_up():
+    """
+    Tests that warming up leaves no state behind, affecting later calls
+    """
+    key, nonce, data, text = os.urandom(16), os.urandom(12), b"ad", os.urandom(37)
+
+    enc0, tag0 = grain_128aead.encrypt(key, nonce, data, text)
+    grain_128aead.warm_up(3)
+    enc1, tag1 = grain_128aead.encrypt(key, nonce, data, text)
+    flag, dec = grain_128aead.decrypt(key, nonce, tag1, data, enc1)
+
+    assert enc0 == enc1 and tag0 == tag1
+    assert flag and dec == text
+
+
 if __name__ == "__main__":
     print("Execute test cases using `pytest`")